@@ -0,0 +1,475 @@
+//-------------------------------------------------------------------------------------------------------
+// Copyright (C) Taylor Woll and panwave contributors. All rights reserved.
+// Licensed under the MIT license. See LICENSE.txt file in the project root for
+// full license information.
+//-------------------------------------------------------------------------------------------------------
+
+// Times the transforms and trees of panwave over a grid of signal lengths,
+// tree heights, wavelets and modes.
+//
+// Every benchmark is first run until the warm-up time has passed, which
+// also picks how many iterations fill one repetition of at least the
+// minimum time. The repetitions are then timed one by one and summarized
+// per iteration. Results are printed as a table, and as JSON when asked.
+//
+// Usage: panwave_bench [--filter=TEXT] [--repetitions=N] [--min-time=MS]
+//                      [--warmup=MS] [--json[=FILE]]
+//
+// --filter runs only the benchmarks whose name contains TEXT. --json prints
+// JSON instead of the table, or writes it to FILE as well as the table.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "StationaryWaveletPacketTree.h"
+#include "Threshold.h"
+#include "Wavelet.h"
+#include "WaveletKernels.h"
+#include "WaveletMath.h"
+#include "WaveletPacketTree.h"
+
+using panwave::DyadicMode;
+using panwave::GetWaveletKernels;
+using panwave::KernelIsa;
+using panwave::PaddingMode;
+using panwave::Span;
+using panwave::StationaryWaveletPacketTree;
+using panwave::Threshold;
+using panwave::ThresholdRule;
+using panwave::ThresholdSelection;
+using panwave::Wavelet;
+using panwave::WaveletMath;
+using panwave::WaveletPacketTree;
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+  std::string filter;
+  size_t repetitions = 5;
+  double min_time_ms = 10.0;
+  double warmup_ms = 20.0;
+  bool json = false;
+  std::string json_path;
+};
+
+struct Result {
+  std::string name;
+  // Samples of input processed by one iteration.
+  size_t samples;
+  size_t iterations;
+  double min_ns;
+  double median_ns;
+  double mean_ns;
+  double stddev_ns;
+  double max_ns;
+};
+
+struct NamedWavelet {
+  const char* name;
+  Wavelet::WaveletType type;
+  size_t vanishing_moment;
+};
+
+const NamedWavelet wavelets[] = {
+    {"db4", Wavelet::WaveletType::Daubechies, 4},
+    {"db10", Wavelet::WaveletType::Daubechies, 10},
+    {"sym5", Wavelet::WaveletType::Symlet, 5},
+    {"coif3", Wavelet::WaveletType::Coiflet, 3}};
+
+const size_t signal_sizes[] = {256, 4096, 65536};
+
+const DyadicMode dyadic_modes[] = {DyadicMode::Odd, DyadicMode::Even};
+const PaddingMode padding_modes[] = {
+    PaddingMode::Zeroes, PaddingMode::Symmetric, PaddingMode::Periodic};
+
+// Written with a result of every iteration so the calls are not optimized
+// away.
+volatile double sink;
+
+const char* GetName(DyadicMode mode) {
+  return mode == DyadicMode::Odd ? "odd" : "even";
+}
+
+const char* GetName(PaddingMode mode) {
+  switch (mode) {
+    case PaddingMode::Zeroes:
+      return "zeroes";
+    case PaddingMode::Symmetric:
+      return "symmetric";
+    case PaddingMode::Periodic:
+      return "periodic";
+  }
+  return "unknown";
+}
+
+const char* GetName(KernelIsa isa) {
+  switch (isa) {
+    case KernelIsa::Scalar:
+      return "scalar";
+    case KernelIsa::Sse2:
+      return "sse2";
+    case KernelIsa::Avx2:
+      return "avx2";
+    case KernelIsa::Avx512:
+      return "avx512";
+  }
+  return "unknown";
+}
+
+std::vector<double> MakeSignal(size_t size) {
+  std::vector<double> signal(size);
+  for (size_t i = 0; i < size; i++) {
+    const double t = static_cast<double>(i);
+    signal[i] = std::sin(t * 0.05) + 0.5 * std::sin(t * 0.71) +
+                0.001 * static_cast<double>(i % 17);
+  }
+  return signal;
+}
+
+template <class Body>
+double TimeIterations(Body& body, size_t iterations) {
+  const auto begin = Clock::now();
+  for (size_t i = 0; i < iterations; i++) {
+    body();
+  }
+  return std::chrono::duration<double, std::nano>(Clock::now() - begin)
+      .count();
+}
+
+// Warm up and time one benchmark, then record a summary of the time each
+// iteration took.
+template <class Body>
+void Run(const Options& options, std::vector<Result>* results,
+         const std::string& name, size_t samples, Body body) {
+  if (name.find(options.filter) == std::string::npos) {
+    return;
+  }
+
+  // Double the batch until it fills the minimum time, and keep running
+  // until the warm-up time is spent as well.
+  const double min_time_ns = options.min_time_ms * 1e6;
+  size_t iterations = 1;
+  double warmup_ns = 0.0;
+  for (;;) {
+    const double elapsed = TimeIterations(body, iterations);
+    warmup_ns += elapsed;
+    if (elapsed >= min_time_ns) {
+      if (warmup_ns >= options.warmup_ms * 1e6) {
+        break;
+      }
+    } else {
+      iterations *= 2;
+    }
+  }
+
+  std::vector<double> times(options.repetitions);
+  for (double& time : times) {
+    time = TimeIterations(body, iterations) / static_cast<double>(iterations);
+  }
+  std::sort(times.begin(), times.end());
+
+  Result result{};
+  result.name = name;
+  result.samples = samples;
+  result.iterations = iterations;
+  const size_t count = times.size();
+  result.min_ns = times.front();
+  result.max_ns = times.back();
+  result.median_ns = count % 2 == 1
+                         ? times[count / 2]
+                         : (times[count / 2 - 1] + times[count / 2]) / 2.0;
+  double sum = 0.0;
+  for (const double time : times) {
+    sum += time;
+  }
+  result.mean_ns = sum / static_cast<double>(count);
+  double squares = 0.0;
+  for (const double time : times) {
+    squares += (time - result.mean_ns) * (time - result.mean_ns);
+  }
+  result.stddev_ns =
+      count > 1 ? std::sqrt(squares / static_cast<double>(count - 1)) : 0.0;
+  results->push_back(result);
+
+  if (!options.json || !options.json_path.empty()) {
+    std::cout << std::left << std::setw(72) << result.name << std::right
+              << std::fixed << std::setprecision(1) << std::setw(14)
+              << result.median_ns << std::setw(14) << result.mean_ns
+              << std::setw(10) << std::setprecision(2)
+              << (result.mean_ns > 0.0
+                      ? 100.0 * result.stddev_ns / result.mean_ns
+                      : 0.0)
+              << std::setw(14) << std::setprecision(1) << result.min_ns
+              << std::setw(12) << std::setprecision(2)
+              << static_cast<double>(samples) * 1e3 / result.median_ns
+              << std::setw(10) << result.iterations << std::endl;
+  }
+}
+
+void BenchmarkConvolve(const Options& options, std::vector<Result>* results) {
+  for (const NamedWavelet& named : wavelets) {
+    Wavelet wavelet;
+    Wavelet::GetWaveletCoefficients(&wavelet, named.type,
+                                    named.vanishing_moment);
+    for (const size_t size : signal_sizes) {
+      const std::vector<double> signal = MakeSignal(size);
+      std::vector<double> result;
+      std::ostringstream name;
+      name << "Convolve/" << named.name << "/n=" << size;
+      Run(options, results, name.str(), size, [&]() {
+        WaveletMath::Convolve(signal, wavelet.lowpassDecompositionFilter_,
+                              &result);
+        sink = result[0];
+      });
+    }
+  }
+}
+
+void BenchmarkTransforms(const Options& options,
+                         std::vector<Result>* results) {
+  for (const NamedWavelet& named : wavelets) {
+    Wavelet wavelet;
+    Wavelet::GetWaveletCoefficients(&wavelet, named.type,
+                                    named.vanishing_moment);
+    const size_t filter_size = wavelet.lowpassDecompositionFilter_.size();
+
+    for (const size_t size : signal_sizes) {
+      const std::vector<double> signal = MakeSignal(size);
+      std::vector<double> reconstructed(size);
+
+      for (const DyadicMode dyadic_mode : dyadic_modes) {
+        for (const PaddingMode padding_mode : padding_modes) {
+          const size_t coeffs_size = WaveletMath::GetDecomposedSize(
+              size, filter_size, dyadic_mode, padding_mode);
+          std::vector<double> approx(coeffs_size);
+          std::vector<double> details(coeffs_size);
+
+          std::ostringstream suffix;
+          suffix << named.name << "/n=" << size << "/" << GetName(dyadic_mode)
+                 << "/" << GetName(padding_mode);
+
+          Run(options, results, "Decompose/" + suffix.str(), size, [&]() {
+            WaveletMath::Decompose(Span<const double>(signal),
+                                   wavelet.lowpassDecompositionFilter_,
+                                   wavelet.highpassDecompositionFilter_,
+                                   Span<double>(approx), Span<double>(details),
+                                   dyadic_mode, padding_mode);
+            sink = approx[0];
+          });
+
+          Run(options, results, "Reconstruct/" + suffix.str(), size, [&]() {
+            WaveletMath::Reconstruct(Span<const double>(approx),
+                                     wavelet.lowpassReconstructionFilter_,
+                                     Span<double>(reconstructed), dyadic_mode,
+                                     padding_mode);
+            sink = reconstructed[0];
+          });
+        }
+      }
+    }
+  }
+}
+
+// Time decomposing a signal and reconstructing every wavelet level of a
+// tree separately. Together they are one full cycle.
+template <class Tree>
+void BenchmarkTree(const Options& options, std::vector<Result>* results,
+                   const std::string& name, size_t size, Tree* tree) {
+  const std::vector<double> signal = MakeSignal(size);
+  std::vector<double> levels(tree->GetWaveletLevelCount() * size);
+
+  Run(options, results, name + "/Decompose", size, [&]() {
+    tree->SetRootSignal(signal);
+    tree->Decompose();
+    sink = tree->GetRootSignal()[0];
+  });
+
+  tree->SetRootSignal(signal);
+  tree->Decompose();
+  Run(options, results, name + "/ReconstructAll", size, [&]() {
+    tree->ReconstructAll(levels);
+    sink = levels[0];
+  });
+}
+
+// Time denoising a decomposed signal in one fused pass, and by thresholding
+// the leaves and adding up every reconstructed wavelet level. A fixed hard
+// threshold leaves the leaves it has thresholded as they are, so each
+// repetition does the same work.
+void BenchmarkDenoise(const Options& options, std::vector<Result>* results,
+                      const std::string& name, size_t size,
+                      WaveletPacketTree* tree) {
+  const std::vector<double> signal = MakeSignal(size);
+  std::vector<double> denoised(size);
+  std::vector<double> levels(tree->GetWaveletLevelCount() * size);
+  Threshold threshold;
+  threshold.rule = ThresholdRule::Hard;
+  threshold.selection = ThresholdSelection::Fixed;
+  threshold.threshold = 0.5;
+
+  tree->SetRootSignal(signal);
+  tree->Decompose();
+  Run(options, results, name + "/Denoise", size, [&]() {
+    tree->Denoise(threshold, denoised);
+    sink = denoised[0];
+  });
+
+  Run(options, results, name + "/ThresholdReconstructAll", size, [&]() {
+    tree->ThresholdLeaves(threshold);
+    tree->ReconstructAll(levels);
+    std::copy(levels.cbegin(), levels.cbegin() + static_cast<ptrdiff_t>(size),
+              denoised.begin());
+    for (size_t row = 1; row < tree->GetWaveletLevelCount(); row++) {
+      const auto begin = levels.cbegin() + static_cast<ptrdiff_t>(row * size);
+      std::transform(denoised.cbegin(), denoised.cend(), begin,
+                     denoised.begin(), std::plus<>());
+    }
+    sink = denoised[0];
+  });
+}
+
+void BenchmarkTrees(const Options& options, std::vector<Result>* results) {
+  const NamedWavelet tree_wavelets[] = {wavelets[0], wavelets[2]};
+  const size_t tree_sizes[] = {4096, 65536};
+
+  for (const NamedWavelet& named : tree_wavelets) {
+    Wavelet wavelet;
+    Wavelet::GetWaveletCoefficients(&wavelet, named.type,
+                                    named.vanishing_moment);
+
+    for (const size_t size : tree_sizes) {
+      for (const size_t height : {3, 5, 7}) {
+        for (const DyadicMode dyadic_mode : dyadic_modes) {
+          for (const PaddingMode padding_mode : padding_modes) {
+            std::ostringstream name;
+            name << "WaveletPacketTree/" << named.name << "/n=" << size
+                 << "/h=" << height << "/" << GetName(dyadic_mode) << "/"
+                 << GetName(padding_mode);
+            WaveletPacketTree tree(height, &wavelet, dyadic_mode,
+                                   padding_mode);
+            BenchmarkTree(options, results, name.str(), size, &tree);
+            BenchmarkDenoise(options, results, name.str(), size, &tree);
+          }
+        }
+      }
+
+      for (const size_t height : {2, 3, 4}) {
+        for (const PaddingMode padding_mode : padding_modes) {
+          std::ostringstream name;
+          name << "StationaryWaveletPacketTree/" << named.name
+               << "/n=" << size << "/h=" << height << "/"
+               << GetName(padding_mode);
+          StationaryWaveletPacketTree tree(height, &wavelet, padding_mode);
+          BenchmarkTree(options, results, name.str(), size, &tree);
+        }
+      }
+    }
+  }
+}
+
+void WriteJson(const Options& options, const std::vector<Result>& results,
+               std::ostream& out) {
+  out << "{" << std::endl
+      << "  \"context\": {" << std::endl
+      << "    \"kernels\": \"" << GetName(GetWaveletKernels().isa) << "\","
+      << std::endl
+      << "    \"repetitions\": " << options.repetitions << "," << std::endl
+      << "    \"min_time_ms\": " << options.min_time_ms << "," << std::endl
+      << "    \"warmup_ms\": " << options.warmup_ms << std::endl
+      << "  }," << std::endl
+      << "  \"benchmarks\": [" << std::endl;
+
+  out << std::setprecision(6);
+  for (size_t i = 0; i < results.size(); i++) {
+    const Result& result = results[i];
+    out << "    {\"name\": \"" << result.name
+        << "\", \"samples\": " << result.samples
+        << ", \"iterations\": " << result.iterations
+        << ", \"min_ns\": " << result.min_ns
+        << ", \"median_ns\": " << result.median_ns
+        << ", \"mean_ns\": " << result.mean_ns
+        << ", \"stddev_ns\": " << result.stddev_ns
+        << ", \"max_ns\": " << result.max_ns << ", \"samples_per_second\": "
+        << static_cast<double>(result.samples) * 1e9 / result.median_ns
+        << "}" << (i + 1 < results.size() ? "," : "") << std::endl;
+  }
+  out << "  ]" << std::endl << "}" << std::endl;
+}
+
+bool ParseOptions(int argc, const char** argv, Options* options) {
+  for (int i = 1; i < argc; i++) {
+    const std::string argument = argv[i];
+    const size_t equals = argument.find('=');
+    const std::string key = argument.substr(0, equals);
+    const std::string value =
+        equals == std::string::npos ? "" : argument.substr(equals + 1);
+
+    if (key == "--filter") {
+      options->filter = value;
+    } else if (key == "--repetitions" && !value.empty()) {
+      options->repetitions = std::max<size_t>(
+          1, static_cast<size_t>(std::strtoul(value.c_str(), nullptr, 10)));
+    } else if (key == "--min-time" && !value.empty()) {
+      options->min_time_ms = std::strtod(value.c_str(), nullptr);
+    } else if (key == "--warmup" && !value.empty()) {
+      options->warmup_ms = std::strtod(value.c_str(), nullptr);
+    } else if (key == "--json") {
+      options->json = true;
+      options->json_path = value;
+    } else {
+      std::cerr << "Unknown option " << argument << std::endl
+                << "Usage: panwave_bench [--filter=TEXT] [--repetitions=N] "
+                   "[--min-time=MS] [--warmup=MS] [--json[=FILE]]"
+                << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+int main(int argc, const char** argv) {
+  Options options;
+  if (!ParseOptions(argc, argv, &options)) {
+    return -1;
+  }
+
+  const bool table = !options.json || !options.json_path.empty();
+  if (table) {
+    std::cout << "Kernels: " << GetName(GetWaveletKernels().isa)
+              << ", repetitions: " << options.repetitions
+              << ", min time: " << options.min_time_ms
+              << " ms, warm-up: " << options.warmup_ms << " ms" << std::endl
+              << std::left << std::setw(72) << "Benchmark" << std::right
+              << std::setw(14) << "Median ns" << std::setw(14) << "Mean ns"
+              << std::setw(10) << "CV %" << std::setw(14) << "Min ns"
+              << std::setw(12) << "Msamples/s" << std::setw(10) << "Iters"
+              << std::endl;
+  }
+
+  std::vector<Result> results;
+  BenchmarkConvolve(options, &results);
+  BenchmarkTransforms(options, &results);
+  BenchmarkTrees(options, &results);
+
+  if (!options.json) {
+    return 0;
+  }
+  if (options.json_path.empty()) {
+    WriteJson(options, results, std::cout);
+    return 0;
+  }
+
+  std::ofstream file(options.json_path);
+  WriteJson(options, results, file);
+  return file.good() ? 0 : -1;
+}
@@ -0,0 +1,106 @@
+//-------------------------------------------------------------------------------------------------------
+// Copyright (C) Taylor Woll and panwave contributors. All rights reserved.
+// Licensed under the MIT license. See LICENSE.txt file in the project root for
+// full license information.
+//-------------------------------------------------------------------------------------------------------
+
+#ifndef ALIGNEDALLOCATOR_H
+#define ALIGNEDALLOCATOR_H
+
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <vector>
+
+#include "Instrumentation.h"
+
+namespace panwave {
+
+/**
+ * The alignment, in bytes, of buffers holding signal data.<br/>
+ * This is the size of a cache line and of the widest vector register the
+ * kernels use.
+ */
+constexpr size_t SignalAlignment = 64;
+
+/**
+ * A standard library allocator which aligns every allocation to
+ * |Alignment| bytes.<br/>
+ * With PANWAVE_INSTRUMENTATION defined, each buffer is recorded in the
+ * profile current when it is allocated, and in that same profile when it is
+ * freed.
+ * @see TreeProfile::Scope
+ */
+template <class T, size_t Alignment = SignalAlignment>
+class AlignedAllocator {
+  static_assert(Alignment >= sizeof(TreeProfile*),
+                "The profile of a buffer is stored in front of it.");
+
+ public:
+  using value_type = T;
+
+  template <class U>
+  struct rebind {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+
+  AlignedAllocator() = default;
+
+  template <class U>
+  explicit AlignedAllocator(
+      const AlignedAllocator<U, Alignment>& /*other*/) noexcept {}
+
+  T* allocate(size_t count) {
+#ifdef PANWAVE_INSTRUMENTATION
+    // The profile is stored in front of the buffer, so the buffer is freed
+    // from the profile it was allocated in whichever thread or scope frees
+    // it.
+    TreeProfile* profile = TreeProfile::GetCurrent();
+    if (profile != nullptr) {
+      profile->RecordBufferAllocation(static_cast<int64_t>(count * sizeof(T)));
+    }
+    auto* block = static_cast<char*>(::operator new(
+        count * sizeof(T) + Alignment, std::align_val_t{Alignment}));
+    std::memcpy(block, &profile, sizeof(profile));
+    return reinterpret_cast<T*>(block + Alignment);
+#else
+    return static_cast<T*>(
+        ::operator new(count * sizeof(T), std::align_val_t{Alignment}));
+#endif
+  }
+
+  void deallocate(T* ptr, size_t count) noexcept {
+#ifdef PANWAVE_INSTRUMENTATION
+    char* block = reinterpret_cast<char*>(ptr) - Alignment;
+    TreeProfile* profile = nullptr;
+    std::memcpy(&profile, block, sizeof(profile));
+    if (profile != nullptr) {
+      profile->RecordBufferAllocation(-static_cast<int64_t>(count * sizeof(T)));
+    }
+    ::operator delete(block, std::align_val_t{Alignment});
+#else
+    static_cast<void>(count);
+    ::operator delete(ptr, std::align_val_t{Alignment});
+#endif
+  }
+
+  template <class U>
+  bool operator==(const AlignedAllocator<U, Alignment>& /*other*/) const {
+    return true;
+  }
+
+  template <class U>
+  bool operator!=(const AlignedAllocator<U, Alignment>& /*other*/) const {
+    return false;
+  }
+};
+
+/**
+ * A vector whose elements begin on a SignalAlignment byte boundary.
+ */
+template <class T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+}  // namespace panwave
+
+#endif  // ALIGNEDALLOCATOR_H
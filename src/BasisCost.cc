@@ -0,0 +1,56 @@
+//-------------------------------------------------------------------------------------------------------
+// Copyright (C) Taylor Woll and panwave contributors. All rights reserved.
+// Licensed under the MIT license. See LICENSE.txt file in the project root for
+// full license information.
+//-------------------------------------------------------------------------------------------------------
+
+#include "BasisCost.h"
+
+#include <cassert>
+#include <cmath>
+
+namespace panwave {
+
+template <class Sample>
+double BasicBasisCost<Sample>::Evaluate(
+    Span<const Sample> coefficients) const {
+  double cost = 0.0;
+
+  switch (this->function) {
+    case CostFunction::ShannonEntropy:
+      // Zero coefficients contribute nothing, the limit of x * log(x).
+      for (const Sample value : coefficients) {
+        const double energy = static_cast<double>(value) * value;
+        if (energy > 0.0) {
+          cost -= energy * std::log(energy);
+        }
+      }
+      break;
+    case CostFunction::LogEnergy:
+      for (const Sample value : coefficients) {
+        const double energy = static_cast<double>(value) * value;
+        if (energy > 0.0) {
+          cost += std::log(energy);
+        }
+      }
+      break;
+    case CostFunction::Threshold:
+      for (const Sample value : coefficients) {
+        if (std::abs(static_cast<double>(value)) > this->threshold) {
+          cost += 1.0;
+        }
+      }
+      break;
+    case CostFunction::Custom:
+      assert(this->custom != nullptr);
+      cost = this->custom(this->context, coefficients);
+      break;
+  }
+
+  return cost;
+}
+
+template struct BasicBasisCost<double>;
+template struct BasicBasisCost<float>;
+
+}  // namespace panwave
@@ -0,0 +1,101 @@
+//-------------------------------------------------------------------------------------------------------
+// Copyright (C) Taylor Woll and panwave contributors. All rights reserved.
+// Licensed under the MIT license. See LICENSE.txt file in the project root for
+// full license information.
+//-------------------------------------------------------------------------------------------------------
+
+#ifndef BASISCOST_H
+#define BASISCOST_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Span.h"
+
+namespace panwave {
+
+/**
+ * The additive cost measures a basis search can reduce.<br/>
+ * ShannonEntropy is -sum(x^2 * log(x^2)) and LogEnergy is sum(log(x^2)),
+ * both skipping zero coefficients. Threshold counts the coefficients whose
+ * magnitude exceeds a threshold. Custom calls a user-supplied function.
+ * @see BasicBasisCost
+ */
+enum class CostFunction : uint8_t {
+  ShannonEntropy = 0,
+  LogEnergy,
+  Threshold,
+  Custom
+};
+
+/**
+ * A cost measure evaluated on the coefficients of a wavelet packet tree
+ * node.<br/>
+ * The cost of a set of nodes is the sum of their costs, so a node is worth
+ * splitting when its children together cost less than it does.
+ * @see BasicWaveletPacketTree::DecomposeBestBasis
+ */
+template <class Sample>
+struct BasicBasisCost {
+  /**
+   * Evaluate the cost of a set of coefficients.
+   */
+  double Evaluate(Span<const Sample> coefficients) const;
+
+  CostFunction function = CostFunction::ShannonEntropy;
+
+  /**
+   * The magnitude coefficients must exceed to be counted by
+   * CostFunction::Threshold.
+   */
+  double threshold = 0.0;
+
+  /**
+   * The function CostFunction::Custom evaluates. It must be additive for the
+   * search to find a meaningful basis. Called with context.
+   */
+  double (*custom)(void* context, Span<const Sample> coefficients) = nullptr;
+  void* context = nullptr;
+};
+
+/**
+ * A cost measure for double coefficients.
+ */
+using BasisCost = BasicBasisCost<double>;
+
+/**
+ * A node selected by a basis search.
+ * @see BasicWaveletPacketTree::DecomposeBestBasis
+ */
+template <class Sample>
+struct BasicBasisNode {
+  /**
+   * The depth of the node. The root has depth 0.
+   */
+  size_t depth;
+
+  /**
+   * The position of the node among the 2^depth nodes at its depth, from
+   * left to right.
+   */
+  size_t position;
+
+  /**
+   * The cost of the coefficients of the node.
+   */
+  double cost;
+
+  /**
+   * The coefficients of the node, held by the tree.
+   */
+  Span<const Sample> coefficients;
+};
+
+/**
+ * A node of a basis of double coefficients.
+ */
+using BasisNode = BasicBasisNode<double>;
+
+}  // namespace panwave
+
+#endif  // BASISCOST_H
@@ -0,0 +1,80 @@
+//-------------------------------------------------------------------------------------------------------
+// Copyright (C) Taylor Woll and panwave contributors. All rights reserved.
+// Licensed under the MIT license. See LICENSE.txt file in the project root for
+// full license information.
+//-------------------------------------------------------------------------------------------------------
+
+#include "InPlaceWaveletPacketTree.h"
+
+#include <cassert>
+
+#include "Wavelet.h"
+
+namespace panwave {
+
+template <class Sample, class Accumulator>
+BasicInPlaceWaveletPacketTree<Sample, Accumulator>::
+    BasicInPlaceWaveletPacketTree(size_t height, const Wavelet* wavelet,
+                                  DyadicMode dyadic_mode,
+                                  TransformEngine engine)
+    : BasicWaveletPacketTree<Sample, Accumulator>(
+          height, wavelet, dyadic_mode, PaddingMode::Periodic, engine) {}
+
+template <class Sample, class Accumulator>
+Span<const Sample>
+BasicInPlaceWaveletPacketTree<Sample, Accumulator>::GetDepthSignal(
+    size_t depth) {
+  assert(depth < this->GetHeight());
+  assert(this->mapped_file_ == nullptr);
+
+  if (depth == 0) {
+    return this->GetNodeData(0).signal;
+  }
+
+  const TreeProfile::Scope scope(&this->profile_);
+  if (this->lazy_) {
+    const size_t first = this->GetNodeAt(depth, 0);
+    for (size_t node = first; node < first + (size_t{1} << depth); node++) {
+      this->GetComputedSignal(node);
+    }
+  }
+  return this->depth_signals_[depth - 1];
+}
+
+template <class Sample, class Accumulator>
+void BasicInPlaceWaveletPacketTree<Sample, Accumulator>::PlaceNodes() {
+  // Mapped trees read every node from the file.
+  if (this->mapped_file_ != nullptr) {
+    this->depth_signals_.clear();
+    return;
+  }
+
+  // The children of each node follow the children of the node before it,
+  // so the nodes at each depth are consecutive.
+  const size_t height = this->GetHeight();
+  this->depth_signals_.resize(height - 1);
+  for (size_t depth = 1; depth < height; depth++) {
+    const size_t first = this->GetNodeAt(depth, 0);
+    const size_t end = first + (size_t{1} << depth);
+    size_t depth_size = 0;
+    for (size_t node = first; node < end; node++) {
+      depth_size += this->GetNodeData(node).signal.size();
+    }
+
+    auto& depth_signal = this->depth_signals_[depth - 1];
+    depth_signal.resize(depth_size);
+    size_t offset = 0;
+    for (size_t node = first; node < end; node++) {
+      auto& data = this->GetNodeData(node);
+      data.signal =
+          Span<Sample>(depth_signal.data() + offset, data.signal.size());
+      offset += data.signal.size();
+    }
+  }
+}
+
+template class BasicInPlaceWaveletPacketTree<double>;
+template class BasicInPlaceWaveletPacketTree<float>;
+template class BasicInPlaceWaveletPacketTree<float, double>;
+
+}  // namespace panwave
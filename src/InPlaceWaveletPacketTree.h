@@ -0,0 +1,109 @@
+//-------------------------------------------------------------------------------------------------------
+// Copyright (C) Taylor Woll and panwave contributors. All rights reserved.
+// Licensed under the MIT license. See LICENSE.txt file in the project root for
+// full license information.
+//-------------------------------------------------------------------------------------------------------
+
+#ifndef INPLACEWAVELETPACKETTREE_H
+#define INPLACEWAVELETPACKETTREE_H
+
+#include <vector>
+
+#include "AlignedAllocator.h"
+#include "Span.h"
+#include "StaticWavelet.h"
+#include "WaveletMath.h"
+#include "WaveletPacketTree.h"
+
+namespace panwave {
+
+class Wavelet;
+
+/**
+ * A wavelet packet tree which keeps each depth in a single buffer as long
+ * as the root signal.<br/>
+ * The signal is padded periodically, so every node holds exactly half as
+ * many coefficients as its parent, rounded up. The nodes at each depth are
+ * stored back to back from left to right, and the two children of a node
+ * cover the same part of the buffer of their depth as the node covers of
+ * its own. When the length of the root signal is a multiple of
+ * 2^(height - 1), which is the usual case, every depth holds exactly as
+ * many coefficients as the root signal. Other lengths round each node up,
+ * which adds fewer than 2^depth coefficients to a depth.<br/>
+ * The tree needs one buffer per depth and no other node storage, so it
+ * holds height - 1 times the length of the root signal whatever the length
+ * of the filters. That holds for a lazy tree as well, which computes only
+ * the nodes it reads but keeps them in the depth buffers. Reconstruction
+ * is exact for orthogonal wavelets.<br/>
+ * Template argument |Sample| is the type of the signal values and
+ * |Accumulator| the type the filters are applied in.
+ * @see PaddingMode
+ * @see WaveletPacketTree
+ */
+template <class Sample, class Accumulator = Sample>
+class BasicInPlaceWaveletPacketTree
+    : public BasicWaveletPacketTree<Sample, Accumulator> {
+ public:
+  /**
+   * Construct an InPlaceWaveletPacketTree instance.<br/>
+   * Root signal is initially unset. Set it before calling Decompose.
+   * @param height Height of the tree. A tree with only one root node
+   *               has height of 1.
+   * @param wavelet Wavelet object used during decomposition /
+   *                reconstruction.
+   * @param dyadic_mode Which mode we should use when dyadically
+   *                    upsampling / downsampling when performing
+   *                    convolutions. (default: Odd)
+   * @param engine How the wavelet filters are applied. A wavelet which
+   *               cannot be factored into lifting steps, such as coif4, is
+   *               applied by convolution instead. (default: Convolution)
+   */
+  BasicInPlaceWaveletPacketTree(
+      size_t height, const Wavelet* wavelet,
+      DyadicMode dyadic_mode = DyadicMode::Odd,
+      TransformEngine engine = TransformEngine::Convolution);
+
+  /**
+   * Construct an InPlaceWaveletPacketTree instance using a compile-time
+   * wavelet.
+   * @see StaticWavelet
+   */
+  template <Wavelet::WaveletType Type, size_t VanishingMoment>
+  BasicInPlaceWaveletPacketTree(
+      size_t height, StaticWavelet<Type, VanishingMoment> /*wavelet*/,
+      DyadicMode dyadic_mode = DyadicMode::Odd,
+      TransformEngine engine = TransformEngine::Convolution)
+      : BasicInPlaceWaveletPacketTree(
+            height, &StaticWavelet<Type, VanishingMoment>::GetWavelet(),
+            dyadic_mode, engine) {}
+  ~BasicInPlaceWaveletPacketTree() override = default;
+
+  /**
+   * Get the coefficients of every node at a depth, back to back from left
+   * to right.<br/>
+   * A lazy tree decomposes every node at the depth first. Other trees must
+   * have been decomposed since the root signal was set. The nodes of a
+   * mapped tree stay in the file, each aligned on its own, so a mapped tree
+   * has no depth signals.
+   * @param depth The depth. Depth 0 holds the root signal and depth
+   *              GetHeight() - 1 the leaves, wavelet level by wavelet level.
+   * @see GetNodeSignal
+   */
+  Span<const Sample> GetDepthSignal(size_t depth);
+
+ protected:
+  void PlaceNodes() override;
+
+ private:
+  // The coefficients of the nodes at each depth below the root.
+  std::vector<AlignedVector<Sample>> depth_signals_;
+};
+
+/**
+ * An in-place wavelet packet tree of double signals.
+ */
+using InPlaceWaveletPacketTree = BasicInPlaceWaveletPacketTree<double>;
+
+}  // namespace panwave
+
+#endif  // INPLACEWAVELETPACKETTREE_H
@@ -0,0 +1,277 @@
+//-------------------------------------------------------------------------------------------------------
+// Copyright (C) Taylor Woll and panwave contributors. All rights reserved.
+// Licensed under the MIT license. See LICENSE.txt file in the project root for
+// full license information.
+//-------------------------------------------------------------------------------------------------------
+
+#include "Instrumentation.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iomanip>
+
+namespace {
+
+#ifdef PANWAVE_INSTRUMENTATION
+thread_local panwave::TreeProfile* current_profile = nullptr;
+// Primitives currently running on this thread, only the outermost records.
+thread_local size_t primitive_depth = 0;
+#endif
+
+const char* GetPrimitiveName(panwave::Primitive primitive) {
+  switch (primitive) {
+    case panwave::Primitive::Convolve:
+      return "Convolve";
+    case panwave::Primitive::Decompose:
+      return "Decompose";
+    case panwave::Primitive::DecomposeDualPhase:
+      return "DecomposeDualPhase";
+    case panwave::Primitive::Reconstruct:
+      return "Reconstruct";
+    case panwave::Primitive::DecomposeChannels:
+      return "DecomposeChannels";
+    case panwave::Primitive::ReconstructChannels:
+      return "ReconstructChannels";
+    case panwave::Primitive::LiftingDecompose:
+      return "LiftingDecompose";
+    case panwave::Primitive::LiftingReconstruct:
+      return "LiftingReconstruct";
+    case panwave::Primitive::DecomposeUndecimated:
+      return "DecomposeUndecimated";
+    case panwave::Primitive::ReconstructUndecimated:
+      return "ReconstructUndecimated";
+    case panwave::Primitive::Threshold:
+      return "Threshold";
+  }
+  return "Unknown";
+}
+
+// Get the depth of a node in a tree where each node has |children|
+// children.
+size_t GetNodeDepth(size_t node, size_t children) {
+  size_t depth = 0;
+  size_t first = 0;
+  size_t width = 1;
+  while (node >= first + width) {
+    first += width;
+    width *= children;
+    depth++;
+  }
+  return depth;
+}
+
+double ToMilliseconds(uint64_t nanoseconds) {
+  return static_cast<double>(nanoseconds) / 1e6;
+}
+
+}  // namespace
+
+namespace panwave {
+
+#ifdef PANWAVE_INSTRUMENTATION
+TreeProfile::Scope::Scope(TreeProfile* profile)
+    : previous_(current_profile) {
+  current_profile = profile;
+}
+
+TreeProfile::Scope::~Scope() { current_profile = this->previous_; }
+
+PrimitiveTimer::PrimitiveTimer(Primitive primitive, size_t filter_size,
+                               uint64_t bytes_read, uint64_t bytes_written)
+    : profile_(primitive_depth++ == 0 ? current_profile : nullptr),
+      primitive_(primitive),
+      filter_size_(filter_size),
+      bytes_read_(bytes_read),
+      bytes_written_(bytes_written) {
+  if (this->profile_ != nullptr) {
+    this->begin_ = std::chrono::steady_clock::now();
+  }
+}
+
+PrimitiveTimer::~PrimitiveTimer() {
+  primitive_depth--;
+  if (this->profile_ == nullptr) {
+    return;
+  }
+  const auto elapsed = std::chrono::steady_clock::now() - this->begin_;
+  this->profile_->RecordPrimitive(
+      this->primitive_, this->filter_size_, this->bytes_read_,
+      this->bytes_written_,
+      static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+              .count()));
+}
+#endif
+
+TreeProfile* TreeProfile::GetCurrent() {
+#ifdef PANWAVE_INSTRUMENTATION
+  return current_profile;
+#else
+  return nullptr;
+#endif
+}
+
+std::vector<PrimitiveCounters> TreeProfile::GetPrimitiveCounters() const {
+  const std::lock_guard<std::mutex> lock(this->mutex_);
+  return this->primitives_;
+}
+
+std::vector<NodeCounters> TreeProfile::GetNodeCounters() const {
+  const std::lock_guard<std::mutex> lock(this->mutex_);
+  return this->nodes_;
+}
+
+NodeCounters TreeProfile::GetDepthCounters(size_t depth) const {
+  const std::lock_guard<std::mutex> lock(this->mutex_);
+  NodeCounters sum = {};
+  for (size_t node = 0; node < this->nodes_.size(); node++) {
+    if (GetNodeDepth(node, this->children_) != depth) {
+      continue;
+    }
+    sum.decompositions += this->nodes_[node].decompositions;
+    sum.decompose_nanoseconds += this->nodes_[node].decompose_nanoseconds;
+    sum.reconstructions += this->nodes_[node].reconstructions;
+    sum.reconstruct_nanoseconds += this->nodes_[node].reconstruct_nanoseconds;
+  }
+  return sum;
+}
+
+size_t TreeProfile::GetDepthCount() const {
+  const std::lock_guard<std::mutex> lock(this->mutex_);
+  if (this->nodes_.empty()) {
+    return 0;
+  }
+  return GetNodeDepth(this->nodes_.size() - 1, this->children_) + 1;
+}
+
+uint64_t TreeProfile::GetBufferAllocationCount() const {
+  const std::lock_guard<std::mutex> lock(this->mutex_);
+  return this->buffer_allocation_count_;
+}
+
+uint64_t TreeProfile::GetBufferAllocatedBytes() const {
+  const std::lock_guard<std::mutex> lock(this->mutex_);
+  return this->buffer_allocated_bytes_;
+}
+
+uint64_t TreeProfile::GetBufferFootprint() const {
+  const std::lock_guard<std::mutex> lock(this->mutex_);
+  return this->footprint_;
+}
+
+uint64_t TreeProfile::GetPeakBufferFootprint() const {
+  const std::lock_guard<std::mutex> lock(this->mutex_);
+  return this->peak_footprint_;
+}
+
+void TreeProfile::Reset() {
+  const std::lock_guard<std::mutex> lock(this->mutex_);
+  this->primitives_.clear();
+  std::fill(this->nodes_.begin(), this->nodes_.end(), NodeCounters{});
+  this->buffer_allocation_count_ = 0;
+  this->buffer_allocated_bytes_ = 0;
+  this->peak_footprint_ = this->footprint_;
+}
+
+void TreeProfile::SetShape(size_t children, size_t node_count) {
+  assert(children >= 2);
+
+  const std::lock_guard<std::mutex> lock(this->mutex_);
+  this->children_ = children;
+  this->nodes_.assign(node_count, NodeCounters{});
+}
+
+void TreeProfile::RecordPrimitive(Primitive primitive, size_t filter_size,
+                                  uint64_t bytes_read, uint64_t bytes_written,
+                                  uint64_t nanoseconds) {
+  const std::lock_guard<std::mutex> lock(this->mutex_);
+  auto counters = std::find_if(
+      this->primitives_.begin(), this->primitives_.end(),
+      [primitive, filter_size](const PrimitiveCounters& counters) {
+        return counters.primitive == primitive &&
+               counters.filter_size == filter_size;
+      });
+  if (counters == this->primitives_.end()) {
+    this->primitives_.push_back({primitive, filter_size, 0, 0, 0, 0});
+    counters = this->primitives_.end() - 1;
+  }
+  counters->calls++;
+  counters->bytes_read += bytes_read;
+  counters->bytes_written += bytes_written;
+  counters->nanoseconds += nanoseconds;
+}
+
+void TreeProfile::RecordNode(size_t node, bool reconstruct,
+                             uint64_t nanoseconds) {
+  const std::lock_guard<std::mutex> lock(this->mutex_);
+  if (node >= this->nodes_.size()) {
+    return;
+  }
+  if (reconstruct) {
+    this->nodes_[node].reconstructions++;
+    this->nodes_[node].reconstruct_nanoseconds += nanoseconds;
+  } else {
+    this->nodes_[node].decompositions++;
+    this->nodes_[node].decompose_nanoseconds += nanoseconds;
+  }
+}
+
+void TreeProfile::RecordBufferAllocation(int64_t bytes) {
+  const std::lock_guard<std::mutex> lock(this->mutex_);
+  if (bytes < 0) {
+    const auto freed = static_cast<uint64_t>(-bytes);
+    this->footprint_ -= std::min(freed, this->footprint_);
+    return;
+  }
+  this->buffer_allocation_count_++;
+  this->buffer_allocated_bytes_ += static_cast<uint64_t>(bytes);
+  this->footprint_ += static_cast<uint64_t>(bytes);
+  this->peak_footprint_ = std::max(this->peak_footprint_, this->footprint_);
+}
+
+void TreeProfile::WriteReport(std::ostream& out) const {
+  if (!InstrumentationEnabled) {
+    out << "panwave was built without PANWAVE_INSTRUMENTATION." << std::endl;
+    return;
+  }
+
+  const std::vector<PrimitiveCounters> primitives =
+      this->GetPrimitiveCounters();
+  const size_t depth_count = this->GetDepthCount();
+
+  out << std::left << std::setw(22) << "Primitive" << std::right
+      << std::setw(8) << "Filter" << std::setw(10) << "Calls"
+      << std::setw(14) << "Bytes read" << std::setw(14) << "Bytes written"
+      << std::setw(12) << "ms" << std::endl;
+  for (const PrimitiveCounters& counters : primitives) {
+    out << std::left << std::setw(22) << GetPrimitiveName(counters.primitive)
+        << std::right << std::setw(8) << counters.filter_size
+        << std::setw(10) << counters.calls << std::setw(14)
+        << counters.bytes_read << std::setw(14) << counters.bytes_written
+        << std::setw(12) << std::fixed << std::setprecision(3)
+        << ToMilliseconds(counters.nanoseconds) << std::endl;
+  }
+
+  out << std::endl
+      << std::left << std::setw(8) << "Depth" << std::right << std::setw(16)
+      << "Decompositions" << std::setw(14) << "Decompose ms" << std::setw(18)
+      << "Reconstructions" << std::setw(16) << "Reconstruct ms" << std::endl;
+  for (size_t depth = 0; depth < depth_count; depth++) {
+    const NodeCounters counters = this->GetDepthCounters(depth);
+    out << std::left << std::setw(8) << depth << std::right << std::setw(16)
+        << counters.decompositions << std::setw(14) << std::fixed
+        << std::setprecision(3)
+        << ToMilliseconds(counters.decompose_nanoseconds) << std::setw(18)
+        << counters.reconstructions << std::setw(16)
+        << ToMilliseconds(counters.reconstruct_nanoseconds) << std::endl;
+  }
+
+  out << std::endl
+      << "Aligned buffer allocations: " << this->GetBufferAllocationCount()
+      << " (" << this->GetBufferAllocatedBytes() << " bytes)" << std::endl
+      << "Aligned buffer footprint: " << this->GetBufferFootprint()
+      << " bytes, peak " << this->GetPeakBufferFootprint() << " bytes"
+      << std::endl;
+}
+
+}  // namespace panwave
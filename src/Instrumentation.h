@@ -0,0 +1,282 @@
+//-------------------------------------------------------------------------------------------------------
+// Copyright (C) Taylor Woll and panwave contributors. All rights reserved.
+// Licensed under the MIT license. See LICENSE.txt file in the project root for
+// full license information.
+//-------------------------------------------------------------------------------------------------------
+
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace panwave {
+
+/**
+ * Whether the library was built with PANWAVE_INSTRUMENTATION defined.<br/>
+ * Without it every timer and counter compiles to nothing and the profiles
+ * of the trees stay empty.
+ * @see TreeProfile
+ */
+#ifdef PANWAVE_INSTRUMENTATION
+constexpr bool InstrumentationEnabled = true;
+#else
+constexpr bool InstrumentationEnabled = false;
+#endif
+
+/**
+ * The WaveletMath primitives counted by a profile. The lifting forms of
+ * Decompose and Reconstruct are counted separately from the convolution
+ * forms. Threshold applies no filter and is counted with a filter length
+ * of zero.
+ */
+enum class Primitive : uint8_t {
+  Convolve = 0,
+  Decompose,
+  DecomposeDualPhase,
+  Reconstruct,
+  DecomposeChannels,
+  ReconstructChannels,
+  LiftingDecompose,
+  LiftingReconstruct,
+  DecomposeUndecimated,
+  ReconstructUndecimated,
+  Threshold
+};
+
+/**
+ * The calls to one primitive with one filter length.
+ */
+struct PrimitiveCounters {
+  Primitive primitive;
+  size_t filter_size;
+  uint64_t calls;
+  // Samples read from the input and written to the outputs, in bytes.
+  uint64_t bytes_read;
+  uint64_t bytes_written;
+  uint64_t nanoseconds;
+};
+
+/**
+ * The work done on one node, or on every node at one depth.<br/>
+ * A decomposition of a node computes its children. A reconstruction of a
+ * node computes the contribution of its coefficients to its parent.
+ */
+struct NodeCounters {
+  uint64_t decompositions;
+  uint64_t decompose_nanoseconds;
+  uint64_t reconstructions;
+  uint64_t reconstruct_nanoseconds;
+};
+
+/**
+ * Counters of the work done by one wavelet packet tree.<br/>
+ * Every call into a tree makes its profile the one the calling thread, and
+ * the task scheduler workers decomposing for it, record into. The profile
+ * collects the calls, traffic and time of each WaveletMath primitive by
+ * filter length, the decompositions and reconstructions of each node with
+ * their time, and the allocations of the aligned buffers holding node
+ * coefficients and scratch signals together with the most bytes those held
+ * at once. Other heap memory, such as std::vector scratch and the growth of
+ * thread_local workspaces, is not counted.<br/>
+ * Nothing is recorded unless the library is built with
+ * PANWAVE_INSTRUMENTATION defined, which the PANWAVE_INSTRUMENTATION CMake
+ * option does.
+ * @see InstrumentationEnabled
+ */
+class TreeProfile {
+ public:
+  TreeProfile() = default;
+  TreeProfile(const TreeProfile&) = delete;
+  TreeProfile(TreeProfile&&) = delete;
+  TreeProfile& operator=(const TreeProfile&) = delete;
+  TreeProfile& operator=(TreeProfile&&) = delete;
+  ~TreeProfile() = default;
+
+  /**
+   * Make a profile the one the calling thread records into while the scope
+   * lives. Scopes nest.
+   */
+  class Scope {
+   public:
+#ifdef PANWAVE_INSTRUMENTATION
+    explicit Scope(TreeProfile* profile);
+    ~Scope();
+#else
+    explicit Scope(TreeProfile* /*profile*/) {}
+    ~Scope() = default;
+#endif
+    Scope(const Scope&) = delete;
+    Scope(Scope&&) = delete;
+    Scope& operator=(const Scope&) = delete;
+    Scope& operator=(Scope&&) = delete;
+
+#ifdef PANWAVE_INSTRUMENTATION
+   private:
+    TreeProfile* previous_;
+#endif
+  };
+
+  /**
+   * Get the counters of every primitive and filter length called so far,
+   * in the order they were first called.
+   */
+  std::vector<PrimitiveCounters> GetPrimitiveCounters() const;
+
+  /**
+   * Get the counters of every node, in tree order.
+   */
+  std::vector<NodeCounters> GetNodeCounters() const;
+
+  /**
+   * Get the sum of the counters of the nodes at a depth. The root has depth
+   * 0.
+   */
+  NodeCounters GetDepthCounters(size_t depth) const;
+
+  /**
+   * Get the number of depths of the tree, which is its height.
+   */
+  size_t GetDepthCount() const;
+
+  /**
+   * Get the number of aligned buffers allocated and the bytes they held.
+   */
+  uint64_t GetBufferAllocationCount() const;
+  uint64_t GetBufferAllocatedBytes() const;
+
+  /**
+   * Get the bytes the aligned buffers of the tree hold now, and the most
+   * they held at once since the profile was reset.
+   */
+  uint64_t GetBufferFootprint() const;
+  uint64_t GetPeakBufferFootprint() const;
+
+  /**
+   * Zero every counter. The peak footprint restarts from the current one.
+   */
+  void Reset();
+
+  /**
+   * Write the counters as a table per primitive and per depth.
+   */
+  void WriteReport(std::ostream& out) const;
+
+  /**
+   * Size the node counters for a tree with |children| children per node
+   * and |node_count| nodes. The counters are zeroed.
+   */
+  void SetShape(size_t children, size_t node_count);
+
+  /**
+   * Record a call to a primitive.
+   */
+  void RecordPrimitive(Primitive primitive, size_t filter_size,
+                       uint64_t bytes_read, uint64_t bytes_written,
+                       uint64_t nanoseconds);
+
+  /**
+   * Record the decomposition or reconstruction of a node.
+   */
+  void RecordNode(size_t node, bool reconstruct, uint64_t nanoseconds);
+
+  /**
+   * Record an aligned buffer of |bytes| being allocated, or freed when
+   * |bytes| is negative.
+   */
+  void RecordBufferAllocation(int64_t bytes);
+
+  /**
+   * Get the profile the calling thread records into, or nullptr.
+   */
+  static TreeProfile* GetCurrent();
+
+ private:
+  mutable std::mutex mutex_;
+  size_t children_ = 2;
+  std::vector<PrimitiveCounters> primitives_;
+  std::vector<NodeCounters> nodes_;
+  uint64_t buffer_allocation_count_ = 0;
+  uint64_t buffer_allocated_bytes_ = 0;
+  uint64_t footprint_ = 0;
+  uint64_t peak_footprint_ = 0;
+};
+
+/**
+ * Times one call to a primitive and records it, along with the bytes it
+ * moves, into the current profile. Calls made from within another
+ * primitive are only counted as part of the outer one.
+ */
+class PrimitiveTimer {
+ public:
+#ifdef PANWAVE_INSTRUMENTATION
+  PrimitiveTimer(Primitive primitive, size_t filter_size, uint64_t bytes_read,
+                 uint64_t bytes_written);
+  ~PrimitiveTimer();
+#else
+  PrimitiveTimer(Primitive /*primitive*/, size_t /*filter_size*/,
+                 uint64_t /*bytes_read*/, uint64_t /*bytes_written*/) {}
+  ~PrimitiveTimer() = default;
+#endif
+  PrimitiveTimer(const PrimitiveTimer&) = delete;
+  PrimitiveTimer(PrimitiveTimer&&) = delete;
+  PrimitiveTimer& operator=(const PrimitiveTimer&) = delete;
+  PrimitiveTimer& operator=(PrimitiveTimer&&) = delete;
+
+#ifdef PANWAVE_INSTRUMENTATION
+ private:
+  TreeProfile* profile_;
+  Primitive primitive_;
+  size_t filter_size_;
+  uint64_t bytes_read_;
+  uint64_t bytes_written_;
+  std::chrono::steady_clock::time_point begin_;
+#endif
+};
+
+/**
+ * Times the decomposition or reconstruction of one node and records it
+ * into a profile.
+ */
+class NodeTimer {
+ public:
+#ifdef PANWAVE_INSTRUMENTATION
+  NodeTimer(TreeProfile* profile, size_t node, bool reconstruct)
+      : profile_(profile),
+        node_(node),
+        reconstruct_(reconstruct),
+        begin_(std::chrono::steady_clock::now()) {}
+  ~NodeTimer() {
+    const auto elapsed = std::chrono::steady_clock::now() - this->begin_;
+    this->profile_->RecordNode(
+        this->node_, this->reconstruct_,
+        static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+                .count()));
+  }
+#else
+  NodeTimer(TreeProfile* /*profile*/, size_t /*node*/,
+            bool /*reconstruct*/) {}
+  ~NodeTimer() = default;
+#endif
+  NodeTimer(const NodeTimer&) = delete;
+  NodeTimer(NodeTimer&&) = delete;
+  NodeTimer& operator=(const NodeTimer&) = delete;
+  NodeTimer& operator=(NodeTimer&&) = delete;
+
+#ifdef PANWAVE_INSTRUMENTATION
+ private:
+  TreeProfile* profile_;
+  size_t node_;
+  bool reconstruct_;
+  std::chrono::steady_clock::time_point begin_;
+#endif
+};
+
+}  // namespace panwave
+
+#endif  // INSTRUMENTATION_H
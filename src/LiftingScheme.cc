@@ -0,0 +1,550 @@
+//-------------------------------------------------------------------------------------------------------
+// Copyright (C) Taylor Woll and panwave contributors. All rights reserved.
+// Licensed under the MIT license. See LICENSE.txt file in the project root for
+// full license information.
+//-------------------------------------------------------------------------------------------------------
+
+#include "LiftingScheme.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "Wavelet.h"
+
+namespace {
+
+using panwave::LiftingScheme;
+using panwave::Wavelet;
+
+// Largest difference we accept between a table coefficient and the value we
+// derive for it from the orthogonal lowpass filter.
+constexpr double FilterTolerance = 1e-6;
+// Largest difference we accept between the polyphase matrix rebuilt from a
+// factorization and the polyphase matrix we factored.
+constexpr double FactorizationTolerance = 1e-9;
+// Quotient terms this small are rounding noise left over from an exact
+// division.
+constexpr double QuotientTolerance = 1e-7;
+// Factorizations with a lifting coefficient larger than this amplify rounding
+// errors too much to be useful.
+constexpr double CoefficientBound = 100.0;
+// Upper bound on the number of division branches explored while factoring.
+constexpr size_t SearchBudget = 1U << 17U;
+constexpr size_t RefinementIterations = 8;
+
+/**
+ * A Laurent polynomial sum(coeffs[i] * z^-(delay + i)).
+ */
+struct Laurent {
+  ptrdiff_t delay = 0;
+  std::vector<double> coeffs;
+
+  bool IsZero() const { return this->coeffs.empty(); }
+  ptrdiff_t Low() const { return this->delay; }
+  ptrdiff_t High() const {
+    return this->delay + static_cast<ptrdiff_t>(this->coeffs.size()) - 1;
+  }
+  ptrdiff_t Span() const {
+    return static_cast<ptrdiff_t>(this->coeffs.size()) - 1;
+  }
+  double At(ptrdiff_t d) const { return this->coeffs[d - this->delay]; }
+
+  /**
+   * Add value to the coefficient of z^-d, growing the polynomial if needed.
+   */
+  void Add(ptrdiff_t d, double value) {
+    if (this->IsZero()) {
+      this->delay = d;
+      this->coeffs.assign(1, value);
+      return;
+    }
+    if (d < this->Low()) {
+      this->coeffs.insert(this->coeffs.begin(), this->Low() - d, 0.0);
+      this->delay = d;
+    } else if (d > this->High()) {
+      this->coeffs.resize(this->coeffs.size() + (d - this->High()), 0.0);
+    }
+    this->coeffs[d - this->delay] += value;
+  }
+};
+
+using Matrix = Laurent[2][2];
+
+/**
+ * Return a + scale * b * c.
+ */
+Laurent MultiplyAdd(const Laurent& a, const Laurent& b, const Laurent& c,
+                    double scale) {
+  Laurent result = a;
+  for (size_t i = 0; i < b.coeffs.size(); i++) {
+    for (size_t j = 0; j < c.coeffs.size(); j++) {
+      result.Add(b.delay + c.delay + static_cast<ptrdiff_t>(i + j),
+                 scale * b.coeffs[i] * c.coeffs[j]);
+    }
+  }
+  return result;
+}
+
+/**
+ * Split a filter into its even and odd polyphase components.
+ */
+void Polyphase(const std::vector<double>& filter, Laurent* even,
+               Laurent* odd) {
+  even->delay = 0;
+  odd->delay = 0;
+  even->coeffs.clear();
+  odd->coeffs.clear();
+  for (size_t i = 0; i < filter.size(); i++) {
+    (i % 2 == 0 ? even : odd)->coeffs.push_back(filter[i]);
+  }
+}
+
+/**
+ * Solve the square linear system a * x = b in place via Gaussian elimination
+ * with partial pivoting. The solution is written to b.
+ */
+void Solve(std::vector<std::vector<double>>* a, std::vector<double>* b) {
+  const size_t n = b->size();
+  auto& m = *a;
+  auto& x = *b;
+
+  for (size_t col = 0; col < n; col++) {
+    size_t pivot = col;
+    for (size_t row = col + 1; row < n; row++) {
+      if (std::abs(m[row][col]) > std::abs(m[pivot][col])) {
+        pivot = row;
+      }
+    }
+    std::swap(m[col], m[pivot]);
+    std::swap(x[col], x[pivot]);
+
+    for (size_t row = 0; row < n; row++) {
+      if (row == col) {
+        continue;
+      }
+      const double f = m[row][col] / m[col][col];
+      for (size_t c = col; c < n; c++) {
+        m[row][c] -= f * m[col][c];
+      }
+      x[row] -= f * x[col];
+    }
+  }
+
+  for (size_t i = 0; i < n; i++) {
+    x[i] /= m[i][i];
+  }
+}
+
+/**
+ * Move lowpass filter h the shortest distance onto the set of filters which
+ * satisfy the orthogonality conditions sum(h[n] * h[n + 2k]) = delta(k) via
+ * minimum-norm Gauss-Newton steps.
+ */
+void MakeOrthogonal(std::vector<double>* h) {
+  const size_t size = h->size();
+  const size_t constraint_count = size / 2;
+  auto& f = *h;
+
+  for (size_t iteration = 0; iteration < RefinementIterations; iteration++) {
+    std::vector<double> residual(constraint_count);
+    std::vector<std::vector<double>> jacobian(constraint_count,
+                                              std::vector<double>(size));
+
+    for (size_t k = 0; k < constraint_count; k++) {
+      double sum = k == 0 ? -1.0 : 0.0;
+      for (size_t n = 0; n + 2 * k < size; n++) {
+        sum += f[n] * f[n + 2 * k];
+        jacobian[k][n] += f[n + 2 * k];
+        jacobian[k][n + 2 * k] += f[n];
+      }
+      residual[k] = sum;
+    }
+
+    // dh = J^T * (J * J^T)^-1 * residual
+    std::vector<std::vector<double>> normal(
+        constraint_count, std::vector<double>(constraint_count));
+    for (size_t i = 0; i < constraint_count; i++) {
+      for (size_t j = 0; j < constraint_count; j++) {
+        for (size_t n = 0; n < size; n++) {
+          normal[i][j] += jacobian[i][n] * jacobian[j][n];
+        }
+      }
+    }
+    Solve(&normal, &residual);
+
+    for (size_t n = 0; n < size; n++) {
+      for (size_t k = 0; k < constraint_count; k++) {
+        f[n] -= jacobian[k][n] * residual[k];
+      }
+    }
+  }
+}
+
+bool IsClose(const std::vector<double>& a, const std::vector<double>& b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.size(); i++) {
+    if (!(std::abs(a[i] - b[i]) <= FilterTolerance)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * A lifting factorization found by Factorizer.
+ */
+struct Candidate {
+  std::vector<LiftingScheme::Step> steps;
+  double scales[2];
+  ptrdiff_t delays[2];
+  size_t cost;
+  double max_coeff;
+};
+
+/**
+ * Searches for the lifting factorization of a polyphase matrix with the
+ * fewest multiplications.<br/>
+ * The factorization runs the Euclidean algorithm on the first row of the
+ * polyphase matrix via column operations. Each column operation
+ * corresponds to one lifting step. Laurent polynomial division is not
+ * unique, whenever the dividend and divisor have the same span we can
+ * remove either the lowest or highest term of the dividend and which
+ * polynomial we divide by which is also a choice. Different choices lead to
+ * factorizations with different costs and very different numeric
+ * stability, so we explore all of them and keep the best.
+ */
+class Factorizer {
+ public:
+  explicit Factorizer(const Matrix& target) {
+    for (size_t r = 0; r < 2; r++) {
+      for (size_t c = 0; c < 2; c++) {
+        this->target_[r][c] = target[r][c];
+      }
+    }
+  }
+
+  bool Run(Candidate* best) {
+    Matrix m;
+    for (size_t r = 0; r < 2; r++) {
+      for (size_t c = 0; c < 2; c++) {
+        m[r][c] = this->target_[r][c];
+      }
+    }
+    std::vector<LiftingScheme::Step> steps;
+    this->Explore(m, &steps);
+
+    if (!this->found_) {
+      return false;
+    }
+    *best = this->best_;
+    return true;
+  }
+
+ private:
+  static void AppendStep(std::vector<LiftingScheme::Step>* steps,
+                         size_t target, const Laurent& filter) {
+    steps->push_back({target, filter.delay, filter.coeffs});
+  }
+
+  static double MaxAbs(const Laurent& p) {
+    double max = 0.0;
+    for (const double c : p.coeffs) {
+      max = std::max(max, std::abs(c));
+    }
+    return max;
+  }
+
+  /**
+   * Remove the term of a at delay da by subtracting a multiple of b shifted
+   * to line up its term at db with it. The multiple is recorded in q.
+   */
+  static void Eliminate(Laurent* a, const Laurent& b, Laurent* q,
+                        bool low_end) {
+    const ptrdiff_t da = low_end ? a->Low() : a->High();
+    const ptrdiff_t db = low_end ? b.Low() : b.High();
+    const double f = a->At(da) / b.At(db);
+    const ptrdiff_t shift = da - db;
+
+    q->Add(shift, f);
+    for (size_t i = 0; i < b.coeffs.size(); i++) {
+      a->coeffs[b.delay + shift + static_cast<ptrdiff_t>(i) - a->delay] -=
+          f * b.coeffs[i];
+    }
+    if (low_end) {
+      a->coeffs.erase(a->coeffs.begin());
+      a->delay++;
+    } else {
+      a->coeffs.pop_back();
+    }
+  }
+
+  void Explore(const Matrix& m, std::vector<LiftingScheme::Step>* steps) {
+    if (++this->explored_ > SearchBudget) {
+      return;
+    }
+
+    if (m[0][0].IsZero() || m[0][1].IsZero()) {
+      this->Finish(m, *steps);
+      return;
+    }
+
+    const ptrdiff_t span0 = m[0][0].Span();
+    const ptrdiff_t span1 = m[0][1].Span();
+    for (size_t column = 0; column < 2; column++) {
+      if ((column == 0 && span0 < span1) || (column == 1 && span1 < span0)) {
+        continue;
+      }
+      this->Divide(m, column, m[0][column], Laurent(), steps);
+    }
+  }
+
+  /**
+   * Divide m[0][column] by m[0][1 - column], branching on each choice.
+   * remainder and quotient hold the division state so far.
+   */
+  void Divide(const Matrix& m, size_t column, const Laurent& remainder,
+              const Laurent& quotient,
+              std::vector<LiftingScheme::Step>* steps) {
+    if (MaxAbs(quotient) > CoefficientBound ||
+        this->explored_ > SearchBudget) {
+      return;
+    }
+
+    const Laurent& divisor = m[0][1 - column];
+    if (remainder.IsZero() || remainder.Span() < divisor.Span()) {
+      // Column operation c[column] -= quotient * c[1 - column]. It is undone
+      // by the lifting step which adds quotient times stream column to
+      // stream 1 - column.
+      Matrix next;
+      next[0][column] = remainder;
+      next[0][1 - column] = m[0][1 - column];
+      next[1][column] = MultiplyAdd(m[1][column], quotient, m[1][1 - column],
+                                    -1.0);
+      next[1][1 - column] = m[1][1 - column];
+
+      AppendStep(steps, 1 - column, quotient);
+      this->Explore(next, steps);
+      steps->pop_back();
+      return;
+    }
+
+    for (const bool low_end : {true, false}) {
+      // Only equal spans leave us a choice of end.
+      if (!low_end && remainder.Span() > divisor.Span()) {
+        break;
+      }
+      Laurent r = remainder;
+      Laurent q = quotient;
+      Eliminate(&r, divisor, &q, low_end);
+      this->Divide(m, column, r, q, steps);
+    }
+  }
+
+  /**
+   * The first row of m has a zero. Finish the factorization and keep it if
+   * it is better than the best one found so far.
+   */
+  void Finish(const Matrix& input, std::vector<LiftingScheme::Step> steps) {
+    Matrix m;
+    for (size_t r = 0; r < 2; r++) {
+      for (size_t c = 0; c < 2; c++) {
+        m[r][c] = input[r][c];
+      }
+    }
+
+    if (m[0][0].IsZero()) {
+      // Swap the role of the columns via two more column operations.
+      Laurent one;
+      one.Add(0, 1.0);
+      m[0][0] = m[0][1];
+      m[1][0] = MultiplyAdd(m[1][0], one, m[1][1], 1.0);
+      AppendStep(&steps, 1, MultiplyAdd(Laurent(), one, one, -1.0));
+      m[0][1] = Laurent();
+      m[1][1] = MultiplyAdd(m[1][1], one, m[1][0], -1.0);
+      AppendStep(&steps, 0, one);
+    }
+
+    if (m[0][0].coeffs.size() != 1 || m[1][1].IsZero()) {
+      return;
+    }
+
+    // The determinant of the polyphase matrix is a monomial so what remains
+    // of m[1][1] is too, up to rounding.
+    const Laurent& y = m[1][1];
+    size_t dominant = 0;
+    for (size_t i = 1; i < y.coeffs.size(); i++) {
+      if (std::abs(y.coeffs[i]) > std::abs(y.coeffs[dominant])) {
+        dominant = i;
+      }
+    }
+    const double scale1 = y.coeffs[dominant];
+    const ptrdiff_t delay1 = y.delay + static_cast<ptrdiff_t>(dominant);
+
+    Laurent t;
+    for (size_t i = 0; i < m[1][0].coeffs.size(); i++) {
+      const double c = m[1][0].coeffs[i] / scale1;
+      if (std::abs(c) > QuotientTolerance) {
+        t.Add(m[1][0].delay + static_cast<ptrdiff_t>(i) - delay1, c);
+      }
+    }
+    if (!t.IsZero()) {
+      AppendStep(&steps, 1, t);
+    }
+
+    Candidate candidate;
+    candidate.steps = std::move(steps);
+    candidate.scales[0] = m[0][0].coeffs[0];
+    candidate.delays[0] = m[0][0].delay;
+    candidate.scales[1] = scale1;
+    candidate.delays[1] = delay1;
+    candidate.cost = 0;
+    candidate.max_coeff = 0.0;
+    for (const auto& step : candidate.steps) {
+      candidate.cost += step.coeffs.size();
+      for (const double c : step.coeffs) {
+        candidate.max_coeff = std::max(candidate.max_coeff, std::abs(c));
+      }
+    }
+
+    if (candidate.max_coeff > CoefficientBound) {
+      return;
+    }
+    if (this->found_ &&
+        (candidate.cost > this->best_.cost ||
+         (candidate.cost == this->best_.cost &&
+          candidate.max_coeff >= this->best_.max_coeff))) {
+      return;
+    }
+    if (this->Error(candidate) > FactorizationTolerance) {
+      return;
+    }
+
+    this->best_ = std::move(candidate);
+    this->found_ = true;
+  }
+
+  /**
+   * Rebuild the polyphase matrix from a factorization and return the
+   * largest difference from the matrix we factored.
+   */
+  double Error(const Candidate& candidate) const {
+    Laurent one;
+    one.Add(0, 1.0);
+    Matrix p;
+    p[0][0] = one;
+    p[1][1] = one;
+
+    for (const auto& step : candidate.steps) {
+      Laurent filter;
+      filter.delay = step.delay;
+      filter.coeffs = step.coeffs;
+      const size_t target = step.target;
+      for (size_t c = 0; c < 2; c++) {
+        p[target][c] = MultiplyAdd(p[target][c], filter, p[1 - target][c], 1.0);
+      }
+    }
+
+    double error = 0.0;
+    for (size_t r = 0; r < 2; r++) {
+      Laurent scale;
+      scale.Add(candidate.delays[r], candidate.scales[r]);
+      for (size_t c = 0; c < 2; c++) {
+        const Laurent rebuilt =
+            MultiplyAdd(Laurent(), scale, p[r][c], 1.0);
+        Laurent difference =
+            MultiplyAdd(rebuilt, this->target_[r][c], one, -1.0);
+        error = std::max(error, MaxAbs(difference));
+      }
+    }
+    return error;
+  }
+
+  Matrix target_;
+  Candidate best_;
+  bool found_ = false;
+  size_t explored_ = 0;
+};
+
+}  // namespace
+
+namespace panwave {
+
+bool LiftingScheme::Factor(const Wavelet& wavelet, LiftingScheme* scheme) {
+  assert(scheme);
+
+  *scheme = LiftingScheme();
+
+  const size_t filter_size = wavelet.lowpassDecompositionFilter_.size();
+  if (filter_size < 2 || filter_size % 2 != 0) {
+    return false;
+  }
+
+  std::vector<double> lowpass = wavelet.lowpassDecompositionFilter_;
+  MakeOrthogonal(&lowpass);
+
+  // The highpass filter of an orthogonal wavelet is the quadrature mirror of
+  // the lowpass filter and the reconstruction filters are the decomposition
+  // filters reversed.
+  std::vector<double> highpass(filter_size);
+  for (size_t i = 0; i < filter_size; i++) {
+    highpass[i] = (i % 2 == 0 ? -1.0 : 1.0) * lowpass[filter_size - 1 - i];
+  }
+
+  const std::vector<double> lowpass_reversed(
+      wavelet.lowpassReconstructionFilter_.crbegin(),
+      wavelet.lowpassReconstructionFilter_.crend());
+  const std::vector<double> highpass_reversed(
+      wavelet.highpassReconstructionFilter_.crbegin(),
+      wavelet.highpassReconstructionFilter_.crend());
+
+  if (!IsClose(lowpass, wavelet.lowpassDecompositionFilter_) ||
+      !IsClose(highpass, wavelet.highpassDecompositionFilter_) ||
+      !IsClose(lowpass, lowpass_reversed) ||
+      !IsClose(highpass, highpass_reversed)) {
+    return false;
+  }
+
+  Matrix polyphase;
+  Polyphase(lowpass, &polyphase[0][0], &polyphase[0][1]);
+  Polyphase(highpass, &polyphase[1][0], &polyphase[1][1]);
+
+  Candidate best;
+  if (!Factorizer(polyphase).Run(&best)) {
+    return false;
+  }
+
+  scheme->steps_ = std::move(best.steps);
+  scheme->inverse_steps_.assign(scheme->steps_.crbegin(),
+                                scheme->steps_.crend());
+  for (auto& step : scheme->inverse_steps_) {
+    for (double& c : step.coeffs) {
+      c = -c;
+    }
+  }
+  for (size_t s = 0; s < 2; s++) {
+    scheme->scales_[s] = best.scales[s];
+    scheme->delays_[s] = best.delays[s];
+  }
+  scheme->reconstruction_filters_[0].assign(lowpass.crbegin(),
+                                            lowpass.crend());
+  scheme->reconstruction_filters_[1].assign(highpass.crbegin(),
+                                            highpass.crend());
+  scheme->filter_size_ = filter_size;
+  return true;
+}
+
+size_t LiftingScheme::GetMultiplyCount() const {
+  // One multiplication per lifting coefficient plus the two scale factors.
+  size_t count = 2;
+  for (const auto& step : this->steps_) {
+    count += step.coeffs.size();
+  }
+  return count;
+}
+
+}  // namespace panwave
@@ -0,0 +1,135 @@
+//-------------------------------------------------------------------------------------------------------
+// Copyright (C) Taylor Woll and panwave contributors. All rights reserved.
+// Licensed under the MIT license. See LICENSE.txt file in the project root for
+// full license information.
+//-------------------------------------------------------------------------------------------------------
+
+#ifndef LIFTINGSCHEME_H
+#define LIFTINGSCHEME_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace panwave {
+
+class Wavelet;
+
+/**
+ * A factorization of a wavelet filter bank into lifting steps.<br/>
+ * The signal is split into two interleaved streams of samples. Stream 0
+ * holds the samples at the positions the dyadic mode keeps during
+ * downsampling and stream 1 holds the samples immediately before those.
+ * Each lifting step adds a filtered copy of one stream to the other, in
+ * place. After all steps, stream 0 holds the (unscaled) approximation
+ * coefficients and stream 1 the (unscaled) details coefficients. Running
+ * the steps backwards with the opposite sign inverts the transform.<br/>
+ * Compared to filtering the signal with the lowpass and highpass filters
+ * directly, lifting needs roughly half the multiply-adds to decompose a
+ * signal, or to reconstruct it from its approximation and details
+ * coefficients together. Reconstructing from either kind alone still runs
+ * every step.
+ * @see Factor
+ * @see WaveletMath::Decompose
+ * @see WaveletMath::Reconstruct
+ */
+class LiftingScheme {
+ public:
+  /**
+   * A single lifting step.<br/>
+   * For each index m, stream[target][m] is incremented by
+   * sum(coeffs[i] * stream[1 - target][m - delay - i]).
+   */
+  struct Step {
+    size_t target;
+    ptrdiff_t delay;
+    std::vector<double> coeffs;
+  };
+
+  /**
+   * Factor the filters of an orthogonal wavelet into lifting steps.<br/>
+   * The factorization is computed from the lowpass decomposition filter
+   * after correcting it to be exactly orthogonal. The coefficient tables
+   * only carry between 9 and 15 significant digits, so they are not quite
+   * orthogonal, and a factorization of the uncorrected filter is
+   * numerically unstable. The correction moves no coefficient of the
+   * built-in Daubechies and Symlet wavelets by more than 1e-7. Results
+   * computed via the lifting scheme therefore match the results of
+   * filtering with the wavelet filters to the precision of the tables.
+   * @param wavelet The wavelet whose filters we want to factor.
+   * @param scheme Destination lifting scheme. Existing contents are
+   *               overwritten.
+   * @return False if the wavelet is not orthogonal or its highpass and
+   * reconstruction filters are not derived from its lowpass decomposition
+   * filter the way they are for the built-in Daubechies and Symlet wavelets.
+   * The scheme is left empty in this case.
+   */
+  static bool Factor(const Wavelet& wavelet, LiftingScheme* scheme);
+
+  /**
+   * Return true if this scheme holds a factorization.
+   */
+  bool IsEmpty() const { return this->filter_size_ == 0; }
+
+  /**
+   * Get the lifting steps in the order the forward transform applies them.
+   */
+  const std::vector<Step>& GetSteps() const { return this->steps_; }
+
+  /**
+   * Get the lifting steps which undo the forward transform, in the order the
+   * inverse transform applies them.<br/>
+   * These are the forward steps in reverse order with negated coefficients.
+   */
+  const std::vector<Step>& GetInverseSteps() const {
+    return this->inverse_steps_;
+  }
+
+  /**
+   * Get the scale factor applied to stream |stream| after the last step.
+   */
+  double GetScale(size_t stream) const { return this->scales_[stream]; }
+
+  /**
+   * Get the delay applied to stream |stream| after the last step.<br/>
+   * Output m of the stream is the scaled stream value at m - delay.
+   */
+  ptrdiff_t GetDelay(size_t stream) const { return this->delays_[stream]; }
+
+  /**
+   * Get the length of the wavelet filters this scheme was factored from.
+   */
+  size_t GetFilterSize() const { return this->filter_size_; }
+
+  /**
+   * Get the reconstruction filter matching stream |stream|.<br/>
+   * This is the corrected orthogonal filter the scheme was factored from,
+   * reversed. It is used for signals too short to reconstruct via lifting.
+   */
+  const std::vector<double>& GetReconstructionFilter(size_t stream) const {
+    return this->reconstruction_filters_[stream];
+  }
+
+  /**
+   * Get the number of multiplications needed to produce one approximation
+   * and one details coefficient, or to reconstruct one pair of samples
+   * from them.<br/>
+   * Filtering with the wavelet filters directly needs twice the filter size
+   * for either. Reconstructing a pair of samples from one kind of
+   * coefficients alone needs the filter size by convolution, but this many
+   * via lifting.
+   */
+  size_t GetMultiplyCount() const;
+
+ private:
+  std::vector<Step> steps_;
+  std::vector<Step> inverse_steps_;
+  std::vector<double> reconstruction_filters_[2];
+  double scales_[2] = {};
+  ptrdiff_t delays_[2] = {};
+  size_t filter_size_ = 0;
+};
+
+}  // namespace panwave
+
+#endif  // LIFTINGSCHEME_H
@@ -0,0 +1,26 @@
+//-------------------------------------------------------------------------------------------------------
+// Copyright (C) Taylor Woll and panwave contributors. All rights reserved.
+// Licensed under the MIT license. See LICENSE.txt file in the project root for
+// full license information.
+//-------------------------------------------------------------------------------------------------------
+
+#include "MultichannelWaveletPacketTree.h"
+
+#include "Wavelet.h"
+
+namespace panwave {
+
+template <class Sample, class Accumulator>
+BasicMultichannelWaveletPacketTree<Sample, Accumulator>::
+    BasicMultichannelWaveletPacketTree(size_t height, const Wavelet* wavelet,
+                                       size_t channel_count,
+                                       DyadicMode dyadic_mode,
+                                       PaddingMode padding_mode)
+    : BasicWaveletPacketTree<Sample, Accumulator>(
+          height, wavelet, channel_count, dyadic_mode, padding_mode) {}
+
+template class BasicMultichannelWaveletPacketTree<double>;
+template class BasicMultichannelWaveletPacketTree<float>;
+template class BasicMultichannelWaveletPacketTree<float, double>;
+
+}  // namespace panwave
@@ -0,0 +1,84 @@
+//-------------------------------------------------------------------------------------------------------
+// Copyright (C) Taylor Woll and panwave contributors. All rights reserved.
+// Licensed under the MIT license. See LICENSE.txt file in the project root for
+// full license information.
+//-------------------------------------------------------------------------------------------------------
+
+#ifndef MULTICHANNELWAVELETPACKETTREE_H
+#define MULTICHANNELWAVELETPACKETTREE_H
+
+#include "StaticWavelet.h"
+#include "WaveletMath.h"
+#include "WaveletPacketTree.h"
+
+namespace panwave {
+
+class Wavelet;
+
+/**
+ * A wavelet packet tree which decomposes and reconstructs several signals
+ * of the same length together.<br/>
+ * The root signal holds channel_count signals interleaved so element i of
+ * channel c is at index i * channel_count + c. Every node, and every signal
+ * reconstructed into the root or by ReconstructAll, is interleaved the same
+ * way. Each channel gets exactly the coefficients a WaveletPacketTree of the
+ * same shape computes from that channel alone.<br/>
+ * The kernels run their vector lanes across the channels rather than along
+ * a signal, so a tree over many short signals keeps every lane busy and
+ * walks the tree once for all of them.
+ * @see WaveletMath::DecomposeChannels
+ */
+template <class Sample, class Accumulator = Sample>
+class BasicMultichannelWaveletPacketTree
+    : public BasicWaveletPacketTree<Sample, Accumulator> {
+ public:
+  /**
+   * Construct a BasicMultichannelWaveletPacketTree instance.<br/>
+   * Root signal is initially unset. Set it before calling Decompose.
+   * @param height Height of the tree. A tree with only one root node
+   *               has height of 1.
+   * @param wavelet Wavelet object used during decomposition /
+   *                reconstruction.
+   * @param channel_count The number of signals interleaved in the root
+   *                      signal.
+   * @param dyadic_mode Which mode we should use when dyadically
+   *                    upsampling / downsampling when performing
+   *                    convolutions. (default: Odd)
+   * @param padding_mode How we should pad the signal data during
+   *                     decomposition / reconstruction. (default: Zeroes)
+   */
+  BasicMultichannelWaveletPacketTree(
+      size_t height, const Wavelet* wavelet, size_t channel_count,
+      DyadicMode dyadic_mode = DyadicMode::Odd,
+      PaddingMode padding_mode = PaddingMode::Zeroes);
+
+  /**
+   * Construct a BasicMultichannelWaveletPacketTree instance using a
+   * compile-time wavelet.
+   * @see StaticWavelet
+   */
+  template <Wavelet::WaveletType Type, size_t VanishingMoment>
+  BasicMultichannelWaveletPacketTree(
+      size_t height, StaticWavelet<Type, VanishingMoment> /*wavelet*/,
+      size_t channel_count, DyadicMode dyadic_mode = DyadicMode::Odd,
+      PaddingMode padding_mode = PaddingMode::Zeroes)
+      : BasicMultichannelWaveletPacketTree(
+            height, &StaticWavelet<Type, VanishingMoment>::GetWavelet(),
+            channel_count, dyadic_mode, padding_mode) {}
+  ~BasicMultichannelWaveletPacketTree() override = default;
+
+  /**
+   * Get the number of signals interleaved in the root signal.
+   */
+  size_t GetChannelCount() const { return this->channel_count_; }
+};
+
+/**
+ * A multichannel wavelet packet tree of double signals.
+ */
+using MultichannelWaveletPacketTree =
+    BasicMultichannelWaveletPacketTree<double>;
+
+}  // namespace panwave
+
+#endif  // MULTICHANNELWAVELETPACKETTREE_H
@@ -0,0 +1,77 @@
+//-------------------------------------------------------------------------------------------------------
+// Copyright (C) Taylor Woll and panwave contributors. All rights reserved.
+// Licensed under the MIT license. See LICENSE.txt file in the project root for
+// full license information.
+//-------------------------------------------------------------------------------------------------------
+
+#ifndef SPAN_H
+#define SPAN_H
+
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace panwave {
+
+/**
+ * A non-owning view of a contiguous array of elements.<br/>
+ * This is a minimal stand-in for std::span, which is not available in
+ * c++17. The member names follow std::span so the two are interchangeable
+ * in generic code.<br/>
+ * A Span<T> converts implicitly from any container with data() and size()
+ * members returning T* and size_t, and from a Span of a less qualified
+ * element type. Span<double> converts to Span<const double>, for example.
+ */
+template <class T>
+class Span {
+ public:
+  using element_type = T;
+  using value_type = std::remove_cv_t<T>;
+  using iterator = T*;
+
+  constexpr Span() = default;
+  constexpr Span(T* data, size_t size) : data_(data), size_(size) {}
+
+  template <class Container,
+            class = std::enable_if_t<std::is_convertible_v<
+                decltype(std::declval<Container&>().data()), T*>>>
+  constexpr Span(Container& container)  // NOLINT(google-explicit-constructor)
+      : data_(container.data()), size_(container.size()) {}
+
+  template <class U, class = std::enable_if_t<
+                         std::is_convertible_v<U (*)[], T (*)[]>>>
+  constexpr Span(const Span<U>& other)  // NOLINT(google-explicit-constructor)
+      : data_(other.data()), size_(other.size()) {}
+
+  constexpr T* data() const { return this->data_; }
+  constexpr size_t size() const { return this->size_; }
+  constexpr bool empty() const { return this->size_ == 0; }
+
+  constexpr T* begin() const { return this->data_; }
+  constexpr T* end() const { return this->data_ + this->size_; }
+
+  constexpr T& operator[](size_t index) const {
+    assert(index < this->size_);
+    return this->data_[index];
+  }
+
+  constexpr T& front() const { return (*this)[0]; }
+  constexpr T& back() const { return (*this)[this->size_ - 1]; }
+
+  /**
+   * Return a view of count elements beginning at element offset.
+   */
+  constexpr Span subspan(size_t offset, size_t count) const {
+    assert(offset + count <= this->size_);
+    return Span(this->data_ + offset, count);
+  }
+
+ private:
+  T* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+}  // namespace panwave
+
+#endif  // SPAN_H
@@ -25,179 +25,201 @@ constexpr size_t ChildIndexSouthEast = 3;
 
 namespace panwave {
 
-StationaryWaveletPacketTree::StationaryWaveletPacketTree(
-    size_t height, const Wavelet* wavelet, PaddingMode padding_mode)
-    : WaveletPacketTreeTemplateBase(height, wavelet),
+template <class Sample, class Accumulator>
+BasicStationaryWaveletPacketTree<Sample, Accumulator>::
+    BasicStationaryWaveletPacketTree(size_t height, const Wavelet* wavelet,
+                                     PaddingMode padding_mode,
+                                     TransformEngine engine)
+    : WaveletPacketTreeTemplateBase<4, Sample, Accumulator>(height, wavelet,
+                                                            engine),
       padding_mode_(padding_mode) {}
 
-void StationaryWaveletPacketTree::Decompose() { this->DecomposeNode(0); }
+template <class Sample, class Accumulator>
+DyadicMode
+BasicStationaryWaveletPacketTree<Sample, Accumulator>::GetChildDyadicMode(
+    size_t child_index) const {
+  // The west children come from the even decomposition and the east
+  // children from the odd one.
+  return child_index == ChildIndexNorthWest ||
+                 child_index == ChildIndexSouthWest
+             ? DyadicMode::Even
+             : DyadicMode::Odd;
+}
 
-void StationaryWaveletPacketTree::DecomposeNode(size_t node) {
-  if (this->IsLeaf(node)) {
-    return;
-  }
+template <class Sample, class Accumulator>
+CoefficientType
+BasicStationaryWaveletPacketTree<Sample, Accumulator>::GetChildCoefficientType(
+    size_t child_index) const {
+  return child_index == ChildIndexNorthWest ||
+                 child_index == ChildIndexNorthEast
+             ? CoefficientType::Approximation
+             : CoefficientType::Details;
+}
 
+template <class Sample, class Accumulator>
+void BasicStationaryWaveletPacketTree<Sample, Accumulator>::
+    DecomposeNodeSignal(size_t node) {
   const size_t nw_child = this->GetChild(node, ChildIndexNorthWest);
   const size_t ne_child = this->GetChild(node, ChildIndexNorthEast);
   const size_t sw_child = this->GetChild(node, ChildIndexSouthWest);
   const size_t se_child = this->GetChild(node, ChildIndexSouthEast);
 
-  WaveletMath::Decompose(this->GetNodeData(node).signal,
-                         this->wavelet_->lowpassDecompositionFilter_,
-                         this->wavelet_->highpassDecompositionFilter_,
-                         &this->GetNodeData(nw_child).signal,
-                         &this->GetNodeData(sw_child).signal, DyadicMode::Even,
-                         this->padding_mode_);
-
-  WaveletMath::Decompose(this->GetNodeData(node).signal,
-                         this->wavelet_->lowpassDecompositionFilter_,
-                         this->wavelet_->highpassDecompositionFilter_,
-                         &this->GetNodeData(ne_child).signal,
-                         &this->GetNodeData(se_child).signal, DyadicMode::Odd,
-                         this->padding_mode_);
-
-  this->DecomposeNode(nw_child);
-  this->DecomposeNode(ne_child);
-  this->DecomposeNode(sw_child);
-  this->DecomposeNode(se_child);
+  if (this->engine_ == TransformEngine::Convolution) {
+    // Both decompositions filter the same signal with the same filters, only
+    // the phase they keep differs. Filter once and split the result between
+    // the west and east children.
+    WaveletMath::DecomposeDualPhase<Sample, Accumulator>(
+        this->GetNodeData(node).signal, this->lowpass_decomposition_filter_,
+        this->highpass_decomposition_filter_,
+        this->GetNodeData(nw_child).signal, this->GetNodeData(sw_child).signal,
+        this->GetNodeData(ne_child).signal, this->GetNodeData(se_child).signal,
+        this->padding_mode_);
+  } else {
+    this->DecomposeSignal(this->GetNodeData(node).signal,
+                          this->GetNodeData(nw_child).signal,
+                          this->GetNodeData(sw_child).signal, DyadicMode::Even,
+                          this->padding_mode_);
+
+    this->DecomposeSignal(this->GetNodeData(node).signal,
+                          this->GetNodeData(ne_child).signal,
+                          this->GetNodeData(se_child).signal, DyadicMode::Odd,
+                          this->padding_mode_);
+  }
 }
 
-void StationaryWaveletPacketTree::ReconstructNode(size_t node) {
-  if (this->IsLeaf(node)) {
-    return;
+template <class Sample, class Accumulator>
+void BasicStationaryWaveletPacketTree<Sample,
+                                      Accumulator>::PrepareLevelBuffers() {
+  const size_t height = this->GetHeight();
+  this->level_sums_.resize(height);
+  this->level_terms_.resize(height);
+
+  // Even decompositions round up so the north west node is the largest one
+  // at each depth.
+  size_t node = 0;
+  for (size_t depth = 0; depth < height; depth++) {
+    const size_t size = this->GetNodeData(node).signal.size();
+    this->level_sums_[depth].resize(size);
+    this->level_terms_[depth].resize(size);
+    if (!this->IsLeaf(node)) {
+      node = this->GetChild(node, ChildIndexNorthWest);
+    }
   }
+}
 
-  const size_t nw_child = this->GetChild(node, ChildIndexNorthWest);
-  const size_t ne_child = this->GetChild(node, ChildIndexNorthEast);
-  const size_t sw_child = this->GetChild(node, ChildIndexSouthWest);
-  const size_t se_child = this->GetChild(node, ChildIndexSouthEast);
+template <class Sample, class Accumulator>
+void BasicStationaryWaveletPacketTree<Sample, Accumulator>::
+    ReconstructLevelNode(size_t node, size_t depth, size_t level,
+                         Span<Sample> signal) {
+  assert(!this->IsLeaf(node));
+  assert(signal.size() == this->GetNodeData(node).signal.size());
+
+  // The level picks either the two approximation or the two details
+  // children at each depth, the deepest depth being the least significant
+  // bit of the level. One child is decomposed with even and the other with
+  // odd downsampling.
+  const size_t bit = this->GetHeight() - 2 - depth;
+  const size_t first_child = ((level >> bit) & 1U) != 0U
+                                 ? ChildIndexSouthWest
+                                 : ChildIndexNorthWest;
+  const Span<Sample> term =
+      Span<Sample>(this->level_terms_[depth]).subspan(0, signal.size());
+
+  for (size_t child_index = first_child; child_index < first_child + 2;
+       child_index++) {
+    const size_t child = this->GetChild(node, child_index);
+    Span<const Sample> coeffs = this->GetNodeData(child).signal;
+
+    if (this->IsLeaf(child)) {
+      coeffs = this->GetComputedSignal(child);
+    } else {
+      const Span<Sample> sum = Span<Sample>(this->level_sums_[depth + 1])
+                                   .subspan(0, coeffs.size());
+      this->ReconstructLevelNode(child, depth + 1, level, sum);
+      coeffs = sum;
+    }
 
-  ReconstructNode(nw_child);
-  ReconstructNode(ne_child);
-  ReconstructNode(sw_child);
-  ReconstructNode(se_child);
-
-  DyadicMode dyad_mode = DyadicMode::Even;
-  const std::vector<double>* child_signal = nullptr;
-  const std::vector<double>* reconstruction_filter = nullptr;
-
-  if (this->IsMarked(nw_child)) {
-    assert(!this->IsMarked(sw_child) && !this->IsMarked(ne_child) &&
-           !this->IsMarked(se_child));
-    dyad_mode = DyadicMode::Even;
-    child_signal = &this->GetNodeData(nw_child).signal;
-    reconstruction_filter = &this->wavelet_->lowpassReconstructionFilter_;
-  } else if (this->IsMarked(sw_child)) {
-    assert(!this->IsMarked(nw_child) && !this->IsMarked(ne_child) &&
-           !this->IsMarked(se_child));
-    dyad_mode = DyadicMode::Even;
-    child_signal = &this->GetNodeData(sw_child).signal;
-    reconstruction_filter = &this->wavelet_->highpassReconstructionFilter_;
-  } else if (this->IsMarked(ne_child)) {
-    assert(!this->IsMarked(sw_child) && !this->IsMarked(nw_child) &&
-           !this->IsMarked(se_child));
-    dyad_mode = DyadicMode::Odd;
-    child_signal = &this->GetNodeData(ne_child).signal;
-    reconstruction_filter = &this->wavelet_->lowpassReconstructionFilter_;
-  } else if (this->IsMarked(se_child)) {
-    assert(!this->IsMarked(sw_child) && !this->IsMarked(ne_child) &&
-           !this->IsMarked(nw_child));
-    dyad_mode = DyadicMode::Odd;
-    child_signal = &this->GetNodeData(se_child).signal;
-    reconstruction_filter = &this->wavelet_->highpassReconstructionFilter_;
+    const NodeTimer timer(&this->profile_, child, true);
+    this->ReconstructSignal(
+        coeffs, this->GetChildCoefficientType(child_index),
+        child_index == first_child ? signal : term,
+        this->GetChildDyadicMode(child_index), this->padding_mode_);
   }
 
-  if (child_signal != nullptr) {
-    this->SetMark(node);
+  std::transform(signal.begin(), signal.end(), term.begin(), signal.begin(),
+                 std::plus<>());
+}
+
+template <class Sample, class Accumulator>
+void BasicStationaryWaveletPacketTree<Sample, Accumulator>::ReconstructLevel(
+    size_t level, Span<Sample> signal) {
+  const size_t level_count = this->GetWaveletLevelCount();
+
+  this->ReconstructLevelNode(0, 0, level, signal);
 
-    auto& data = this->GetNodeData(node);
-    WaveletMath::Reconstruct(*child_signal, *reconstruction_filter,
-                             &data.signal, data.signal.size(), dyad_mode,
-                             this->padding_mode_);
+  for (Sample& it : signal) {
+    it /= static_cast<Sample>(level_count);
   }
 }
 
-void StationaryWaveletPacketTree::ReconstructAccumulate(
-    size_t leaf_node, std::vector<double>* accumulated_signal) {
-  assert(this->IsLeaf(leaf_node));
-  assert(accumulated_signal);
+template <class Sample, class Accumulator>
+void BasicStationaryWaveletPacketTree<Sample, Accumulator>::Reconstruct(
+    size_t level) {
+  const TreeProfile::Scope scope(&this->profile_);
 
-  this->Unmark();
-  this->SetMark(leaf_node);
+  // The root signal is only ever written, the level is reconstructed from
+  // the leaves.
+  this->Reconstruct(level, this->GetReconstructedRoot());
+  this->ReleaseRootSignalView();
+}
 
-  this->ReconstructNode(0);
+template <class Sample, class Accumulator>
+void BasicStationaryWaveletPacketTree<Sample, Accumulator>::Reconstruct(
+    size_t level, Span<Sample> signal) {
+  const Span<const Sample> root = this->GetNodeData(0).signal;
 
-  assert(this->GetRootSignal().size() == accumulated_signal->size());
+  assert(level < this->GetWaveletLevelCount());
+  assert(signal.size() == root.size());
 
-  std::transform(accumulated_signal->cbegin(), accumulated_signal->cend(),
-                 this->GetRootSignal().cbegin(), accumulated_signal->begin(),
-                 std::plus<>());
-}
+  const TreeProfile::Scope scope(&this->profile_);
 
-void StationaryWaveletPacketTree::Reconstruct(size_t level) {
   // If height is 1, we only have the root node so there's nothing to
   // reconstruct.
   if (this->GetHeight() == 1) {
+    if (signal.data() != root.data()) {
+      std::copy(root.begin(), root.end(), signal.begin());
+    }
     return;
   }
 
-  const size_t leaf_count = this->GetLeafCount();
-  const size_t level_count = this->GetWaveletLevelCount();
-  const size_t first_leaf_index = this->GetFirstLeaf();
-
-  assert(level < level_count);
-
-  std::vector<double> reconstructed_signal;
-  reconstructed_signal.resize(this->GetRootSignal().size());
-
-  // First calculate the starting leaf index for the level.
-  size_t starting_leaf = 0;
-  size_t current_leaf_count = 4;
-  size_t current_level_count = 2;
-  while (current_leaf_count <= leaf_count) {
-    const size_t remainder = level % current_level_count;
-
-    if (remainder >= current_level_count / 2) {
-      starting_leaf += current_leaf_count / 2;
-    }
+  this->PrepareLevelBuffers();
+  this->ReconstructLevel(level, signal);
+}
 
-    current_leaf_count *= 4;
-    current_level_count *= 2;
-  }
+template <class Sample, class Accumulator>
+void BasicStationaryWaveletPacketTree<Sample, Accumulator>::ReconstructAll(
+    Span<Sample> levels) {
+  const size_t level_count = this->GetWaveletLevelCount();
+  const Span<const Sample> root = this->GetNodeData(0).signal;
+  const size_t signal_size = root.size();
 
-  // Now use the starting leaf index to calculate the remaining leaves in the
-  // row.
-  for (size_t i = 0; i < level_count / 2; i++) {
-    size_t current_leaf = starting_leaf;
-    size_t current_multiplier = 4;
-    size_t level_index = i;
-
-    while (level_index != 0) {
-      // Least significant bit is set.
-      if ((level_index & 0x1U) != 0U) {
-        current_leaf += current_multiplier;
-      }
-
-      // Shift to next most significant bit.
-      level_index = level_index >> 1U;
-      // Increase multiplier to next power of 4;
-      current_multiplier *= 4;
-    }
+  assert(levels.size() == level_count * signal_size);
 
-    // We only calculated half of the leaf indices (the even half)
-    // but the odd halves immediately follow each even half so we
-    // need to reconstruct current_leaf and current_leaf + 1.
-    this->ReconstructAccumulate(first_leaf_index + current_leaf,
-                                &reconstructed_signal);
-    this->ReconstructAccumulate(first_leaf_index + current_leaf + 1,
-                                &reconstructed_signal);
+  const TreeProfile::Scope scope(&this->profile_);
+  if (this->GetHeight() == 1) {
+    std::copy(root.begin(), root.end(), levels.begin());
+    return;
   }
 
-  for (double& it : reconstructed_signal) {
-    it /= static_cast<double>(level_count);
+  this->PrepareLevelBuffers();
+  for (size_t level = 0; level < level_count; level++) {
+    this->ReconstructLevel(level,
+                           levels.subspan(level * signal_size, signal_size));
   }
-
-  this->SetRootSignal(reconstructed_signal);
 }
 
+template class BasicStationaryWaveletPacketTree<double>;
+template class BasicStationaryWaveletPacketTree<float>;
+template class BasicStationaryWaveletPacketTree<float, double>;
+
 }  // namespace panwave
@@ -9,6 +9,9 @@
 
 #include <vector>
 
+#include "AlignedAllocator.h"
+#include "Span.h"
+#include "StaticWavelet.h"
 #include "Tree.h"
 #include "Wavelet.h"
 #include "WaveletMath.h"
@@ -24,10 +27,15 @@ namespace panwave {
  * This is implemented as a quad tree where the signal of each node is
  * decomposed into four children signals. The four signals produced are
  * the details and approximate coefficients downsampled dyadically in
- * both even and odd dyadic modes.
+ * both even and odd dyadic modes.<br/>
+ * Template argument |Sample| is the type of the signal values and
+ * |Accumulator| the type the filters are applied in.
  * @see WaveletPacketTree
+ * @see WaveletPacketTreeTemplateBase
  */
-class StationaryWaveletPacketTree : public WaveletPacketTreeTemplateBase<4> {
+template <class Sample, class Accumulator = Sample>
+class BasicStationaryWaveletPacketTree
+    : public WaveletPacketTreeTemplateBase<4, Sample, Accumulator> {
  public:
   /**
    * Construct a StationaryWaveletPacketTree instance.<br/>
@@ -38,35 +46,87 @@ class StationaryWaveletPacketTree : public WaveletPacketTreeTemplateBase<4> {
    *                reconstruction.
    * @param padding_mode How we should pad the signal data during
    *                     decomposition / reconstruction. (default: Zeroes)
+   * @param engine How the wavelet filters are applied. A wavelet which
+   *               cannot be factored into lifting steps, such as coif4, is
+   *               applied by convolution instead. (default: Convolution)
    * @see Wavelet
+   * @see GetTransformEngine
    * @see Decompose
    * @see Reconstruct
    */
-  StationaryWaveletPacketTree(size_t height, const Wavelet* wavelet,
-                              PaddingMode padding_mode = PaddingMode::Zeroes);
-  ~StationaryWaveletPacketTree() override = default;
+  BasicStationaryWaveletPacketTree(
+      size_t height, const Wavelet* wavelet,
+      PaddingMode padding_mode = PaddingMode::Zeroes,
+      TransformEngine engine = TransformEngine::Convolution);
+
+  /**
+   * Construct a StationaryWaveletPacketTree instance using a compile-time
+   * wavelet.<br/>
+   * The tree uses the Wavelet object shared by all users of StaticWavelet
+   * type |wavelet|, which lives until the program exits.
+   * @see StaticWavelet
+   */
+  template <Wavelet::WaveletType Type, size_t VanishingMoment>
+  BasicStationaryWaveletPacketTree(
+      size_t height, StaticWavelet<Type, VanishingMoment> /*wavelet*/,
+      PaddingMode padding_mode = PaddingMode::Zeroes,
+      TransformEngine engine = TransformEngine::Convolution)
+      : BasicStationaryWaveletPacketTree(
+            height, &StaticWavelet<Type, VanishingMoment>::GetWavelet(),
+            padding_mode, engine) {}
+  ~BasicStationaryWaveletPacketTree() override = default;
 
-  void Decompose() override;
   void Reconstruct(size_t level) override;
+  void Reconstruct(size_t level, Span<Sample> signal) override;
+  void ReconstructAll(Span<Sample> levels) override;
 
  protected:
-  void DecomposeNode(size_t node);
-  void ReconstructNode(size_t node);
+  DyadicMode GetChildDyadicMode(size_t child_index) const override;
+  CoefficientType GetChildCoefficientType(
+      size_t child_index) const override;
+  PaddingMode GetPaddingMode() const override { return this->padding_mode_; }
+  void DecomposeNodeSignal(size_t node) override;
+
+  /**
+   * Size the buffers ReconstructLevelNode uses for the current root signal.
+   */
+  void PrepareLevelBuffers();
 
   /**
-   * Isolates one leaf and reconstructs the root signal. The root signal is
-   * accumulated into accumulated_signal.
-   * @param leaf_node The leaf node we want to isolate.
-   * @param accumulated_signal Vector in which we will add the root signal after
-   *                           isolating the leaf and reconstructing the signal.
+   * Reconstruct the sum of the contributions of every leaf below node which
+   * belongs to wavelet level |level|.<br/>
+   * Reconstruction is linear, so the contributions of the two children on
+   * the level are reconstructed from their own sums and added. Each node on
+   * the level is reconstructed once.
+   * @param node A non-leaf node.
+   * @param depth The depth of node. The root has depth 0.
+   * @param level The wavelet level to reconstruct.
+   * @param signal Destination with the size of node's signal. Must not
+   *               overlap the buffers of any depth below node.
    */
-  void ReconstructAccumulate(size_t leaf_node,
-                             std::vector<double>* accumulated_signal);
+  void ReconstructLevelNode(size_t node, size_t depth, size_t level,
+                            Span<Sample> signal);
+
+  /**
+   * Reconstruct wavelet level |level| into signal, which has the size of the
+   * root signal. PrepareLevelBuffers must have been called.
+   */
+  void ReconstructLevel(size_t level, Span<Sample> signal);
 
  private:
   PaddingMode padding_mode_;
+  // Per depth, the sum of the reconstructed children of the node being
+  // reconstructed and the reconstruction of its second child. Kept between
+  // calls so reconstruction does not allocate.
+  std::vector<AlignedVector<Sample>> level_sums_;
+  std::vector<AlignedVector<Sample>> level_terms_;
 };
 
+/**
+ * A stationary wavelet packet tree of double signals.
+ */
+using StationaryWaveletPacketTree = BasicStationaryWaveletPacketTree<double>;
+
 };  // namespace panwave
 
 #endif  // STATIONARYWAVELETPACKETTREE_H
@@ -0,0 +1,187 @@
+//-------------------------------------------------------------------------------------------------------
+// Copyright (C) Taylor Woll and panwave contributors. All rights reserved.
+// Licensed under the MIT license. See LICENSE.txt file in the project root for
+// full license information.
+//-------------------------------------------------------------------------------------------------------
+
+#include "StreamingWaveletPacketTree.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+
+#include "Wavelet.h"
+#include "WaveletMath.h"
+
+namespace {
+
+constexpr size_t ChildIndexLeft = 0;
+constexpr size_t ChildIndexRight = 1;
+
+}  // namespace
+
+namespace panwave {
+
+template <class Sample, class Accumulator>
+BasicStreamingWaveletPacketTree<Sample, Accumulator>::
+    BasicStreamingWaveletPacketTree(size_t height, const Wavelet* wavelet,
+                                    DyadicMode dyadic_mode,
+                                    PaddingMode padding_mode)
+    : Tree<StreamingWaveletPacketTreeNode<Sample>, 2>(height),
+      dyadic_mode_(dyadic_mode),
+      // Periodic padding wraps the end of the stream around to its start.
+      padding_mode_(padding_mode == PaddingMode::Periodic
+                        ? PaddingMode::Zeroes
+                        : padding_mode),
+      lowpass_filter_(wavelet->lowpassDecompositionFilter_.cbegin(),
+                      wavelet->lowpassDecompositionFilter_.cend()),
+      highpass_filter_(wavelet->highpassDecompositionFilter_.cbegin(),
+                       wavelet->highpassDecompositionFilter_.cend()) {}
+
+template <class Sample, class Accumulator>
+void BasicStreamingWaveletPacketTree<Sample, Accumulator>::Push(
+    Span<const Sample> samples) {
+  assert(!this->finished_);
+
+  this->ClearLeaves();
+
+  auto& root = this->GetNodeData(0);
+  root.signal.insert(root.signal.end(), samples.begin(), samples.end());
+
+  if (!this->IsLeaf(0)) {
+    this->DecomposeNode(0);
+  }
+}
+
+template <class Sample, class Accumulator>
+void BasicStreamingWaveletPacketTree<Sample, Accumulator>::Finish() {
+  assert(!this->finished_);
+  assert(this->GetNodeData(0).signal_begin +
+             this->GetNodeData(0).signal.size() !=
+         0);
+
+  this->finished_ = true;
+  this->ClearLeaves();
+
+  if (!this->IsLeaf(0)) {
+    this->DecomposeNode(0);
+  }
+}
+
+template <class Sample, class Accumulator>
+void BasicStreamingWaveletPacketTree<Sample, Accumulator>::Reset() {
+  for (size_t node = 0; node <= this->GetLastLeaf(); node++) {
+    auto& data = this->GetNodeData(node);
+    data.signal.clear();
+    data.signal_begin = 0;
+    data.output_count = 0;
+  }
+  this->finished_ = false;
+}
+
+template <class Sample, class Accumulator>
+Span<const Sample>
+BasicStreamingWaveletPacketTree<Sample, Accumulator>::GetLeafCoefficients(
+    size_t level) {
+  assert(level < this->GetWaveletLevelCount());
+
+  return this->GetNodeData(this->GetFirstLeaf() + level).signal;
+}
+
+template <class Sample, class Accumulator>
+size_t BasicStreamingWaveletPacketTree<Sample,
+                                       Accumulator>::GetLeafCoefficientIndex() {
+  return this->GetNodeData(this->GetFirstLeaf()).signal_begin;
+}
+
+template <class Sample, class Accumulator>
+size_t BasicStreamingWaveletPacketTree<Sample, Accumulator>::
+    GetReadyOutputCount(size_t signal_size) const {
+  const size_t filter_size = this->lowpass_filter_.size();
+
+  if (this->finished_) {
+    return WaveletMath::GetDecomposedSize(signal_size, filter_size,
+                                          this->dyadic_mode_);
+  }
+
+  // Symmetric padding mirrors the first filter_size - 1 elements into the
+  // windows of the first outputs.
+  if (this->padding_mode_ == PaddingMode::Symmetric &&
+      signal_size < filter_size) {
+    return 0;
+  }
+
+  // Output m is ready once element 2 * m + first, the last one its window
+  // covers, has arrived.
+  const size_t first = this->dyadic_mode_ == DyadicMode::Even ? 0U : 1U;
+  return (signal_size + 1 - first) / 2;
+}
+
+template <class Sample, class Accumulator>
+void BasicStreamingWaveletPacketTree<Sample, Accumulator>::DecomposeNode(
+    size_t node) {
+  auto& data = this->GetNodeData(node);
+  auto& left = this->GetNodeData(this->GetChild(node, ChildIndexLeft));
+  auto& right = this->GetNodeData(this->GetChild(node, ChildIndexRight));
+  const size_t filter_size = this->lowpass_filter_.size();
+  const size_t signal_size = data.signal_begin + data.signal.size();
+  const size_t ready = this->GetReadyOutputCount(signal_size);
+
+  if (ready > data.output_count) {
+    const size_t count = ready - data.output_count;
+    const size_t left_size = left.signal.size();
+    const size_t right_size = right.signal.size();
+    left.signal.resize(left_size + count);
+    right.signal.resize(right_size + count);
+
+    WaveletMath::DecomposeRange<Sample, Accumulator>(
+        data.signal, data.signal_begin, signal_size, this->lowpass_filter_,
+        this->highpass_filter_,
+        Span<Sample>(left.signal).subspan(left_size, count),
+        Span<Sample>(right.signal).subspan(right_size, count),
+        data.output_count, this->dyadic_mode_, this->padding_mode_);
+    data.output_count = ready;
+  }
+
+  // Keep the elements the window of the next output begins with. Symmetric
+  // padding after the end of the signal mirrors up to filter_size elements
+  // before the end, keep those as well.
+  const size_t first = this->dyadic_mode_ == DyadicMode::Even ? 0U : 1U;
+  const auto next_window =
+      static_cast<ptrdiff_t>(2 * data.output_count + first) -
+      static_cast<ptrdiff_t>(filter_size - 1);
+  const auto keep_begin = static_cast<size_t>(std::max(
+      std::min(next_window, static_cast<ptrdiff_t>(signal_size) -
+                                static_cast<ptrdiff_t>(filter_size)),
+      ptrdiff_t{0}));
+  if (keep_begin > data.signal_begin) {
+    data.signal.erase(
+        data.signal.begin(),
+        data.signal.begin() +
+            static_cast<ptrdiff_t>(keep_begin - data.signal_begin));
+    data.signal_begin = keep_begin;
+  }
+
+  for (size_t i = 0; i < 2; i++) {
+    const size_t child = this->GetChild(node, i);
+    if (!this->IsLeaf(child)) {
+      this->DecomposeNode(child);
+    }
+  }
+}
+
+template <class Sample, class Accumulator>
+void BasicStreamingWaveletPacketTree<Sample, Accumulator>::ClearLeaves() {
+  for (size_t leaf = this->GetFirstLeaf(); leaf <= this->GetLastLeaf();
+       leaf++) {
+    auto& data = this->GetNodeData(leaf);
+    data.signal_begin += data.signal.size();
+    data.signal.clear();
+  }
+}
+
+template class BasicStreamingWaveletPacketTree<double>;
+template class BasicStreamingWaveletPacketTree<float>;
+template class BasicStreamingWaveletPacketTree<float, double>;
+
+}  // namespace panwave
@@ -0,0 +1,176 @@
+//-------------------------------------------------------------------------------------------------------
+// Copyright (C) Taylor Woll and panwave contributors. All rights reserved.
+// Licensed under the MIT license. See LICENSE.txt file in the project root for
+// full license information.
+//-------------------------------------------------------------------------------------------------------
+
+#ifndef STREAMINGWAVELETPACKETTREE_H
+#define STREAMINGWAVELETPACKETTREE_H
+
+#include <vector>
+
+#include "Span.h"
+#include "StaticWavelet.h"
+#include "Tree.h"
+#include "Wavelet.h"
+#include "WaveletMath.h"
+
+namespace panwave {
+
+/**
+ * The state kept for one node of a streaming wavelet packet tree.
+ * @see BasicStreamingWaveletPacketTree
+ */
+template <class Sample>
+struct StreamingWaveletPacketTreeNode {
+  /**
+   * The part of the node's signal which is still needed. Leaves hold the
+   * coefficients emitted by the last call to Push or Finish.
+   */
+  std::vector<Sample> signal;
+
+  /**
+   * Index of the first element of signal in the whole signal of the node.
+   */
+  size_t signal_begin = 0;
+
+  /**
+   * The number of outputs decomposed into the children so far.
+   */
+  size_t output_count = 0;
+};
+
+/**
+ * A wavelet packet tree which decomposes a signal arriving in chunks.<br/>
+ * The tree has the shape of a WaveletPacketTree and its leaves receive the
+ * same coefficients a WaveletPacketTree using the convolution engine
+ * produces from the whole signal. Each node keeps the end of its signal
+ * which the filters still need between chunks, so every coefficient is
+ * computed once no matter how the signal is split.<br/>
+ * Latency: let f be 0 in DyadicMode::Even and 1 in DyadicMode::Odd and let
+ * D be height - 1. Leaf coefficient m is computed from the signal up to
+ * element 2^D * m + (2^D - 1) * f, and is emitted by the call to Push which
+ * makes that element available. With symmetric padding a node additionally
+ * holds its outputs back until it has received as many elements as the
+ * filter is long, since the left padding mirrors them. The coefficients
+ * reading the padding after the end of the signal are emitted by Finish.
+ * @see WaveletPacketTree
+ * @see WaveletMath::DecomposeRange
+ */
+template <class Sample, class Accumulator = Sample>
+class BasicStreamingWaveletPacketTree
+    : public Tree<StreamingWaveletPacketTreeNode<Sample>, 2> {
+ public:
+  /**
+   * Construct a BasicStreamingWaveletPacketTree instance ready for a
+   * stream.
+   * @param height Height of the tree. A tree with only one root node
+   *               has height of 1.
+   * @param wavelet Wavelet object used during decomposition.
+   * @param dyadic_mode Which mode we should use when dyadically
+   *                    downsampling. (default: Odd)
+   * @param padding_mode How we should pad the start and end of the stream.
+   *                     Periodic padding needs the end of the stream
+   *                     before its first coefficients, so the stream is
+   *                     padded with zeroes instead. (default: Zeroes)
+   * @see GetPaddingMode
+   * @see Push
+   */
+  BasicStreamingWaveletPacketTree(
+      size_t height, const Wavelet* wavelet,
+      DyadicMode dyadic_mode = DyadicMode::Odd,
+      PaddingMode padding_mode = PaddingMode::Zeroes);
+
+  /**
+   * Construct a BasicStreamingWaveletPacketTree instance using a
+   * compile-time wavelet.
+   * @see StaticWavelet
+   */
+  template <Wavelet::WaveletType Type, size_t VanishingMoment>
+  BasicStreamingWaveletPacketTree(
+      size_t height, StaticWavelet<Type, VanishingMoment> /*wavelet*/,
+      DyadicMode dyadic_mode = DyadicMode::Odd,
+      PaddingMode padding_mode = PaddingMode::Zeroes)
+      : BasicStreamingWaveletPacketTree(
+            height, &StaticWavelet<Type, VanishingMoment>::GetWavelet(),
+            dyadic_mode, padding_mode) {}
+
+  /**
+   * Append samples to the stream and decompose as far as they allow.<br/>
+   * The coefficients emitted replace the ones of the previous call.
+   * @see GetLeafCoefficients
+   */
+  void Push(Span<const Sample> samples);
+
+  /**
+   * End the stream and emit the remaining coefficients.<br/>
+   * At least one sample must have been pushed. Call Reset before pushing
+   * the samples of another stream.
+   */
+  void Finish();
+
+  /**
+   * Forget the current stream so a new one can be pushed.
+   */
+  void Reset();
+
+  /**
+   * Get the coefficients leaf |level| emitted during the last call to Push
+   * or Finish.<br/>
+   * Leaf i holds the coefficients WaveletPacketTree::Reconstruct(i) would
+   * reconstruct. All leaves emit the same number of coefficients.
+   * @see GetLeafCoefficientIndex
+   */
+  Span<const Sample> GetLeafCoefficients(size_t level);
+
+  /**
+   * Get the index, among all coefficients of a leaf for the whole stream, of
+   * the first coefficient returned by GetLeafCoefficients.
+   */
+  size_t GetLeafCoefficientIndex();
+
+  /**
+   * Get the number of leaves, which is the number of wavelet levels of a
+   * WaveletPacketTree of the same height.
+   */
+  size_t GetWaveletLevelCount() const { return this->GetLeafCount(); }
+
+  /**
+   * Get how the start and end of the stream are padded, which is never
+   * PaddingMode::Periodic.
+   */
+  PaddingMode GetPaddingMode() const { return this->padding_mode_; }
+
+ private:
+  /**
+   * Get the number of outputs of a node which can be computed once its
+   * signal holds signal_size elements.
+   */
+  size_t GetReadyOutputCount(size_t signal_size) const;
+
+  /**
+   * Decompose as much of node's signal as is ready into its children, then
+   * continue with the children.
+   */
+  void DecomposeNode(size_t node);
+
+  /**
+   * Drop the coefficients the leaves emitted in the previous call.
+   */
+  void ClearLeaves();
+
+  DyadicMode dyadic_mode_;
+  PaddingMode padding_mode_;
+  std::vector<Accumulator> lowpass_filter_;
+  std::vector<Accumulator> highpass_filter_;
+  bool finished_ = false;
+};
+
+/**
+ * A streaming wavelet packet tree of double signals.
+ */
+using StreamingWaveletPacketTree = BasicStreamingWaveletPacketTree<double>;
+
+}  // namespace panwave
+
+#endif  // STREAMINGWAVELETPACKETTREE_H
@@ -0,0 +1,148 @@
+//-------------------------------------------------------------------------------------------------------
+// Copyright (C) Taylor Woll and panwave contributors. All rights reserved.
+// Licensed under the MIT license. See LICENSE.txt file in the project root for
+// full license information.
+//-------------------------------------------------------------------------------------------------------
+
+#include "TaskScheduler.h"
+
+#include <cassert>
+
+namespace {
+
+// The scheduler the calling thread is a worker of, and its index there.
+thread_local const panwave::TaskScheduler* currentScheduler = nullptr;
+thread_local size_t currentWorker = 0;
+
+}  // namespace
+
+namespace panwave {
+
+TaskScheduler::TaskScheduler(size_t thread_count) {
+  this->queues_.resize(thread_count + 1);
+  for (auto& queue : this->queues_) {
+    queue = std::make_unique<WorkerQueue>();
+  }
+
+  this->threads_.reserve(thread_count);
+  for (size_t worker = 1; worker <= thread_count; worker++) {
+    this->threads_.emplace_back(&TaskScheduler::WorkerMain, this, worker);
+  }
+}
+
+TaskScheduler::~TaskScheduler() {
+  assert(this->queued_count_ == 0);
+
+  {
+    std::lock_guard<std::mutex> lock(this->sleep_mutex_);
+    this->stopping_ = true;
+  }
+  this->wake_.notify_all();
+
+  for (auto& thread : this->threads_) {
+    thread.join();
+  }
+}
+
+size_t TaskScheduler::GetCurrentWorker() const {
+  return currentScheduler == this ? currentWorker : 0;
+}
+
+void TaskScheduler::Spawn(TaskGroup* group, Task task) {
+  assert(group);
+
+  group->pending_.fetch_add(1, std::memory_order_relaxed);
+
+  WorkerQueue& queue = *this->queues_[this->GetCurrentWorker()];
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.tasks.push_back({task, group});
+  }
+  this->queued_count_.fetch_add(1, std::memory_order_release);
+
+  // Taking the mutex orders the new task before any worker which is about
+  // to sleep checks for queued tasks.
+  { std::lock_guard<std::mutex> lock(this->sleep_mutex_); }
+  this->wake_.notify_one();
+}
+
+void TaskScheduler::Wait(TaskGroup* group) {
+  assert(group);
+
+  const size_t worker = this->GetCurrentWorker();
+  while (group->pending_.load(std::memory_order_acquire) != 0) {
+    if (this->RunOneTask(worker)) {
+      continue;
+    }
+
+    // The remaining tasks of the group are running on other threads. Sleep
+    // until one of them completes the group or a new task is queued.
+    std::unique_lock<std::mutex> lock(this->sleep_mutex_);
+    this->wake_.wait(lock, [this, group] {
+      return group->pending_.load(std::memory_order_acquire) == 0 ||
+             this->queued_count_.load(std::memory_order_acquire) != 0;
+    });
+  }
+}
+
+bool TaskScheduler::RunOneTask(size_t worker) {
+  const size_t queue_count = this->queues_.size();
+  QueuedTask queued = {};
+  bool found = false;
+
+  // Our own newest task first, then the oldest task of the other queues.
+  for (size_t i = 0; i < queue_count && !found; i++) {
+    WorkerQueue& queue = *this->queues_[(worker + i) % queue_count];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+
+    if (queue.tasks.empty()) {
+      continue;
+    }
+
+    if (i == 0) {
+      queued = queue.tasks.back();
+      queue.tasks.pop_back();
+    } else {
+      queued = queue.tasks.front();
+      queue.tasks.pop_front();
+    }
+    found = true;
+  }
+
+  if (!found) {
+    return false;
+  }
+
+  this->queued_count_.fetch_sub(1, std::memory_order_relaxed);
+  queued.task.run(queued.task.context, queued.task.argument);
+  if (queued.group->pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    // Taking the mutex orders the completion before any thread which is
+    // about to sleep in Wait checks the group.
+    { std::lock_guard<std::mutex> lock(this->sleep_mutex_); }
+    this->wake_.notify_all();
+  }
+  return true;
+}
+
+void TaskScheduler::WorkerMain(size_t worker) {
+  currentScheduler = this;
+  currentWorker = worker;
+
+  while (true) {
+    if (this->RunOneTask(worker)) {
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(this->sleep_mutex_);
+    this->wake_.wait(lock, [this] {
+      return this->stopping_ ||
+             this->queued_count_.load(std::memory_order_acquire) != 0;
+    });
+    if (this->stopping_ &&
+        this->queued_count_.load(std::memory_order_acquire) == 0) {
+      return;
+    }
+  }
+}
+
+}  // namespace panwave
@@ -0,0 +1,138 @@
+//-------------------------------------------------------------------------------------------------------
+// Copyright (C) Taylor Woll and panwave contributors. All rights reserved.
+// Licensed under the MIT license. See LICENSE.txt file in the project root for
+// full license information.
+//-------------------------------------------------------------------------------------------------------
+
+#ifndef TASKSCHEDULER_H
+#define TASKSCHEDULER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace panwave {
+
+/**
+ * A small work-stealing thread pool.<br/>
+ * Every worker thread owns a queue of tasks. A worker runs the tasks it
+ * spawned itself newest first and, once its queue is empty, steals the
+ * oldest tasks from the other queues. Threads which are not workers of the
+ * scheduler share one additional queue and are known as worker 0. Any
+ * number of them may use the scheduler at once, so per-worker state of
+ * worker 0 must be kept per thread.<br/>
+ * Waiting for a group of tasks runs queued tasks on the waiting thread
+ * until the group is complete, so tasks may spawn and wait for tasks of
+ * their own. Once nothing is left to run, the waiting thread sleeps until
+ * the group completes.
+ * @see WaveletPacketTreeBase::SetTaskScheduler
+ */
+class TaskScheduler {
+ public:
+  /**
+   * A unit of work. Runs run(context, argument).
+   */
+  struct Task {
+    void (*run)(void* context, size_t argument);
+    void* context;
+    size_t argument;
+  };
+
+  /**
+   * A set of spawned tasks which can be waited on together.
+   */
+  class TaskGroup {
+   public:
+    TaskGroup() = default;
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup(TaskGroup&&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+    TaskGroup& operator=(TaskGroup&&) = delete;
+    ~TaskGroup() = default;
+
+   private:
+    friend class TaskScheduler;
+
+    std::atomic<size_t> pending_{0};
+  };
+
+  /**
+   * Start a scheduler.
+   * @param thread_count The number of worker threads to start. The threads
+   *                     which wait on task groups also run tasks, so a
+   *                     machine with n cores is fully used by n - 1 worker
+   *                     threads.
+   */
+  explicit TaskScheduler(size_t thread_count);
+
+  TaskScheduler(const TaskScheduler&) = delete;
+  TaskScheduler(TaskScheduler&&) = delete;
+  TaskScheduler& operator=(const TaskScheduler&) = delete;
+  TaskScheduler& operator=(TaskScheduler&&) = delete;
+
+  /**
+   * Stops and joins the worker threads. All task groups must have been
+   * waited on.
+   */
+  ~TaskScheduler();
+
+  /**
+   * Get the number of distinct worker indices, which is the number of
+   * worker threads plus one for the threads outside of the scheduler.
+   */
+  size_t GetWorkerCount() const { return this->queues_.size(); }
+
+  /**
+   * Get the index of the calling thread.<br/>
+   * Worker threads have indices 1 to GetWorkerCount() - 1. Any other thread
+   * has index 0, which several threads may share at the same time.
+   */
+  size_t GetCurrentWorker() const;
+
+  /**
+   * Queue task to run on any worker as part of group.
+   */
+  void Spawn(TaskGroup* group, Task task);
+
+  /**
+   * Return once every task spawned into group has finished. The calling
+   * thread runs queued tasks in the meantime and sleeps while there are
+   * none.
+   */
+  void Wait(TaskGroup* group);
+
+ private:
+  struct QueuedTask {
+    Task task;
+    TaskGroup* group;
+  };
+
+  struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<QueuedTask> tasks;
+  };
+
+  /**
+   * Run one task from the queue of worker, or stolen from another queue.
+   * @return False if every queue was empty.
+   */
+  bool RunOneTask(size_t worker);
+
+  void WorkerMain(size_t worker);
+
+  std::vector<std::unique_ptr<WorkerQueue>> queues_;
+  std::vector<std::thread> threads_;
+  std::atomic<size_t> queued_count_{0};
+  std::mutex sleep_mutex_;
+  std::condition_variable wake_;
+  bool stopping_ = false;
+};
+
+}  // namespace panwave
+
+#endif  // TASKSCHEDULER_H
@@ -0,0 +1,114 @@
+//-------------------------------------------------------------------------------------------------------
+// Copyright (C) Taylor Woll and panwave contributors. All rights reserved.
+// Licensed under the MIT license. See LICENSE.txt file in the project root for
+// full license information.
+//-------------------------------------------------------------------------------------------------------
+
+#include "Threshold.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace {
+
+// The median absolute value of a standard normal variable.
+constexpr double NormalMedianAbsoluteValue = 0.6745;
+
+}  // namespace
+
+namespace panwave {
+
+template <class Sample>
+double BasicThreshold<Sample>::Select(Span<const Sample> coefficients,
+                                      Span<Sample> scratch) const {
+  assert(scratch.size() >= coefficients.size());
+
+  const size_t size = coefficients.size();
+  if (this->selection == ThresholdSelection::Fixed) {
+    return this->threshold;
+  }
+  if (size == 0) {
+    return 0.0;
+  }
+
+  const double noise_level = this->noise_level > 0.0
+                                 ? this->noise_level
+                                 : EstimateNoiseLevel(coefficients, scratch);
+  // Nothing is removed from a node without noise.
+  if (!(noise_level > 0.0)) {
+    return 0.0;
+  }
+
+  const auto count = static_cast<double>(size);
+  const double universal = noise_level * std::sqrt(2.0 * std::log(count));
+  if (this->selection == ThresholdSelection::Universal) {
+    return universal;
+  }
+
+  // With the noise scaled to unit variance, the estimated risk of soft
+  // thresholding at t is count - 2 * #{|x| <= t} + sum(min(x^2, t^2)).
+  // Between two consecutive magnitudes it only grows with t, so it is
+  // smallest at zero or at one of the magnitudes.
+  const Span<Sample> magnitudes = scratch.subspan(0, size);
+  std::transform(coefficients.begin(), coefficients.end(), magnitudes.begin(),
+                 [](Sample value) { return std::abs(value); });
+  std::sort(magnitudes.begin(), magnitudes.end());
+
+  double energy = 0.0;
+  for (const Sample magnitude : magnitudes) {
+    const double scaled = magnitude / noise_level;
+    energy += scaled * scaled;
+  }
+
+  // The estimate is too noisy to rely on when the node holds little more
+  // energy than its noise does.
+  const double sparsity = (energy - count) / count;
+  const double critical = std::pow(std::log2(count), 1.5) / std::sqrt(count);
+  if (sparsity <= critical) {
+    return universal;
+  }
+
+  double best_risk = count;
+  double best_threshold = 0.0;
+  double below_energy = 0.0;
+  for (size_t i = 0; i < size; i++) {
+    const double scaled = magnitudes[i] / noise_level;
+    below_energy += scaled * scaled;
+    const auto above = static_cast<double>(size - i - 1);
+    const double risk = count - 2.0 * static_cast<double>(i + 1) +
+                        below_energy + above * scaled * scaled;
+    if (risk < best_risk) {
+      best_risk = risk;
+      best_threshold = magnitudes[i];
+    }
+  }
+
+  return std::min(best_threshold, universal);
+}
+
+template <class Sample>
+double BasicThreshold<Sample>::EstimateNoiseLevel(
+    Span<const Sample> coefficients, Span<Sample> scratch) {
+  assert(!coefficients.empty());
+  assert(scratch.size() >= coefficients.size());
+
+  // Only the middle of the magnitudes has to be ordered.
+  const size_t size = coefficients.size();
+  Sample* const begin = scratch.begin();
+  Sample* const middle = begin + size / 2;
+  std::transform(coefficients.begin(), coefficients.end(), begin,
+                 [](Sample value) { return std::abs(value); });
+  std::nth_element(begin, middle, begin + size);
+
+  double median = *middle;
+  if (size % 2 == 0) {
+    median = (median + *std::max_element(begin, middle)) / 2.0;
+  }
+  return median / NormalMedianAbsoluteValue;
+}
+
+template struct BasicThreshold<double>;
+template struct BasicThreshold<float>;
+
+}  // namespace panwave
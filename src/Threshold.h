@@ -0,0 +1,93 @@
+//-------------------------------------------------------------------------------------------------------
+// Copyright (C) Taylor Woll and panwave contributors. All rights reserved.
+// Licensed under the MIT license. See LICENSE.txt file in the project root for
+// full license information.
+//-------------------------------------------------------------------------------------------------------
+
+#ifndef THRESHOLD_H
+#define THRESHOLD_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Span.h"
+#include "WaveletMath.h"
+
+namespace panwave {
+
+/**
+ * How the threshold applied to the coefficients of a node is chosen.<br/>
+ * Fixed applies the same threshold to every node. Universal uses
+ * sigma * sqrt(2 * log(n)) for a node of n coefficients with noise level
+ * sigma, the VisuShrink threshold. Sure uses the threshold which minimizes
+ * Stein's unbiased estimate of the risk of soft thresholding the node, the
+ * SureShrink threshold. It falls back to Universal when the node holds so
+ * little energy above the noise that the estimate is unreliable, and never
+ * exceeds it.
+ * @see BasicThreshold
+ */
+enum class ThresholdSelection : uint8_t { Fixed = 0, Universal, Sure };
+
+/**
+ * A thresholding of the coefficients of wavelet packet tree nodes, as used
+ * to remove noise from a signal.<br/>
+ * Data driven thresholds are chosen for each node from its own
+ * coefficients, scaled by the standard deviation of the noise. Unless it is
+ * given, the noise level of each node is estimated from the median
+ * magnitude of its coefficients, which is robust to the few large
+ * coefficients carrying the signal.
+ * @see BasicWaveletPacketTree::Denoise
+ */
+template <class Sample>
+struct BasicThreshold {
+  /**
+   * Choose the threshold for the coefficients of one node.
+   * @param coefficients The coefficients of the node.
+   * @param scratch Scratch memory of at least coefficients.size() elements.
+   *                Existing contents are overwritten.
+   */
+  double Select(Span<const Sample> coefficients, Span<Sample> scratch) const;
+
+  /**
+   * Estimate the standard deviation of Gaussian noise in a set of
+   * coefficients.<br/>
+   * The estimate is the median absolute value of the coefficients divided
+   * by 0.6745, the median absolute value of a standard normal variable.
+   * @param coefficients The coefficients, which must not be empty.
+   * @param scratch Scratch memory of at least coefficients.size() elements.
+   *                Existing contents are overwritten.
+   */
+  static double EstimateNoiseLevel(Span<const Sample> coefficients,
+                                   Span<Sample> scratch);
+
+  ThresholdRule rule = ThresholdRule::Soft;
+  ThresholdSelection selection = ThresholdSelection::Universal;
+
+  /**
+   * The threshold ThresholdSelection::Fixed applies to every node.
+   */
+  double threshold = 0.0;
+
+  /**
+   * The standard deviation of the noise, or zero to estimate it for each
+   * node from its coefficients.
+   * @see EstimateNoiseLevel
+   */
+  double noise_level = 0.0;
+
+  /**
+   * Whether the approximation coefficients of the deepest level, which hold
+   * the coarse shape of the signal rather than noise, are left as they are.
+   * In a WaveletPacketTree they are the leaf of wavelet level 0.
+   */
+  bool keep_approximation = true;
+};
+
+/**
+ * A thresholding of double coefficients.
+ */
+using Threshold = BasicThreshold<double>;
+
+}  // namespace panwave
+
+#endif  // THRESHOLD_H
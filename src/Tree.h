@@ -43,7 +43,6 @@ class Tree {
     size_t const total_nodes = (k * this->leaf_count_ - 1) / (k - 1);
 
     this->nodes_.resize(total_nodes);
-    this->mark_.resize(total_nodes);
   }
 
  protected:
@@ -101,39 +100,42 @@ class Tree {
   }
 
   /**
-   * Get the writable data stored at tree node |index|.
+   * Get the 0-based index of a child node relative to its parent.<br/>
+   * This is the inverse of GetChild.
+   * @param child The child node index.
+   * @see GetChild
    */
-  Element& GetNodeData(size_t index) {
-    assert(index < this->nodes_.size());
+  size_t GetChildIndex(size_t child) const {
+    assert(child < this->nodes_.size());
+    assert(child != 0);
 
-    return this->nodes_.at(index);
+    return (child - 1) % k;
   }
 
   /**
-   * Return true if node is set as marked.
-   * @param node The node index to check for mark state.
+   * Get the index of a node from its position in the tree.
+   * @param depth The depth of the node. The root has depth 0.
+   * @param position The 0-based position of the node among the k^depth
+   *                 nodes at that depth, from left to right.
    */
-  bool IsMarked(size_t node) const {
-    assert(node < this->mark_.size());
+  size_t GetNodeAt(size_t depth, size_t position) const {
+    assert(depth < this->height_);
+
+    const auto depth_size = static_cast<size_t>(std::pow(k, depth));
+    assert(position < depth_size);
 
-    return this->mark_[node];
+    return (depth_size - 1) / (k - 1) + position;
   }
 
   /**
-   * Set node as marked.
-   * @param node The node index to mark.
+   * Get the writable data stored at tree node |index|.
    */
-  void SetMark(size_t node) {
-    assert(node < this->mark_.size());
+  Element& GetNodeData(size_t index) {
+    assert(index < this->nodes_.size());
 
-    this->mark_[node] = true;
+    return this->nodes_.at(index);
   }
 
-  /**
-   * Unmark all nodes in the tree.
-   */
-  void Unmark() { this->mark_.assign(this->mark_.size(), false); }
-
   /**
    * Get the height of the tree.
    *
@@ -146,7 +148,6 @@ class Tree {
   size_t height_;
   size_t leaf_count_ = 0;
   std::vector<Element> nodes_;
-  std::vector<bool> mark_;
 };
 
 }  // namespace panwave
@@ -0,0 +1,295 @@
+//-------------------------------------------------------------------------------------------------------
+// Copyright (C) Taylor Woll and panwave contributors. All rights reserved.
+// Licensed under the MIT license. See LICENSE.txt file in the project root for
+// full license information.
+//-------------------------------------------------------------------------------------------------------
+
+#include "TreeFile.h"
+
+#include <cstring>
+#include <fstream>
+
+#include "AlignedAllocator.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr char Magic[8] = {'P', 'A', 'N', 'W', 'A', 'V', 'E', '\0'};
+constexpr uint32_t ByteOrderMark = 0x01020304;
+constexpr size_t FilterCount = 4;
+
+/**
+ * The header at the beginning of a tree file. The wavelet filters follow
+ * it, then the node table at table_offset, then the node coefficients.
+ */
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint32_t children;
+  uint32_t height;
+  uint64_t channel_count;
+  uint32_t sample_size;
+  uint8_t dyadic_mode;
+  uint8_t padding_mode;
+  uint8_t engine;
+  uint8_t reserved;
+  uint64_t filter_sizes[FilterCount];
+  uint64_t node_count;
+  uint64_t table_offset;
+  uint64_t file_size;
+};
+
+static_assert(sizeof(FileHeader) % sizeof(uint64_t) == 0,
+              "The filters following the header must stay aligned.");
+
+size_t AlignUp(size_t offset, size_t alignment) {
+  return (offset + alignment - 1) / alignment * alignment;
+}
+
+// Get the filters of a wavelet in the order the file stores them.
+const std::vector<double>* GetFilters(const panwave::Wavelet& wavelet,
+                                      size_t index) {
+  const std::vector<double>* filters[FilterCount] = {
+      &wavelet.lowpassDecompositionFilter_,
+      &wavelet.highpassDecompositionFilter_,
+      &wavelet.lowpassReconstructionFilter_,
+      &wavelet.highpassReconstructionFilter_};
+  return filters[index];
+}
+
+}  // namespace
+
+namespace panwave {
+
+bool TreeFile::Write(const std::string& path, const Description& description,
+                     const Wavelet& wavelet,
+                     const std::vector<Span<const char>>& nodes) {
+  FileHeader header = {};
+  std::memcpy(header.magic, Magic, sizeof(Magic));
+  header.version = Version;
+  header.byte_order = ByteOrderMark;
+  header.children = static_cast<uint32_t>(description.children);
+  header.height = static_cast<uint32_t>(description.height);
+  header.channel_count = description.channel_count;
+  header.sample_size = static_cast<uint32_t>(description.sample_size);
+  header.dyadic_mode = static_cast<uint8_t>(description.dyadic_mode);
+  header.padding_mode = static_cast<uint8_t>(description.padding_mode);
+  header.engine = static_cast<uint8_t>(description.engine);
+  header.node_count = nodes.size();
+
+  size_t offset = sizeof(FileHeader);
+  for (size_t i = 0; i < FilterCount; i++) {
+    header.filter_sizes[i] = GetFilters(wavelet, i)->size();
+    offset += GetFilters(wavelet, i)->size() * sizeof(double);
+  }
+
+  header.table_offset = offset;
+  std::vector<NodeEntry> table(nodes.size());
+  offset += nodes.size() * sizeof(NodeEntry);
+  for (size_t node = 0; node < nodes.size(); node++) {
+    offset = AlignUp(offset, SignalAlignment);
+    table[node].offset = offset;
+    table[node].size = nodes[node].size() / description.sample_size;
+    offset += nodes[node].size();
+  }
+  header.file_size = offset;
+
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  const auto write = [&file](const void* data, size_t size) {
+    file.write(static_cast<const char*>(data),
+               static_cast<std::streamsize>(size));
+  };
+
+  write(&header, sizeof(header));
+  for (size_t i = 0; i < FilterCount; i++) {
+    write(GetFilters(wavelet, i)->data(),
+          GetFilters(wavelet, i)->size() * sizeof(double));
+  }
+  write(table.data(), table.size() * sizeof(NodeEntry));
+
+  // Zeroes pad each node out to the alignment of the next.
+  const char padding[SignalAlignment] = {};
+  offset = header.table_offset + table.size() * sizeof(NodeEntry);
+  for (size_t node = 0; node < nodes.size(); node++) {
+    write(padding, table[node].offset - offset);
+    write(nodes[node].data(), nodes[node].size());
+    offset = table[node].offset + nodes[node].size();
+  }
+
+  file.close();
+  return !file.fail();
+}
+
+bool TreeFile::Open(const std::string& path) {
+  this->Close();
+
+#ifdef _WIN32
+  const HANDLE file =
+      CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+
+  LARGE_INTEGER file_size;
+  void* view = nullptr;
+  if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0) {
+    const HANDLE mapping =
+        CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+    if (mapping != nullptr) {
+      view = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+      CloseHandle(mapping);
+    }
+  }
+  CloseHandle(file);
+  if (view == nullptr) {
+    return false;
+  }
+
+  this->data_ = static_cast<char*>(view);
+  this->size_ = static_cast<size_t>(file_size.QuadPart);
+#else
+  const int file = open(path.c_str(), O_RDONLY);
+  if (file < 0) {
+    return false;
+  }
+
+  // The mapping is private, writes to it never reach the file.
+  struct stat status = {};
+  void* view = MAP_FAILED;
+  if (fstat(file, &status) == 0 && status.st_size > 0) {
+    view = mmap(nullptr, static_cast<size_t>(status.st_size),
+                PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+  }
+  close(file);
+  if (view == MAP_FAILED) {
+    return false;
+  }
+
+  this->data_ = static_cast<char*>(view);
+  this->size_ = static_cast<size_t>(status.st_size);
+#endif
+
+  if (!this->Validate()) {
+    this->Close();
+    return false;
+  }
+  return true;
+}
+
+void TreeFile::Close() {
+  if (this->data_ != nullptr) {
+#ifdef _WIN32
+    UnmapViewOfFile(this->data_);
+#else
+    munmap(this->data_, this->size_);
+#endif
+  }
+
+  this->data_ = nullptr;
+  this->size_ = 0;
+  this->description_ = {};
+  this->wavelet_ = Wavelet();
+  this->nodes_ = nullptr;
+  this->node_count_ = 0;
+}
+
+bool TreeFile::Validate() {
+  FileHeader header;
+  if (this->size_ < sizeof(header)) {
+    return false;
+  }
+  std::memcpy(&header, this->data_, sizeof(header));
+
+  if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0 ||
+      header.version != Version || header.byte_order != ByteOrderMark ||
+      header.file_size != this->size_) {
+    return false;
+  }
+  if ((header.sample_size != sizeof(float) &&
+       header.sample_size != sizeof(double)) ||
+      (header.children != 2 && header.children != 4) || header.height == 0 ||
+      header.height > 32 || header.channel_count == 0) {
+    return false;
+  }
+  if (header.dyadic_mode > static_cast<uint8_t>(DyadicMode::Odd) ||
+      header.padding_mode > static_cast<uint8_t>(PaddingMode::Periodic) ||
+      header.engine > static_cast<uint8_t>(TransformEngine::Lifting)) {
+    return false;
+  }
+
+  // A tree of height h has (k^h - 1) / (k - 1) nodes.
+  uint64_t node_count = 0;
+  for (uint32_t depth = 0; depth < header.height; depth++) {
+    node_count = node_count * header.children + 1;
+    if (node_count > this->size_) {
+      return false;
+    }
+  }
+  if (header.node_count != node_count) {
+    return false;
+  }
+
+  // Each filter is read in place, the offsets must stay within the file
+  // and keep the doubles aligned.
+  uint64_t offset = sizeof(FileHeader);
+  for (size_t i = 0; i < FilterCount; i++) {
+    if (header.filter_sizes[i] == 0 ||
+        header.filter_sizes[i] > (this->size_ - offset) / sizeof(double)) {
+      return false;
+    }
+    offset += header.filter_sizes[i] * sizeof(double);
+  }
+  if (header.table_offset != offset ||
+      node_count > (this->size_ - offset) / sizeof(NodeEntry)) {
+    return false;
+  }
+
+  this->nodes_ =
+      reinterpret_cast<const NodeEntry*>(this->data_ + header.table_offset);
+  for (size_t node = 0; node < node_count; node++) {
+    const NodeEntry& entry = this->nodes_[node];
+    if (entry.offset % SignalAlignment != 0 || entry.offset > this->size_ ||
+        entry.size > (this->size_ - entry.offset) / header.sample_size) {
+      this->nodes_ = nullptr;
+      return false;
+    }
+  }
+
+  const auto* filter =
+      reinterpret_cast<const double*>(this->data_ + sizeof(FileHeader));
+  std::vector<double>* filters[FilterCount] = {
+      &this->wavelet_.lowpassDecompositionFilter_,
+      &this->wavelet_.highpassDecompositionFilter_,
+      &this->wavelet_.lowpassReconstructionFilter_,
+      &this->wavelet_.highpassReconstructionFilter_};
+  for (size_t i = 0; i < FilterCount; i++) {
+    filters[i]->assign(filter, filter + header.filter_sizes[i]);
+    filter += header.filter_sizes[i];
+  }
+
+  this->node_count_ = static_cast<size_t>(node_count);
+  this->description_.children = header.children;
+  this->description_.height = header.height;
+  this->description_.channel_count = static_cast<size_t>(header.channel_count);
+  this->description_.sample_size = header.sample_size;
+  this->description_.dyadic_mode = static_cast<DyadicMode>(header.dyadic_mode);
+  this->description_.padding_mode =
+      static_cast<PaddingMode>(header.padding_mode);
+  this->description_.engine = static_cast<TransformEngine>(header.engine);
+  return true;
+}
+
+}  // namespace panwave
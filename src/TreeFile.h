@@ -0,0 +1,153 @@
+//-------------------------------------------------------------------------------------------------------
+// Copyright (C) Taylor Woll and panwave contributors. All rights reserved.
+// Licensed under the MIT license. See LICENSE.txt file in the project root for
+// full license information.
+//-------------------------------------------------------------------------------------------------------
+
+#ifndef TREEFILE_H
+#define TREEFILE_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Span.h"
+#include "Wavelet.h"
+#include "WaveletMath.h"
+
+namespace panwave {
+
+/**
+ * A file holding a decomposed wavelet packet tree, mapped into memory.<br/>
+ * The file records the wavelet filters, the modes and shape of the tree and
+ * the coefficients of every node, root included, in tree order. Each
+ * node's coefficients begin on a SignalAlignment boundary so they can be
+ * read in place, with the same alignment as the nodes of a tree.<br/>
+ * The file is mapped copy-on-write. Nothing is read until it is touched,
+ * and writing to a node changes the mapped copy but never the file.<br/>
+ * Values are stored in the byte order of the machine which wrote them. A
+ * file written with another byte order, another format version or another
+ * size of sample fails to open.
+ * @see WaveletPacketTreeTemplateBase::Save
+ * @see WaveletPacketTreeTemplateBase::MapFile
+ */
+class TreeFile {
+ public:
+  /**
+   * The version of the format written by Write. Open only accepts files of
+   * this version.
+   */
+  static constexpr uint32_t Version = 1;
+
+  /**
+   * The shape and modes of the tree held by a file.
+   */
+  struct Description {
+    size_t children;
+    size_t height;
+    size_t channel_count;
+    size_t sample_size;
+    DyadicMode dyadic_mode;
+    PaddingMode padding_mode;
+    TransformEngine engine;
+  };
+
+  TreeFile() = default;
+  TreeFile(const TreeFile&) = delete;
+  TreeFile(TreeFile&&) = delete;
+  TreeFile& operator=(const TreeFile&) = delete;
+  TreeFile& operator=(TreeFile&&) = delete;
+  ~TreeFile() { this->Close(); }
+
+  /**
+   * Write a tree to a file.
+   * @param path Path of the file, which is replaced if it exists.
+   * @param description The shape and modes of the tree.
+   * @param wavelet The wavelet the tree was decomposed with.
+   * @param nodes The bytes of the coefficients of every node, in tree order.
+   * @return False if the file could not be written.
+   */
+  static bool Write(const std::string& path, const Description& description,
+                    const Wavelet& wavelet,
+                    const std::vector<Span<const char>>& nodes);
+
+  /**
+   * Map a file written by Write, closing any file mapped before.<br/>
+   * The header and node table are checked against the size of the file.
+   * The coefficients are not read.
+   * @return False if the file cannot be mapped or is not a tree file of
+   * this version and byte order.
+   */
+  bool Open(const std::string& path);
+
+  /**
+   * Unmap the file. Spans returned by GetNodeSignal are invalid afterwards.
+   */
+  void Close();
+
+  /**
+   * Return true if a file is mapped.
+   */
+  bool IsOpen() const { return this->data_ != nullptr; }
+
+  /**
+   * Get the shape and modes of the tree held by the mapped file.
+   */
+  const Description& GetDescription() const { return this->description_; }
+
+  /**
+   * Get the wavelet the tree was decomposed with, rebuilt from the filters
+   * held by the file. Lives until the file is closed or another is opened.
+   */
+  const Wavelet& GetWavelet() const { return this->wavelet_; }
+
+  /**
+   * Get the number of nodes held by the file.
+   */
+  size_t GetNodeCount() const { return this->node_count_; }
+
+  /**
+   * Get the coefficients of a node in place in the mapping.<br/>
+   * Template argument |Sample| must have the sample size recorded in the
+   * file.
+   * @param node The index of the node in tree order. The root is node 0.
+   */
+  template <class Sample>
+  Span<Sample> GetNodeSignal(size_t node) {
+    assert(this->IsOpen());
+    assert(sizeof(Sample) == this->description_.sample_size);
+    assert(node < this->node_count_);
+
+    const NodeEntry& entry = this->nodes_[node];
+    return Span<Sample>(reinterpret_cast<Sample*>(this->data_ + entry.offset),
+                        static_cast<size_t>(entry.size));
+  }
+
+ private:
+  /**
+   * The location of the coefficients of a node in the file.
+   */
+  struct NodeEntry {
+    uint64_t offset;
+    uint64_t size;
+  };
+
+  /**
+   * Check the header and node table of the mapped file and read the
+   * description and wavelet from it.
+   */
+  bool Validate();
+
+  char* data_ = nullptr;
+  size_t size_ = 0;
+  Description description_ = {};
+  Wavelet wavelet_;
+  const NodeEntry* nodes_ = nullptr;
+  size_t node_count_ = 0;
+};
+
+}  // namespace panwave
+
+#endif  // TREEFILE_H
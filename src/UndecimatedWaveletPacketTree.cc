@@ -0,0 +1,196 @@
+//-------------------------------------------------------------------------------------------------------
+// Copyright (C) Taylor Woll and panwave contributors. All rights reserved.
+// Licensed under the MIT license. See LICENSE.txt file in the project root for
+// full license information.
+//-------------------------------------------------------------------------------------------------------
+
+#include "UndecimatedWaveletPacketTree.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "Wavelet.h"
+#include "WaveletPacketTreeTemplateBase.h"
+
+namespace {
+
+constexpr size_t ChildIndexLeft = 0;
+constexpr size_t ChildIndexRight = 1;
+
+}  // namespace
+
+namespace panwave {
+
+template <class Sample, class Accumulator>
+BasicUndecimatedWaveletPacketTree<Sample, Accumulator>::
+    BasicUndecimatedWaveletPacketTree(size_t height, const Wavelet* wavelet)
+    : WaveletPacketTreeTemplateBase<2, Sample, Accumulator>(height, wavelet) {}
+
+template <class Sample, class Accumulator>
+DyadicMode
+BasicUndecimatedWaveletPacketTree<Sample, Accumulator>::GetChildDyadicMode(
+    size_t /*child_index*/) const {
+  // Nothing is downsampled, both phases stay in the signal of each child.
+  return DyadicMode::Even;
+}
+
+template <class Sample, class Accumulator>
+CoefficientType
+BasicUndecimatedWaveletPacketTree<Sample, Accumulator>::GetChildCoefficientType(
+    size_t child_index) const {
+  return child_index == ChildIndexLeft ? CoefficientType::Approximation
+                                       : CoefficientType::Details;
+}
+
+template <class Sample, class Accumulator>
+PaddingMode
+BasicUndecimatedWaveletPacketTree<Sample, Accumulator>::GetPaddingMode() const {
+  // The signal is always extended periodically.
+  return PaddingMode::Periodic;
+}
+
+template <class Sample, class Accumulator>
+size_t
+BasicUndecimatedWaveletPacketTree<Sample, Accumulator>::GetChildSignalSize(
+    size_t parent_size, size_t /*child_index*/) const {
+  return parent_size;
+}
+
+template <class Sample, class Accumulator>
+size_t BasicUndecimatedWaveletPacketTree<Sample, Accumulator>::GetDilation(
+    size_t node) {
+  size_t dilation = 1;
+  for (; node != 0; node = this->GetParent(node)) {
+    dilation *= 2;
+  }
+  return dilation;
+}
+
+template <class Sample, class Accumulator>
+void BasicUndecimatedWaveletPacketTree<Sample, Accumulator>::Reconstruct(
+    size_t level) {
+  const TreeProfile::Scope scope(&this->profile_);
+  this->Reconstruct(level, this->GetReconstructedRoot());
+  this->ReleaseRootSignalView();
+}
+
+template <class Sample, class Accumulator>
+void BasicUndecimatedWaveletPacketTree<Sample, Accumulator>::Reconstruct(
+    size_t level, Span<Sample> signal) {
+  assert(level < this->GetWaveletLevelCount());
+
+  const TreeProfile::Scope scope(&this->profile_);
+  this->ReconstructPath(this->GetFirstLeaf() + level, signal);
+}
+
+template <class Sample, class Accumulator>
+void BasicUndecimatedWaveletPacketTree<Sample, Accumulator>::ReconstructAll(
+    Span<Sample> levels) {
+  const size_t level_count = this->GetWaveletLevelCount();
+  const size_t signal_size = this->GetNodeData(0).signal.size();
+
+  assert(levels.size() == level_count * signal_size);
+
+  const TreeProfile::Scope scope(&this->profile_);
+
+  // Each level is reconstructed straight into its row of levels.
+  for (size_t level = 0; level < level_count; level++) {
+    this->ReconstructPath(this->GetFirstLeaf() + level,
+                          levels.subspan(level * signal_size, signal_size));
+  }
+}
+
+template <class Sample, class Accumulator>
+void BasicUndecimatedWaveletPacketTree<Sample, Accumulator>::ReconstructPath(
+    size_t node, Span<Sample> signal) {
+  const Span<const Sample> root = this->GetNodeData(0).signal;
+  assert(signal.size() == root.size());
+
+  if (node == 0) {
+    if (signal.data() != root.data()) {
+      std::copy(root.begin(), root.end(), signal.begin());
+    }
+    return;
+  }
+
+  // Every node is as long as the root, each ancestor is reconstructed into
+  // the scratch buffer the previous one was not.
+  Span<const Sample> coeffs = this->GetComputedSignal(node);
+  size_t scratch_index = 0;
+
+  while (node != 0) {
+    const size_t parent = this->GetParent(node);
+    const Span<Sample> parent_signal =
+        parent == 0 ? signal
+                    : Span<Sample>(this->scratch_signals_[scratch_index]);
+
+    {
+      const NodeTimer timer(&this->profile_, node, true);
+      WaveletMath::ReconstructUndecimated<Sample, Accumulator>(
+          coeffs,
+          this->GetChildIndex(node) == ChildIndexLeft
+              ? this->lowpass_reconstruction_filter_
+              : this->highpass_reconstruction_filter_,
+          this->GetDilation(parent), parent_signal);
+    }
+
+    coeffs = parent_signal;
+    scratch_index = 1 - scratch_index;
+    node = parent;
+  }
+}
+
+template <class Sample, class Accumulator>
+void BasicUndecimatedWaveletPacketTree<Sample, Accumulator>::
+    DecomposeNodeSignal(size_t node) {
+  const Span<const Sample> signal = this->GetNodeData(node).signal;
+
+  WaveletMath::DecomposeUndecimated<Sample, Accumulator>(
+      signal, this->lowpass_decomposition_filter_,
+      this->highpass_decomposition_filter_, this->GetDilation(node),
+      this->GetNodeData(this->GetChild(node, ChildIndexLeft)).signal,
+      this->GetNodeData(this->GetChild(node, ChildIndexRight)).signal, 0,
+      signal.size());
+}
+
+template <class Sample, class Accumulator>
+void BasicUndecimatedWaveletPacketTree<Sample, Accumulator>::UpdateNode(
+    size_t node, size_t begin, size_t end) {
+  // A lazy tree computes the nodes it has not yet from the updated signal
+  // when they are read.
+  if (this->IsLeaf(node) || (this->lazy_ && !this->decomposed_[node])) {
+    return;
+  }
+
+  // Output n reads the signal from n - (filter_size - 1) * dilation up to
+  // n, so the children change from begin up to that far past end.
+  const Span<const Sample> signal = this->GetNodeData(node).signal;
+  const size_t size = signal.size();
+  const size_t dilation = this->GetDilation(node);
+  const size_t filter_size = this->lowpass_decomposition_filter_.size();
+  size_t count = end - begin + (filter_size - 1) * dilation;
+  if (count >= size) {
+    begin = 0;
+    count = size;
+  }
+
+  const size_t left = this->GetChild(node, ChildIndexLeft);
+  const size_t right = this->GetChild(node, ChildIndexRight);
+  {
+    const NodeTimer timer(&this->profile_, node, false);
+    WaveletMath::DecomposeUndecimated<Sample, Accumulator>(
+        signal, this->lowpass_decomposition_filter_,
+        this->highpass_decomposition_filter_, dilation,
+        this->GetNodeData(left).signal, this->GetNodeData(right).signal,
+        begin, count);
+  }
+
+  this->UpdateNode(left, begin, begin + count);
+  this->UpdateNode(right, begin, begin + count);
+}
+
+template class BasicUndecimatedWaveletPacketTree<double>;
+template class BasicUndecimatedWaveletPacketTree<float>;
+template class BasicUndecimatedWaveletPacketTree<float, double>;
+
+}  // namespace panwave
@@ -0,0 +1,116 @@
+//-------------------------------------------------------------------------------------------------------
+// Copyright (C) Taylor Woll and panwave contributors. All rights reserved.
+// Licensed under the MIT license. See LICENSE.txt file in the project root for
+// full license information.
+//-------------------------------------------------------------------------------------------------------
+
+#ifndef UNDECIMATEDWAVELETPACKETTREE_H
+#define UNDECIMATEDWAVELETPACKETTREE_H
+
+#include "StaticWavelet.h"
+#include "WaveletMath.h"
+#include "WaveletPacketTreeTemplateBase.h"
+
+namespace panwave {
+
+class Wavelet;
+
+/**
+ * An undecimated wavelet packet tree, computed with the a trous
+ * algorithm.<br/>
+ * This is a binary tree like WaveletPacketTree, with the approximation
+ * coefficients in the left (0th) child and the details coefficients in the
+ * right (1st) child of each node. Nodes are not downsampled. Instead the
+ * filters are dilated by 2^depth at each depth, so every node holds a
+ * signal exactly as long as the root.<br/>
+ * Like StationaryWaveletPacketTree, the decomposition is shift invariant:
+ * shifting the root signal shifts every node by the same amount. A
+ * StationaryWaveletPacketTree keeps both downsampling phases as separate
+ * children, giving 4^(height - 1) leaves. This tree keeps the phases
+ * interleaved in one signal per node, so it has 2^(height - 1) leaves and
+ * each depth holds 2^depth root-length signals. Each node is also
+ * exactly as long as the root, where the nodes of the other trees grow
+ * with the filter length at every depth.<br/>
+ * The signal is extended periodically, so a reconstructed wavelet level
+ * is as long as the root signal and the levels add up to the root signal
+ * exactly. The wavelet must be orthogonal, which every well-known wavelet
+ * is.<br/>
+ * Template argument |Sample| is the type of the signal values and
+ * |Accumulator| the type the filters are applied in.
+ * @see WaveletMath::DecomposeUndecimated
+ * @see WaveletPacketTreeTemplateBase
+ */
+template <class Sample, class Accumulator = Sample>
+class BasicUndecimatedWaveletPacketTree
+    : public WaveletPacketTreeTemplateBase<2, Sample, Accumulator> {
+ public:
+  /**
+   * Construct an UndecimatedWaveletPacketTree instance.<br/>
+   * Root signal is initially unset. Set it before calling Decompose.
+   * @param height Height of the tree. A tree with only one root node
+   *               has height of 1.
+   * @param wavelet Orthogonal wavelet used during decomposition /
+   *                reconstruction.
+   * @see Wavelet
+   * @see Decompose
+   * @see Reconstruct
+   */
+  BasicUndecimatedWaveletPacketTree(size_t height, const Wavelet* wavelet);
+
+  /**
+   * Construct an UndecimatedWaveletPacketTree instance using a
+   * compile-time wavelet.
+   * @see StaticWavelet
+   */
+  template <Wavelet::WaveletType Type, size_t VanishingMoment>
+  BasicUndecimatedWaveletPacketTree(
+      size_t height, StaticWavelet<Type, VanishingMoment> /*wavelet*/)
+      : BasicUndecimatedWaveletPacketTree(
+            height, &StaticWavelet<Type, VanishingMoment>::GetWavelet()) {}
+  ~BasicUndecimatedWaveletPacketTree() override = default;
+
+  void Reconstruct(size_t level) override;
+  void Reconstruct(size_t level, Span<Sample> signal) override;
+  void ReconstructAll(Span<Sample> levels) override;
+
+ protected:
+  DyadicMode GetChildDyadicMode(size_t child_index) const override;
+  CoefficientType GetChildCoefficientType(
+      size_t child_index) const override;
+  PaddingMode GetPaddingMode() const override;
+  size_t GetChildSignalSize(size_t parent_size,
+                            size_t child_index) const override;
+
+  void DecomposeNodeSignal(size_t node) override;
+
+  /**
+   * Recompute the coefficients below node which depend on the positions of
+   * its signal in [begin, end). Positions past the end of the signal wrap
+   * around to its beginning.
+   */
+  void UpdateNode(size_t node, size_t begin, size_t end) override;
+
+ private:
+  /**
+   * Get the spacing of the filter taps used to decompose node, 2^depth.
+   */
+  size_t GetDilation(size_t node);
+
+  /**
+   * Reconstruct the contribution of one node to the root signal.
+   * @param node The node to reconstruct.
+   * @param signal Destination for the reconstructed signal. Must hold as
+   *               many elements as the root signal and must not overlap
+   *               any node below the root.
+   */
+  void ReconstructPath(size_t node, Span<Sample> signal);
+};
+
+/**
+ * An undecimated wavelet packet tree of double signals.
+ */
+using UndecimatedWaveletPacketTree = BasicUndecimatedWaveletPacketTree<double>;
+
+}  // namespace panwave
+
+#endif  // UNDECIMATEDWAVELETPACKETTREE_H
@@ -7,6 +7,7 @@
 #ifndef WAVELET_H
 #define WAVELET_H
 
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 
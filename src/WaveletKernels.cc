@@ -0,0 +1,227 @@
+//-------------------------------------------------------------------------------------------------------
+// Copyright (C) Taylor Woll and panwave contributors. All rights reserved.
+// Licensed under the MIT license. See LICENSE.txt file in the project root for
+// full license information.
+//-------------------------------------------------------------------------------------------------------
+
+#include "WaveletKernels.h"
+
+#include <cassert>
+#include <type_traits>
+
+#include "WaveletKernelsImpl.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace {
+
+using panwave::BasicWaveletKernels;
+using panwave::KernelIsa;
+using panwave::WaveletKernelSet;
+using panwave::kernels::MakeWaveletKernels;
+
+/**
+ * Portable operations for the shared kernel bodies. Each vector holds a
+ * single value.
+ */
+template <class SampleType, class AccumulatorType>
+struct ScalarOps {
+  using Sample = SampleType;
+  using Accumulator = AccumulatorType;
+  using Vector = Accumulator;
+  static constexpr size_t Width = 1;
+  static constexpr size_t MaxUnrolledDecimateSize = 30;
+
+  static Vector Zero() { return 0; }
+  static Vector Broadcast(Accumulator x) { return x; }
+  static Vector Load(const Sample* p) { return *p; }
+  static void Store(Sample* p, Vector v) { *p = static_cast<Sample>(v); }
+  static Vector MultiplyAdd(Vector a, Vector b, Vector acc) {
+    return acc + a * b;
+  }
+  static Vector Min(Vector a, Vector b) { return b < a ? b : a; }
+  static Vector Max(Vector a, Vector b) { return a < b ? b : a; }
+  static Vector Subtract(Vector a, Vector b) { return a - b; }
+  static Vector Abs(Vector v) { return v < 0 ? -v : v; }
+  static Vector KeepGreater(Vector a, Vector b, Vector v) {
+    return a > b ? v : 0;
+  }
+  static void LoadDeinterleaved(const Sample* p, Vector* even, Vector* odd) {
+    *even = p[0];
+    *odd = p[1];
+  }
+  static void StoreInterleaved(Sample* p, Vector even, Vector odd) {
+    p[0] = static_cast<Sample>(even);
+    p[1] = static_cast<Sample>(odd);
+  }
+};
+
+constexpr auto scalarDoubleKernels =
+    MakeWaveletKernels<ScalarOps<double, double>>(KernelIsa::Scalar);
+constexpr auto scalarFloatKernels =
+    MakeWaveletKernels<ScalarOps<float, float>>(KernelIsa::Scalar);
+constexpr auto scalarFloatDoubleKernels =
+    MakeWaveletKernels<ScalarOps<float, double>>(KernelIsa::Scalar);
+
+constexpr WaveletKernelSet scalarKernels = {
+    &scalarDoubleKernels, &scalarFloatKernels, &scalarFloatDoubleKernels};
+
+/**
+ * Get the kernels for Sample and Accumulator out of set.
+ */
+template <class Sample, class Accumulator>
+const BasicWaveletKernels<Sample, Accumulator>* GetKernelsFromSet(
+    const WaveletKernelSet& set) {
+  if constexpr (std::is_same_v<Sample, double>) {
+    static_assert(std::is_same_v<Accumulator, double>,
+                  "Double samples are accumulated in double.");
+    return set.double_kernels;
+  } else if constexpr (std::is_same_v<Accumulator, float>) {
+    return set.float_kernels;
+  } else {
+    return set.float_double_kernels;
+  }
+}
+
+/**
+ * Returns true if the processor we are running on supports isa.
+ */
+bool IsSupportedByProcessor(KernelIsa isa) {
+  if (isa == KernelIsa::Scalar) {
+    return true;
+  }
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  __builtin_cpu_init();
+  switch (isa) {
+    case KernelIsa::Sse2:
+      return __builtin_cpu_supports("sse2") != 0;
+    case KernelIsa::Avx2:
+      return __builtin_cpu_supports("avx2") != 0 &&
+             __builtin_cpu_supports("fma") != 0;
+    case KernelIsa::Avx512:
+      return __builtin_cpu_supports("avx512f") != 0 &&
+             __builtin_cpu_supports("avx2") != 0 &&
+             __builtin_cpu_supports("fma") != 0;
+    default:
+      return false;
+  }
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  constexpr unsigned int Sse2Bit = 1U << 26U;
+  constexpr unsigned int FmaBit = 1U << 12U;
+  constexpr unsigned int OsxsaveBit = 1U << 27U;
+  constexpr unsigned int AvxBit = 1U << 28U;
+  constexpr unsigned int Avx2Bit = 1U << 5U;
+  constexpr unsigned int Avx512fBit = 1U << 16U;
+  // XMM and YMM state, plus opmask and ZMM state for AVX-512.
+  constexpr unsigned long long AvxOsState = 0x6ULL;
+  constexpr unsigned long long Avx512OsState = 0xE6ULL;
+
+  int regs[4] = {};
+  __cpuid(regs, 0);
+  const int max_leaf = regs[0];
+
+  __cpuidex(regs, 1, 0);
+  const auto ecx1 = static_cast<unsigned int>(regs[2]);
+  const auto edx1 = static_cast<unsigned int>(regs[3]);
+  if (isa == KernelIsa::Sse2) {
+    return (edx1 & Sse2Bit) != 0;
+  }
+
+  if ((ecx1 & OsxsaveBit) == 0 || (ecx1 & AvxBit) == 0 ||
+      (ecx1 & FmaBit) == 0 || max_leaf < 7) {
+    return false;
+  }
+  const unsigned long long os_state = _xgetbv(0);
+
+  __cpuidex(regs, 7, 0);
+  const auto ebx7 = static_cast<unsigned int>(regs[1]);
+  const bool avx2 = (ebx7 & Avx2Bit) != 0 &&
+                    (os_state & AvxOsState) == AvxOsState;
+  if (isa == KernelIsa::Avx2) {
+    return avx2;
+  }
+  return avx2 && (ebx7 & Avx512fBit) != 0 &&
+         (os_state & Avx512OsState) == Avx512OsState;
+#else
+  return false;
+#endif
+}
+
+template <class Sample, class Accumulator>
+const BasicWaveletKernels<Sample, Accumulator>& SelectWaveletKernels() {
+  const KernelIsa preferred[] = {KernelIsa::Avx512, KernelIsa::Avx2,
+                                 KernelIsa::Sse2};
+
+  for (const auto isa : preferred) {
+    const auto* kernels =
+        panwave::GetWaveletKernels<Sample, Accumulator>(isa);
+    if (kernels != nullptr) {
+      return *kernels;
+    }
+  }
+
+  return *GetKernelsFromSet<Sample, Accumulator>(scalarKernels);
+}
+
+}  // namespace
+
+namespace panwave {
+
+const WaveletKernelSet* GetScalarWaveletKernels() { return &scalarKernels; }
+
+template <class Sample, class Accumulator>
+const BasicWaveletKernels<Sample, Accumulator>& GetWaveletKernels() {
+  static const BasicWaveletKernels<Sample, Accumulator>& kernels =
+      SelectWaveletKernels<Sample, Accumulator>();
+  return kernels;
+}
+
+template <class Sample, class Accumulator>
+const BasicWaveletKernels<Sample, Accumulator>* GetWaveletKernels(
+    KernelIsa isa) {
+  if (!IsSupportedByProcessor(isa)) {
+    return nullptr;
+  }
+
+  const WaveletKernelSet* set = nullptr;
+  switch (isa) {
+    case KernelIsa::Scalar:
+      set = GetScalarWaveletKernels();
+      break;
+    case KernelIsa::Sse2:
+      set = GetSse2WaveletKernels();
+      break;
+    case KernelIsa::Avx2:
+      set = GetAvx2WaveletKernels();
+      break;
+    case KernelIsa::Avx512:
+      set = GetAvx512WaveletKernels();
+      break;
+    default:
+      assert(false);
+      break;
+  }
+
+  return set == nullptr ? nullptr
+                        : GetKernelsFromSet<Sample, Accumulator>(*set);
+}
+
+template const BasicWaveletKernels<double, double>&
+GetWaveletKernels<double, double>();
+template const BasicWaveletKernels<float, float>&
+GetWaveletKernels<float, float>();
+template const BasicWaveletKernels<float, double>&
+GetWaveletKernels<float, double>();
+
+template const BasicWaveletKernels<double, double>*
+GetWaveletKernels<double, double>(KernelIsa isa);
+template const BasicWaveletKernels<float, float>*
+GetWaveletKernels<float, float>(KernelIsa isa);
+template const BasicWaveletKernels<float, double>*
+GetWaveletKernels<float, double>(KernelIsa isa);
+
+}  // namespace panwave
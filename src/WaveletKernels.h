@@ -0,0 +1,185 @@
+//-------------------------------------------------------------------------------------------------------
+// Copyright (C) Taylor Woll and panwave contributors. All rights reserved.
+// Licensed under the MIT license. See LICENSE.txt file in the project root for
+// full license information.
+//-------------------------------------------------------------------------------------------------------
+
+#ifndef WAVELETKERNELS_H
+#define WAVELETKERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace panwave {
+
+/**
+ * The instruction set used by a set of wavelet kernels.<br/>
+ * Scalar kernels are portable and are always available. The others are
+ * only available when the library was built for an x86 target and the
+ * processor we are running on supports the instruction set.
+ * @see WaveletKernels
+ */
+enum class KernelIsa : uint8_t { Scalar = 0, Sse2, Avx2, Avx512 };
+
+/**
+ * A table of the inner loops used by WaveletMath.<br/>
+ * The kernels operate on raw buffers and never touch any element outside
+ * of the ranges described below. None of them handle signal boundaries,
+ * WaveletMath is responsible for computing the boundary values and only
+ * hands the interior of a signal to a kernel.<br/>
+ * Every kernel accumulates the filter taps of an output value in the same
+ * order as the scalar kernels. The SSE2 kernels produce results identical
+ * to the scalar kernels. The AVX2 and AVX-512 kernels use fused
+ * multiply-add so each product is not rounded before it is accumulated.
+ * For an output value computed from a filter of length L, the difference
+ * from the scalar result is bounded by L times the epsilon of Accumulator
+ * times the sum of the absolute values of the products contributing to the
+ * output, plus the final rounding to Sample. The threshold kernels give
+ * identical results on every instruction set.<br/>
+ * Within one set of kernels, an output value only depends on the inputs it
+ * is computed from. Computing a range of outputs over several calls gives
+ * the same values as computing it in one call.<br/>
+ * Template argument |Sample| is the type of the signal values the kernels
+ * read and write. |Accumulator| is the type of the filter taps and of the
+ * sums the kernels compute. Kernels exist for double samples accumulated in
+ * double, and for float samples accumulated in either float or double.
+ * @see GetWaveletKernels
+ */
+template <class Sample, class Accumulator = Sample>
+struct BasicWaveletKernels {
+  /**
+   * Compute result[i] = sum(data[i + j] * coeffs[coeffs_size - j - 1]) over
+   * j in [0, coeffs_size) for each i in [0, result_size).
+   */
+  void (*convolve)(const Sample* data, const Accumulator* coeffs,
+                   size_t coeffs_size, Sample* result, size_t result_size);
+
+  /**
+   * Compute every other value of two convolutions sharing the same input.
+   * For each m in [0, output_size):<br/>
+   * approx[m] = sum(data[2 * m + j] * lowpass[filter_size - j - 1])<br/>
+   * details[m] = sum(data[2 * m + j] * highpass[filter_size - j - 1])<br/>
+   * over j in [0, filter_size).
+   */
+  void (*decimate)(const Sample* data, const Accumulator* lowpass,
+                   const Accumulator* highpass, size_t filter_size,
+                   Sample* approx, Sample* details, size_t output_size);
+
+  /**
+   * Compute every value of two convolutions sharing the same input, split
+   * into the values at even and at odd indices. For each m in
+   * [0, output_size):<br/>
+   * even_approx[m] = sum(data[2 * m + j] * lowpass[filter_size - j - 1])<br/>
+   * even_details[m] = sum(data[2 * m + j] * highpass[filter_size - j - 1])
+   * <br/>
+   * odd_approx[m] = sum(data[2 * m + j + 1] * lowpass[filter_size - j - 1])
+   * <br/>
+   * odd_details[m] = sum(data[2 * m + j + 1] * highpass[filter_size - j - 1])
+   * <br/>
+   * over j in [0, filter_size). The even outputs equal those of decimate on
+   * data and the odd outputs those of decimate on data + 1, but each input
+   * value is loaded once for both.
+   */
+  void (*decimate_dual_phase)(const Sample* data, const Accumulator* lowpass,
+                              const Accumulator* highpass, size_t filter_size,
+                              Sample* even_approx, Sample* even_details,
+                              Sample* odd_approx, Sample* odd_details,
+                              size_t output_size);
+
+  /**
+   * Convolve a filter with a dyadically upsampled signal without reading
+   * the inserted zeroes.<br/>
+   * For each even output n = 2 * s in [0, data_size):<br/>
+   * data[n] = sum(coeffs[s + t] * filter[filter_size - 2 * t - 1])<br/>
+   * For each odd output n = 2 * s + 1 in [0, data_size):<br/>
+   * data[n] = sum(coeffs[s + t + 1] * filter[filter_size - 2 * t - 2])<br/>
+   * over t while the filter index is not negative.
+   */
+  void (*reconstruct)(const Sample* coeffs, const Accumulator* filter,
+                      size_t filter_size, Sample* data, size_t data_size);
+
+  /**
+   * Decimate several channel-interleaved signals at once. Element i of
+   * channel c is at data[i * channel_count + c], and the outputs are
+   * interleaved the same way. Each channel is computed as decimate computes
+   * it on its own, with the vector lanes running across channels. For each
+   * m in [0, output_size) and c in [0, channel_count):<br/>
+   * approx[m * channel_count + c] =
+   * sum(data[(2 * m + j) * channel_count + c] * lowpass[filter_size - j - 1])
+   * <br/>
+   * and likewise for details with highpass, over j in [0, filter_size).
+   */
+  void (*decimate_channels)(const Sample* data, const Accumulator* lowpass,
+                            const Accumulator* highpass, size_t filter_size,
+                            Sample* approx, Sample* details,
+                            size_t output_size, size_t channel_count);
+
+  /**
+   * Reconstruct several channel-interleaved signals at once. Each channel is
+   * computed as reconstruct computes it on its own, with coeffs and data
+   * interleaved as for decimate_channels.
+   */
+  void (*reconstruct_channels)(const Sample* coeffs, const Accumulator* filter,
+                               size_t filter_size, Sample* data,
+                               size_t data_size, size_t channel_count);
+
+  /**
+   * Add a filtered signal to another signal in place, as done by a lifting
+   * step. For each m in [0, target_size):<br/>
+   * target[m] += sum(source[m + j] * coeffs[coeffs_size - j - 1])<br/>
+   * over j in [0, coeffs_size).
+   */
+  void (*lift)(const Sample* source, const Accumulator* coeffs,
+               size_t coeffs_size, Sample* target, size_t target_size);
+
+  /**
+   * Shrink values toward zero by a threshold. For each i in [0, size):<br/>
+   * result[i] = data[i] - min(max(data[i], -threshold), threshold)<br/>
+   * result may be data, which thresholds the values in place.
+   */
+  void (*soft_threshold)(const Sample* data, Accumulator threshold,
+                         Sample* result, size_t size);
+
+  /**
+   * Zero the values whose magnitude does not exceed a threshold. For each i
+   * in [0, size):<br/>
+   * result[i] = |data[i]| > threshold ? data[i] : 0<br/>
+   * result may be data, which thresholds the values in place.
+   */
+  void (*hard_threshold)(const Sample* data, Accumulator threshold,
+                         Sample* result, size_t size);
+
+  /**
+   * The instruction set these kernels are implemented with.
+   */
+  KernelIsa isa;
+};
+
+/**
+ * The kernels for double samples.
+ */
+using WaveletKernels = BasicWaveletKernels<double>;
+
+/**
+ * Get the kernels WaveletMath uses.<br/>
+ * These are chosen the first time this is called by querying the processor
+ * for the widest supported instruction set. The choice does not change for
+ * the lifetime of the process.
+ * @see BasicWaveletKernels
+ */
+template <class Sample = double, class Accumulator = Sample>
+const BasicWaveletKernels<Sample, Accumulator>& GetWaveletKernels();
+
+/**
+ * Get the kernels implemented with a specific instruction set.
+ * @param isa The instruction set we want kernels for.
+ * @return The kernels or nullptr if the instruction set is not supported by
+ * the processor or was not compiled into the library.
+ */
+template <class Sample = double, class Accumulator = Sample>
+const BasicWaveletKernels<Sample, Accumulator>* GetWaveletKernels(
+    KernelIsa isa);
+
+}  // namespace panwave
+
+#endif  // WAVELETKERNELS_H
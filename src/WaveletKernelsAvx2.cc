@@ -0,0 +1,188 @@
+//-------------------------------------------------------------------------------------------------------
+// Copyright (C) Taylor Woll and panwave contributors. All rights reserved.
+// Licensed under the MIT license. See LICENSE.txt file in the project root for
+// full license information.
+//-------------------------------------------------------------------------------------------------------
+
+#include "WaveletKernelsImpl.h"
+
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+
+#include <immintrin.h>
+
+namespace {
+
+using panwave::KernelIsa;
+using panwave::WaveletKernelSet;
+using panwave::kernels::MakeWaveletKernels;
+
+struct Avx2DoubleOps {
+  using Sample = double;
+  using Accumulator = double;
+  using Vector = __m256d;
+  static constexpr size_t Width = 4;
+  static constexpr size_t MaxUnrolledDecimateSize = 8;
+
+  static Vector Zero() { return _mm256_setzero_pd(); }
+  static Vector Broadcast(double x) { return _mm256_set1_pd(x); }
+  static Vector Load(const double* p) { return _mm256_loadu_pd(p); }
+  static void Store(double* p, Vector v) { _mm256_storeu_pd(p, v); }
+  static Vector MultiplyAdd(Vector a, Vector b, Vector acc) {
+    return _mm256_fmadd_pd(a, b, acc);
+  }
+  static double MultiplyAdd(double a, double b, double acc) {
+    return _mm_cvtsd_f64(
+        _mm_fmadd_sd(_mm_set_sd(a), _mm_set_sd(b), _mm_set_sd(acc)));
+  }
+  static Vector Min(Vector a, Vector b) { return _mm256_min_pd(a, b); }
+  static Vector Max(Vector a, Vector b) { return _mm256_max_pd(a, b); }
+  static Vector Subtract(Vector a, Vector b) { return _mm256_sub_pd(a, b); }
+  static Vector Abs(Vector v) {
+    return _mm256_andnot_pd(_mm256_set1_pd(-0.0), v);
+  }
+  static Vector KeepGreater(Vector a, Vector b, Vector v) {
+    return _mm256_and_pd(_mm256_cmp_pd(a, b, _CMP_GT_OQ), v);
+  }
+  static void LoadDeinterleaved(const double* p, Vector* even, Vector* odd) {
+    const Vector lo = _mm256_loadu_pd(p);
+    const Vector hi = _mm256_loadu_pd(p + Width);
+    // Unpacking yields lanes in the order 0, 2, 1, 3. Swap the middle two.
+    constexpr int InOrder = 0xD8;
+    *even = _mm256_permute4x64_pd(_mm256_unpacklo_pd(lo, hi), InOrder);
+    *odd = _mm256_permute4x64_pd(_mm256_unpackhi_pd(lo, hi), InOrder);
+  }
+  static void StoreInterleaved(double* p, Vector even, Vector odd) {
+    const Vector lo = _mm256_unpacklo_pd(even, odd);
+    const Vector hi = _mm256_unpackhi_pd(even, odd);
+    constexpr int LowHalves = 0x20;
+    constexpr int HighHalves = 0x31;
+    _mm256_storeu_pd(p, _mm256_permute2f128_pd(lo, hi, LowHalves));
+    _mm256_storeu_pd(p + Width, _mm256_permute2f128_pd(lo, hi, HighHalves));
+  }
+};
+
+struct Avx2FloatOps {
+  using Sample = float;
+  using Accumulator = float;
+  using Vector = __m256;
+  static constexpr size_t Width = 8;
+  static constexpr size_t MaxUnrolledDecimateSize = 8;
+
+  static Vector Zero() { return _mm256_setzero_ps(); }
+  static Vector Broadcast(float x) { return _mm256_set1_ps(x); }
+  static Vector Load(const float* p) { return _mm256_loadu_ps(p); }
+  static void Store(float* p, Vector v) { _mm256_storeu_ps(p, v); }
+  static Vector MultiplyAdd(Vector a, Vector b, Vector acc) {
+    return _mm256_fmadd_ps(a, b, acc);
+  }
+  static float MultiplyAdd(float a, float b, float acc) {
+    return _mm_cvtss_f32(
+        _mm_fmadd_ss(_mm_set_ss(a), _mm_set_ss(b), _mm_set_ss(acc)));
+  }
+  static Vector Min(Vector a, Vector b) { return _mm256_min_ps(a, b); }
+  static Vector Max(Vector a, Vector b) { return _mm256_max_ps(a, b); }
+  static Vector Subtract(Vector a, Vector b) { return _mm256_sub_ps(a, b); }
+  static Vector Abs(Vector v) {
+    return _mm256_andnot_ps(_mm256_set1_ps(-0.0F), v);
+  }
+  static Vector KeepGreater(Vector a, Vector b, Vector v) {
+    return _mm256_and_ps(_mm256_cmp_ps(a, b, _CMP_GT_OQ), v);
+  }
+  static void LoadDeinterleaved(const float* p, Vector* even, Vector* odd) {
+    const Vector lo = _mm256_loadu_ps(p);
+    const Vector hi = _mm256_loadu_ps(p + Width);
+    // Shuffling works within 128-bit halves and yields the 64-bit pairs in
+    // the order 0, 2, 1, 3. Swap the middle two.
+    constexpr int EvenLanes = _MM_SHUFFLE(2, 0, 2, 0);
+    constexpr int OddLanes = _MM_SHUFFLE(3, 1, 3, 1);
+    constexpr int InOrder = 0xD8;
+    *even = _mm256_castpd_ps(_mm256_permute4x64_pd(
+        _mm256_castps_pd(_mm256_shuffle_ps(lo, hi, EvenLanes)), InOrder));
+    *odd = _mm256_castpd_ps(_mm256_permute4x64_pd(
+        _mm256_castps_pd(_mm256_shuffle_ps(lo, hi, OddLanes)), InOrder));
+  }
+  static void StoreInterleaved(float* p, Vector even, Vector odd) {
+    const Vector lo = _mm256_unpacklo_ps(even, odd);
+    const Vector hi = _mm256_unpackhi_ps(even, odd);
+    constexpr int LowHalves = 0x20;
+    constexpr int HighHalves = 0x31;
+    _mm256_storeu_ps(p, _mm256_permute2f128_ps(lo, hi, LowHalves));
+    _mm256_storeu_ps(p + Width, _mm256_permute2f128_ps(lo, hi, HighHalves));
+  }
+};
+
+// Float samples accumulated in double. Each vector holds four samples
+// converted to double.
+struct Avx2FloatDoubleOps {
+  using Sample = float;
+  using Accumulator = double;
+  using Vector = __m256d;
+  static constexpr size_t Width = 4;
+  static constexpr size_t MaxUnrolledDecimateSize = 8;
+
+  static Vector Zero() { return _mm256_setzero_pd(); }
+  static Vector Broadcast(double x) { return _mm256_set1_pd(x); }
+  static Vector Load(const float* p) {
+    return _mm256_cvtps_pd(_mm_loadu_ps(p));
+  }
+  static void Store(float* p, Vector v) {
+    _mm_storeu_ps(p, _mm256_cvtpd_ps(v));
+  }
+  static Vector MultiplyAdd(Vector a, Vector b, Vector acc) {
+    return _mm256_fmadd_pd(a, b, acc);
+  }
+  static double MultiplyAdd(double a, double b, double acc) {
+    return _mm_cvtsd_f64(
+        _mm_fmadd_sd(_mm_set_sd(a), _mm_set_sd(b), _mm_set_sd(acc)));
+  }
+  static Vector Min(Vector a, Vector b) { return _mm256_min_pd(a, b); }
+  static Vector Max(Vector a, Vector b) { return _mm256_max_pd(a, b); }
+  static Vector Subtract(Vector a, Vector b) { return _mm256_sub_pd(a, b); }
+  static Vector Abs(Vector v) {
+    return _mm256_andnot_pd(_mm256_set1_pd(-0.0), v);
+  }
+  static Vector KeepGreater(Vector a, Vector b, Vector v) {
+    return _mm256_and_pd(_mm256_cmp_pd(a, b, _CMP_GT_OQ), v);
+  }
+  static void LoadDeinterleaved(const float* p, Vector* even, Vector* odd) {
+    const __m256i lanes = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+    const __m256 values =
+        _mm256_permutevar8x32_ps(_mm256_loadu_ps(p), lanes);
+    *even = _mm256_cvtps_pd(_mm256_castps256_ps128(values));
+    *odd = _mm256_cvtps_pd(_mm256_extractf128_ps(values, 1));
+  }
+  static void StoreInterleaved(float* p, Vector even, Vector odd) {
+    const __m128 even_values = _mm256_cvtpd_ps(even);
+    const __m128 odd_values = _mm256_cvtpd_ps(odd);
+    _mm_storeu_ps(p, _mm_unpacklo_ps(even_values, odd_values));
+    _mm_storeu_ps(p + Width, _mm_unpackhi_ps(even_values, odd_values));
+  }
+};
+
+constexpr auto avx2DoubleKernels =
+    MakeWaveletKernels<Avx2DoubleOps>(KernelIsa::Avx2);
+constexpr auto avx2FloatKernels =
+    MakeWaveletKernels<Avx2FloatOps>(KernelIsa::Avx2);
+constexpr auto avx2FloatDoubleKernels =
+    MakeWaveletKernels<Avx2FloatDoubleOps>(KernelIsa::Avx2);
+
+constexpr WaveletKernelSet avx2Kernels = {
+    &avx2DoubleKernels, &avx2FloatKernels, &avx2FloatDoubleKernels};
+
+}  // namespace
+
+namespace panwave {
+
+const WaveletKernelSet* GetAvx2WaveletKernels() { return &avx2Kernels; }
+
+}  // namespace panwave
+
+#else
+
+namespace panwave {
+
+const WaveletKernelSet* GetAvx2WaveletKernels() { return nullptr; }
+
+}  // namespace panwave
+
+#endif
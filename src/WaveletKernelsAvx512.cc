@@ -0,0 +1,196 @@
+//-------------------------------------------------------------------------------------------------------
+// Copyright (C) Taylor Woll and panwave contributors. All rights reserved.
+// Licensed under the MIT license. See LICENSE.txt file in the project root for
+// full license information.
+//-------------------------------------------------------------------------------------------------------
+
+#include "WaveletKernelsImpl.h"
+
+#if defined(__AVX512F__)
+
+// GCC reports the undefined upper lanes the AVX-512 intrinsics start from
+// as uninitialized.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+#include <immintrin.h>
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+namespace {
+
+using panwave::KernelIsa;
+using panwave::WaveletKernelSet;
+using panwave::kernels::MakeWaveletKernels;
+
+struct Avx512DoubleOps {
+  using Sample = double;
+  using Accumulator = double;
+  using Vector = __m512d;
+  static constexpr size_t Width = 8;
+  static constexpr size_t MaxUnrolledDecimateSize = 30;
+
+  static Vector Zero() { return _mm512_setzero_pd(); }
+  static Vector Broadcast(double x) { return _mm512_set1_pd(x); }
+  static Vector Load(const double* p) { return _mm512_loadu_pd(p); }
+  static void Store(double* p, Vector v) { _mm512_storeu_pd(p, v); }
+  static Vector MultiplyAdd(Vector a, Vector b, Vector acc) {
+    return _mm512_fmadd_pd(a, b, acc);
+  }
+  static double MultiplyAdd(double a, double b, double acc) {
+    return _mm_cvtsd_f64(
+        _mm_fmadd_sd(_mm_set_sd(a), _mm_set_sd(b), _mm_set_sd(acc)));
+  }
+  static Vector Min(Vector a, Vector b) { return _mm512_min_pd(a, b); }
+  static Vector Max(Vector a, Vector b) { return _mm512_max_pd(a, b); }
+  static Vector Subtract(Vector a, Vector b) { return _mm512_sub_pd(a, b); }
+  static Vector Abs(Vector v) { return _mm512_abs_pd(v); }
+  static Vector KeepGreater(Vector a, Vector b, Vector v) {
+    return _mm512_maskz_mov_pd(_mm512_cmp_pd_mask(a, b, _CMP_GT_OQ), v);
+  }
+  static void LoadDeinterleaved(const double* p, Vector* even, Vector* odd) {
+    const Vector lo = _mm512_loadu_pd(p);
+    const Vector hi = _mm512_loadu_pd(p + Width);
+    // Indices 0-7 select lanes of lo, 8-15 select lanes of hi.
+    const __m512i even_lanes = _mm512_set_epi64(14, 12, 10, 8, 6, 4, 2, 0);
+    const __m512i odd_lanes = _mm512_set_epi64(15, 13, 11, 9, 7, 5, 3, 1);
+    *even = _mm512_permutex2var_pd(lo, even_lanes, hi);
+    *odd = _mm512_permutex2var_pd(lo, odd_lanes, hi);
+  }
+  static void StoreInterleaved(double* p, Vector even, Vector odd) {
+    // Indices 0-7 select lanes of even, 8-15 select lanes of odd.
+    const __m512i low_lanes = _mm512_set_epi64(11, 3, 10, 2, 9, 1, 8, 0);
+    const __m512i high_lanes = _mm512_set_epi64(15, 7, 14, 6, 13, 5, 12, 4);
+    _mm512_storeu_pd(p, _mm512_permutex2var_pd(even, low_lanes, odd));
+    _mm512_storeu_pd(p + Width, _mm512_permutex2var_pd(even, high_lanes, odd));
+  }
+};
+
+struct Avx512FloatOps {
+  using Sample = float;
+  using Accumulator = float;
+  using Vector = __m512;
+  static constexpr size_t Width = 16;
+  static constexpr size_t MaxUnrolledDecimateSize = 30;
+
+  static Vector Zero() { return _mm512_setzero_ps(); }
+  static Vector Broadcast(float x) { return _mm512_set1_ps(x); }
+  static Vector Load(const float* p) { return _mm512_loadu_ps(p); }
+  static void Store(float* p, Vector v) { _mm512_storeu_ps(p, v); }
+  static Vector MultiplyAdd(Vector a, Vector b, Vector acc) {
+    return _mm512_fmadd_ps(a, b, acc);
+  }
+  static float MultiplyAdd(float a, float b, float acc) {
+    return _mm_cvtss_f32(
+        _mm_fmadd_ss(_mm_set_ss(a), _mm_set_ss(b), _mm_set_ss(acc)));
+  }
+  static Vector Min(Vector a, Vector b) { return _mm512_min_ps(a, b); }
+  static Vector Max(Vector a, Vector b) { return _mm512_max_ps(a, b); }
+  static Vector Subtract(Vector a, Vector b) { return _mm512_sub_ps(a, b); }
+  static Vector Abs(Vector v) { return _mm512_abs_ps(v); }
+  static Vector KeepGreater(Vector a, Vector b, Vector v) {
+    return _mm512_maskz_mov_ps(_mm512_cmp_ps_mask(a, b, _CMP_GT_OQ), v);
+  }
+  static void LoadDeinterleaved(const float* p, Vector* even, Vector* odd) {
+    const Vector lo = _mm512_loadu_ps(p);
+    const Vector hi = _mm512_loadu_ps(p + Width);
+    // Indices 0-15 select lanes of lo, 16-31 select lanes of hi.
+    const __m512i even_lanes = _mm512_setr_epi32(
+        0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+    const __m512i odd_lanes = _mm512_setr_epi32(
+        1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+    *even = _mm512_permutex2var_ps(lo, even_lanes, hi);
+    *odd = _mm512_permutex2var_ps(lo, odd_lanes, hi);
+  }
+  static void StoreInterleaved(float* p, Vector even, Vector odd) {
+    // Indices 0-15 select lanes of even, 16-31 select lanes of odd.
+    const __m512i low_lanes = _mm512_setr_epi32(0, 16, 1, 17, 2, 18, 3, 19, 4,
+                                                20, 5, 21, 6, 22, 7, 23);
+    const __m512i high_lanes = _mm512_setr_epi32(
+        8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31);
+    _mm512_storeu_ps(p, _mm512_permutex2var_ps(even, low_lanes, odd));
+    _mm512_storeu_ps(p + Width, _mm512_permutex2var_ps(even, high_lanes, odd));
+  }
+};
+
+// Float samples accumulated in double. Each vector holds eight samples
+// converted to double.
+struct Avx512FloatDoubleOps {
+  using Sample = float;
+  using Accumulator = double;
+  using Vector = __m512d;
+  static constexpr size_t Width = 8;
+  static constexpr size_t MaxUnrolledDecimateSize = 30;
+
+  static Vector Zero() { return _mm512_setzero_pd(); }
+  static Vector Broadcast(double x) { return _mm512_set1_pd(x); }
+  static Vector Load(const float* p) {
+    return _mm512_cvtps_pd(_mm256_loadu_ps(p));
+  }
+  static void Store(float* p, Vector v) {
+    _mm256_storeu_ps(p, _mm512_cvtpd_ps(v));
+  }
+  static Vector MultiplyAdd(Vector a, Vector b, Vector acc) {
+    return _mm512_fmadd_pd(a, b, acc);
+  }
+  static double MultiplyAdd(double a, double b, double acc) {
+    return _mm_cvtsd_f64(
+        _mm_fmadd_sd(_mm_set_sd(a), _mm_set_sd(b), _mm_set_sd(acc)));
+  }
+  static Vector Min(Vector a, Vector b) { return _mm512_min_pd(a, b); }
+  static Vector Max(Vector a, Vector b) { return _mm512_max_pd(a, b); }
+  static Vector Subtract(Vector a, Vector b) { return _mm512_sub_pd(a, b); }
+  static Vector Abs(Vector v) { return _mm512_abs_pd(v); }
+  static Vector KeepGreater(Vector a, Vector b, Vector v) {
+    return _mm512_maskz_mov_pd(_mm512_cmp_pd_mask(a, b, _CMP_GT_OQ), v);
+  }
+  static void LoadDeinterleaved(const float* p, Vector* even, Vector* odd) {
+    const __m512i lanes = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 1, 3,
+                                            5, 7, 9, 11, 13, 15);
+    const __m512 values = _mm512_permutexvar_ps(lanes, _mm512_loadu_ps(p));
+    *even = _mm512_cvtps_pd(_mm512_castps512_ps256(values));
+    *odd = _mm512_cvtps_pd(_mm256_castpd_ps(
+        _mm512_extractf64x4_pd(_mm512_castps_pd(values), 1)));
+  }
+  static void StoreInterleaved(float* p, Vector even, Vector odd) {
+    const __m256 even_values = _mm512_cvtpd_ps(even);
+    const __m256 odd_values = _mm512_cvtpd_ps(odd);
+    const __m256 lo = _mm256_unpacklo_ps(even_values, odd_values);
+    const __m256 hi = _mm256_unpackhi_ps(even_values, odd_values);
+    constexpr int LowHalves = 0x20;
+    constexpr int HighHalves = 0x31;
+    _mm256_storeu_ps(p, _mm256_permute2f128_ps(lo, hi, LowHalves));
+    _mm256_storeu_ps(p + Width, _mm256_permute2f128_ps(lo, hi, HighHalves));
+  }
+};
+
+constexpr auto avx512DoubleKernels =
+    MakeWaveletKernels<Avx512DoubleOps>(KernelIsa::Avx512);
+constexpr auto avx512FloatKernels =
+    MakeWaveletKernels<Avx512FloatOps>(KernelIsa::Avx512);
+constexpr auto avx512FloatDoubleKernels =
+    MakeWaveletKernels<Avx512FloatDoubleOps>(KernelIsa::Avx512);
+
+constexpr WaveletKernelSet avx512Kernels = {
+    &avx512DoubleKernels, &avx512FloatKernels, &avx512FloatDoubleKernels};
+
+}  // namespace
+
+namespace panwave {
+
+const WaveletKernelSet* GetAvx512WaveletKernels() { return &avx512Kernels; }
+
+}  // namespace panwave
+
+#else
+
+namespace panwave {
+
+const WaveletKernelSet* GetAvx512WaveletKernels() { return nullptr; }
+
+}  // namespace panwave
+
+#endif
@@ -0,0 +1,680 @@
+//-------------------------------------------------------------------------------------------------------
+// Copyright (C) Taylor Woll and panwave contributors. All rights reserved.
+// Licensed under the MIT license. See LICENSE.txt file in the project root for
+// full license information.
+//-------------------------------------------------------------------------------------------------------
+
+#ifndef WAVELETKERNELSIMPL_H
+#define WAVELETKERNELSIMPL_H
+
+#include <cstddef>
+
+#include "WaveletKernels.h"
+
+// This header is included by translation units which are compiled with
+// instruction set specific flags. Keep it free of standard library
+// templates, any of their instantiations could be merged with the ones
+// from a translation unit compiled for a different instruction set.
+
+namespace panwave {
+
+/**
+ * The kernels of one instruction set for every supported combination of
+ * sample and accumulator type.
+ */
+struct WaveletKernelSet {
+  const BasicWaveletKernels<double, double>* double_kernels;
+  const BasicWaveletKernels<float, float>* float_kernels;
+  const BasicWaveletKernels<float, double>* float_double_kernels;
+};
+
+/**
+ * Get the kernels for one instruction set.<br/>
+ * Each is defined in a translation unit compiled for that instruction set
+ * and returns nullptr if the library was built without it. Callers must
+ * check the processor supports the instruction set before using them.
+ * @see GetWaveletKernels
+ */
+const WaveletKernelSet* GetScalarWaveletKernels();
+const WaveletKernelSet* GetSse2WaveletKernels();
+const WaveletKernelSet* GetAvx2WaveletKernels();
+const WaveletKernelSet* GetAvx512WaveletKernels();
+
+namespace kernels {
+
+// Kernel bodies shared by every instruction set.<br/>
+// Template argument |Ops| wraps the vector type and operations of one
+// instruction set for one sample type. It must provide:<br/>
+// Sample - The type of the signal values read and written.<br/>
+// Accumulator - The type of the filter taps and of the sums the kernels
+// accumulate. Samples are converted to it when loaded and back when
+// stored.<br/>
+// Vector - The vector type, holding Accumulator values.<br/>
+// Width - The number of values in a Vector.<br/>
+// Zero() - Returns a Vector with all lanes set to zero.<br/>
+// Broadcast(x) - Returns a Vector with all lanes set to x.<br/>
+// Load(p) - Loads Width unaligned samples from p.<br/>
+// Store(p, v) - Stores v to Width unaligned samples at p.<br/>
+// MultiplyAdd(a, b, acc) - Returns acc + a * b, for Vectors as well as for
+// single Accumulator values. Both must round alike so an output comes out
+// the same whether it is computed in a vector or in the scalar tail.<br/>
+// LoadDeinterleaved(p, even, odd) - Loads 2 * Width samples from p. The
+// even-indexed ones are written to even and the odd-indexed ones to odd.<br/>
+// StoreInterleaved(p, even, odd) - The inverse of LoadDeinterleaved.<br/>
+// Min(a, b), Max(a, b), Subtract(a, b) - Return the lane-wise minimum,
+// maximum and difference of two Vectors.<br/>
+// Abs(v) - Returns the magnitude of each lane of v.<br/>
+// KeepGreater(a, b, v) - Returns v in the lanes where a is greater than b
+// and zero in the others.<br/>
+// MaxUnrolledDecimateSize - The longest filter Decimate uses a fixed size
+// body for. The unrolled body keeps every tap of both filters in a register,
+// with 16 vector registers it is slower than the generic body once those
+// no longer fit.<br/>
+// Each body is also templated on FixedSize. When it is not zero, the filter
+// size argument is replaced by FixedSize so the loops over the filter taps
+// have a constant trip count, which lets the compiler unroll them fully.
+
+/**
+ * The filter lengths of the built-in wavelets. Every kernel has a copy of
+ * its body specialized for each of these lengths.
+ * @see StaticWavelet
+ */
+template <size_t... Sizes>
+struct FilterSizeList {};
+using BuiltInFilterSizes =
+    FilterSizeList<4, 6, 8, 10, 12, 14, 16, 18, 20, 24, 30>;
+
+template <class Ops>
+using SampleOf = typename Ops::Sample;
+
+template <class Ops>
+using AccumulatorOf = typename Ops::Accumulator;
+
+template <class Ops, size_t FixedSize>
+void ConvolveBody(const SampleOf<Ops>* data, const AccumulatorOf<Ops>* coeffs,
+                  size_t coeffs_size, SampleOf<Ops>* result,
+                  size_t result_size) {
+  if constexpr (FixedSize != 0) {
+    coeffs_size = FixedSize;
+  }
+  size_t i = 0;
+
+  for (; i + Ops::Width <= result_size; i += Ops::Width) {
+    auto val = Ops::Zero();
+
+    for (size_t j = 0; j < coeffs_size; j++) {
+      val = Ops::MultiplyAdd(Ops::Load(data + i + j),
+                             Ops::Broadcast(coeffs[coeffs_size - j - 1]), val);
+    }
+
+    Ops::Store(result + i, val);
+  }
+
+  for (; i < result_size; i++) {
+    AccumulatorOf<Ops> val = 0;
+
+    for (size_t j = 0; j < coeffs_size; j++) {
+      val = Ops::MultiplyAdd(data[i + j], coeffs[coeffs_size - j - 1], val);
+    }
+
+    result[i] = static_cast<SampleOf<Ops>>(val);
+  }
+}
+
+template <class Ops, size_t FixedSize>
+void DecimateBody(const SampleOf<Ops>* data, const AccumulatorOf<Ops>* lowpass,
+                  const AccumulatorOf<Ops>* highpass, size_t filter_size,
+                  SampleOf<Ops>* approx, SampleOf<Ops>* details,
+                  size_t output_size) {
+  if constexpr (FixedSize != 0) {
+    filter_size = FixedSize;
+  }
+  size_t m = 0;
+
+  // Consecutive outputs read the input with a stride of two. One
+  // deinterleaved load feeds two taps: the even lanes hold the input for
+  // tap j and the odd lanes hold the input for tap j + 1.
+  if (filter_size > 1) {
+    for (; m + Ops::Width <= output_size; m += Ops::Width) {
+      const SampleOf<Ops>* window = data + 2 * m;
+      auto low = Ops::Zero();
+      auto high = Ops::Zero();
+      typename Ops::Vector even;
+      typename Ops::Vector odd;
+      size_t j = 0;
+
+      for (; j + 1 < filter_size; j += 2) {
+        Ops::LoadDeinterleaved(window + j, &even, &odd);
+        low = Ops::MultiplyAdd(
+            even, Ops::Broadcast(lowpass[filter_size - j - 1]), low);
+        high = Ops::MultiplyAdd(
+            even, Ops::Broadcast(highpass[filter_size - j - 1]), high);
+        low = Ops::MultiplyAdd(
+            odd, Ops::Broadcast(lowpass[filter_size - j - 2]), low);
+        high = Ops::MultiplyAdd(
+            odd, Ops::Broadcast(highpass[filter_size - j - 2]), high);
+      }
+
+      if (j < filter_size) {
+        // Odd filter length. Reading from window + j would run one element
+        // past the last window, read the final tap from the odd lanes one
+        // element earlier instead.
+        Ops::LoadDeinterleaved(window + j - 1, &even, &odd);
+        low = Ops::MultiplyAdd(odd, Ops::Broadcast(lowpass[0]), low);
+        high = Ops::MultiplyAdd(odd, Ops::Broadcast(highpass[0]), high);
+      }
+
+      Ops::Store(approx + m, low);
+      Ops::Store(details + m, high);
+    }
+  }
+
+  for (; m < output_size; m++) {
+    const SampleOf<Ops>* window = data + 2 * m;
+    AccumulatorOf<Ops> low = 0;
+    AccumulatorOf<Ops> high = 0;
+
+    for (size_t j = 0; j < filter_size; j++) {
+      low = Ops::MultiplyAdd(window[j], lowpass[filter_size - j - 1], low);
+      high = Ops::MultiplyAdd(window[j], highpass[filter_size - j - 1], high);
+    }
+
+    approx[m] = static_cast<SampleOf<Ops>>(low);
+    details[m] = static_cast<SampleOf<Ops>>(high);
+  }
+}
+
+template <class Ops, size_t FixedSize>
+void DecimateDualPhaseBody(const SampleOf<Ops>* data,
+                           const AccumulatorOf<Ops>* lowpass,
+                           const AccumulatorOf<Ops>* highpass,
+                           size_t filter_size, SampleOf<Ops>* even_approx,
+                           SampleOf<Ops>* even_details,
+                           SampleOf<Ops>* odd_approx,
+                           SampleOf<Ops>* odd_details, size_t output_size) {
+  if constexpr (FixedSize != 0) {
+    filter_size = FixedSize;
+  }
+  size_t m = 0;
+
+  // The deinterleaved load at window + j holds the input for tap j of the
+  // even outputs and tap j - 1 of the odd outputs in its even lanes, and for
+  // tap j + 1 of the even outputs and tap j of the odd outputs in its odd
+  // lanes. Every output still accumulates its taps in order.
+  if (filter_size > 1) {
+    for (; m + Ops::Width <= output_size; m += Ops::Width) {
+      const SampleOf<Ops>* window = data + 2 * m;
+      auto even_low = Ops::Zero();
+      auto even_high = Ops::Zero();
+      auto odd_low = Ops::Zero();
+      auto odd_high = Ops::Zero();
+      typename Ops::Vector even;
+      typename Ops::Vector odd;
+      size_t j = 0;
+
+      for (; j + 1 < filter_size; j += 2) {
+        Ops::LoadDeinterleaved(window + j, &even, &odd);
+        if (j > 0) {
+          odd_low = Ops::MultiplyAdd(
+              even, Ops::Broadcast(lowpass[filter_size - j]), odd_low);
+          odd_high = Ops::MultiplyAdd(
+              even, Ops::Broadcast(highpass[filter_size - j]), odd_high);
+        }
+        even_low = Ops::MultiplyAdd(
+            even, Ops::Broadcast(lowpass[filter_size - j - 1]), even_low);
+        even_high = Ops::MultiplyAdd(
+            even, Ops::Broadcast(highpass[filter_size - j - 1]), even_high);
+        even_low = Ops::MultiplyAdd(
+            odd, Ops::Broadcast(lowpass[filter_size - j - 2]), even_low);
+        even_high = Ops::MultiplyAdd(
+            odd, Ops::Broadcast(highpass[filter_size - j - 2]), even_high);
+        odd_low = Ops::MultiplyAdd(
+            odd, Ops::Broadcast(lowpass[filter_size - j - 1]), odd_low);
+        odd_high = Ops::MultiplyAdd(
+            odd, Ops::Broadcast(highpass[filter_size - j - 1]), odd_high);
+      }
+
+      if (j < filter_size) {
+        // Odd filter length. The last load feeds the final tap of the even
+        // outputs and the last two taps of the odd outputs.
+        Ops::LoadDeinterleaved(window + j, &even, &odd);
+        odd_low = Ops::MultiplyAdd(even, Ops::Broadcast(lowpass[1]), odd_low);
+        odd_high =
+            Ops::MultiplyAdd(even, Ops::Broadcast(highpass[1]), odd_high);
+        even_low =
+            Ops::MultiplyAdd(even, Ops::Broadcast(lowpass[0]), even_low);
+        even_high =
+            Ops::MultiplyAdd(even, Ops::Broadcast(highpass[0]), even_high);
+        odd_low = Ops::MultiplyAdd(odd, Ops::Broadcast(lowpass[0]), odd_low);
+        odd_high = Ops::MultiplyAdd(odd, Ops::Broadcast(highpass[0]), odd_high);
+      } else {
+        // Even filter length. Only the final tap of the odd outputs is left.
+        // Reading from window + j would run one element past the last
+        // window, read it from the odd lanes one element earlier instead.
+        Ops::LoadDeinterleaved(window + j - 1, &even, &odd);
+        odd_low = Ops::MultiplyAdd(odd, Ops::Broadcast(lowpass[0]), odd_low);
+        odd_high = Ops::MultiplyAdd(odd, Ops::Broadcast(highpass[0]), odd_high);
+      }
+
+      Ops::Store(even_approx + m, even_low);
+      Ops::Store(even_details + m, even_high);
+      Ops::Store(odd_approx + m, odd_low);
+      Ops::Store(odd_details + m, odd_high);
+    }
+  }
+
+  for (; m < output_size; m++) {
+    const SampleOf<Ops>* window = data + 2 * m;
+    AccumulatorOf<Ops> even_low = 0;
+    AccumulatorOf<Ops> even_high = 0;
+    AccumulatorOf<Ops> odd_low = 0;
+    AccumulatorOf<Ops> odd_high = 0;
+
+    for (size_t j = 0; j < filter_size; j++) {
+      const AccumulatorOf<Ops> low_tap = lowpass[filter_size - j - 1];
+      const AccumulatorOf<Ops> high_tap = highpass[filter_size - j - 1];
+      even_low = Ops::MultiplyAdd(window[j], low_tap, even_low);
+      even_high = Ops::MultiplyAdd(window[j], high_tap, even_high);
+      odd_low = Ops::MultiplyAdd(window[j + 1], low_tap, odd_low);
+      odd_high = Ops::MultiplyAdd(window[j + 1], high_tap, odd_high);
+    }
+
+    even_approx[m] = static_cast<SampleOf<Ops>>(even_low);
+    even_details[m] = static_cast<SampleOf<Ops>>(even_high);
+    odd_approx[m] = static_cast<SampleOf<Ops>>(odd_low);
+    odd_details[m] = static_cast<SampleOf<Ops>>(odd_high);
+  }
+}
+
+template <class Ops, size_t FixedSize>
+void ReconstructBody(const SampleOf<Ops>* coeffs,
+                     const AccumulatorOf<Ops>* filter, size_t filter_size,
+                     SampleOf<Ops>* data, size_t data_size) {
+  if constexpr (FixedSize != 0) {
+    filter_size = FixedSize;
+  }
+  const size_t even_taps = (filter_size + 1) / 2;
+  const size_t odd_taps = filter_size / 2;
+  size_t n = 0;
+
+  // Even and odd outputs each form an ordinary convolution of coeffs with
+  // half of the filter taps. Compute Width of each and interleave them.
+  for (; n + 2 * Ops::Width <= data_size; n += 2 * Ops::Width) {
+    const SampleOf<Ops>* window = coeffs + n / 2;
+    auto even = Ops::Zero();
+    auto odd = Ops::Zero();
+
+    for (size_t t = 0; t < even_taps; t++) {
+      even = Ops::MultiplyAdd(Ops::Load(window + t),
+                              Ops::Broadcast(filter[filter_size - 2 * t - 1]),
+                              even);
+    }
+
+    for (size_t t = 0; t < odd_taps; t++) {
+      odd = Ops::MultiplyAdd(Ops::Load(window + t + 1),
+                             Ops::Broadcast(filter[filter_size - 2 * t - 2]),
+                             odd);
+    }
+
+    Ops::StoreInterleaved(data + n, even, odd);
+  }
+
+  for (; n < data_size; n++) {
+    const size_t phase = n % 2;
+    const SampleOf<Ops>* window = coeffs + n / 2 + phase;
+    AccumulatorOf<Ops> val = 0;
+
+    for (size_t j = phase; j < filter_size; j += 2) {
+      val = Ops::MultiplyAdd(*window++, filter[filter_size - j - 1], val);
+    }
+
+    data[n] = static_cast<SampleOf<Ops>>(val);
+  }
+}
+
+// The channel kernels put the vector lanes across channels, the taps of
+// every output are accumulated in the same order as in the single channel
+// bodies. Blocks of BlockWidth vectors are computed together so the
+// accumulations of several vectors are in flight at once.
+
+template <class Ops, size_t Blocks>
+void DecimateChannelsBlock(const SampleOf<Ops>* window,
+                           const AccumulatorOf<Ops>* lowpass,
+                           const AccumulatorOf<Ops>* highpass,
+                           size_t filter_size, SampleOf<Ops>* approx,
+                           SampleOf<Ops>* details, size_t channel_count) {
+  typename Ops::Vector low[Blocks];
+  typename Ops::Vector high[Blocks];
+
+  for (size_t b = 0; b < Blocks; b++) {
+    low[b] = Ops::Zero();
+    high[b] = Ops::Zero();
+  }
+
+  for (size_t j = 0; j < filter_size; j++) {
+    const auto low_tap = Ops::Broadcast(lowpass[filter_size - j - 1]);
+    const auto high_tap = Ops::Broadcast(highpass[filter_size - j - 1]);
+    const SampleOf<Ops>* row = window + j * channel_count;
+
+    for (size_t b = 0; b < Blocks; b++) {
+      const auto x = Ops::Load(row + b * Ops::Width);
+      low[b] = Ops::MultiplyAdd(x, low_tap, low[b]);
+      high[b] = Ops::MultiplyAdd(x, high_tap, high[b]);
+    }
+  }
+
+  for (size_t b = 0; b < Blocks; b++) {
+    Ops::Store(approx + b * Ops::Width, low[b]);
+    Ops::Store(details + b * Ops::Width, high[b]);
+  }
+}
+
+template <class Ops>
+void DecimateChannels(const SampleOf<Ops>* data,
+                      const AccumulatorOf<Ops>* lowpass,
+                      const AccumulatorOf<Ops>* highpass, size_t filter_size,
+                      SampleOf<Ops>* approx, SampleOf<Ops>* details,
+                      size_t output_size, size_t channel_count) {
+  constexpr size_t BlockWidth = 4;
+
+  for (size_t m = 0; m < output_size; m++) {
+    const SampleOf<Ops>* window = data + 2 * m * channel_count;
+    SampleOf<Ops>* low_out = approx + m * channel_count;
+    SampleOf<Ops>* high_out = details + m * channel_count;
+    size_t c = 0;
+
+    for (; c + BlockWidth * Ops::Width <= channel_count;
+         c += BlockWidth * Ops::Width) {
+      DecimateChannelsBlock<Ops, BlockWidth>(window + c, lowpass, highpass,
+                                             filter_size, low_out + c,
+                                             high_out + c, channel_count);
+    }
+
+    for (; c + Ops::Width <= channel_count; c += Ops::Width) {
+      DecimateChannelsBlock<Ops, 1>(window + c, lowpass, highpass,
+                                    filter_size, low_out + c, high_out + c,
+                                    channel_count);
+    }
+
+    for (; c < channel_count; c++) {
+      AccumulatorOf<Ops> low = 0;
+      AccumulatorOf<Ops> high = 0;
+
+      for (size_t j = 0; j < filter_size; j++) {
+        const SampleOf<Ops> x = window[j * channel_count + c];
+        low = Ops::MultiplyAdd(x, lowpass[filter_size - j - 1], low);
+        high = Ops::MultiplyAdd(x, highpass[filter_size - j - 1], high);
+      }
+
+      low_out[c] = static_cast<SampleOf<Ops>>(low);
+      high_out[c] = static_cast<SampleOf<Ops>>(high);
+    }
+  }
+}
+
+template <class Ops, size_t Blocks>
+void ReconstructChannelsBlock(const SampleOf<Ops>* window,
+                              const AccumulatorOf<Ops>* filter,
+                              size_t filter_size, size_t phase,
+                              SampleOf<Ops>* data, size_t channel_count) {
+  typename Ops::Vector val[Blocks];
+
+  for (size_t b = 0; b < Blocks; b++) {
+    val[b] = Ops::Zero();
+  }
+
+  for (size_t j = phase; j < filter_size; j += 2) {
+    const auto tap = Ops::Broadcast(filter[filter_size - j - 1]);
+
+    for (size_t b = 0; b < Blocks; b++) {
+      val[b] = Ops::MultiplyAdd(Ops::Load(window + b * Ops::Width), tap,
+                                val[b]);
+    }
+    window += channel_count;
+  }
+
+  for (size_t b = 0; b < Blocks; b++) {
+    Ops::Store(data + b * Ops::Width, val[b]);
+  }
+}
+
+template <class Ops>
+void ReconstructChannels(const SampleOf<Ops>* coeffs,
+                         const AccumulatorOf<Ops>* filter, size_t filter_size,
+                         SampleOf<Ops>* data, size_t data_size,
+                         size_t channel_count) {
+  constexpr size_t BlockWidth = 8;
+
+  for (size_t n = 0; n < data_size; n++) {
+    const size_t phase = n % 2;
+    const SampleOf<Ops>* window = coeffs + (n / 2 + phase) * channel_count;
+    SampleOf<Ops>* out = data + n * channel_count;
+    size_t c = 0;
+
+    for (; c + BlockWidth * Ops::Width <= channel_count;
+         c += BlockWidth * Ops::Width) {
+      ReconstructChannelsBlock<Ops, BlockWidth>(
+          window + c, filter, filter_size, phase, out + c, channel_count);
+    }
+
+    for (; c + Ops::Width <= channel_count; c += Ops::Width) {
+      ReconstructChannelsBlock<Ops, 1>(window + c, filter, filter_size, phase,
+                                       out + c, channel_count);
+    }
+
+    for (; c < channel_count; c++) {
+      const SampleOf<Ops>* row = window + c;
+      AccumulatorOf<Ops> val = 0;
+
+      for (size_t j = phase; j < filter_size; j += 2) {
+        val = Ops::MultiplyAdd(*row, filter[filter_size - j - 1], val);
+        row += channel_count;
+      }
+
+      out[c] = static_cast<SampleOf<Ops>>(val);
+    }
+  }
+}
+
+template <class Ops>
+void Lift(const SampleOf<Ops>* source, const AccumulatorOf<Ops>* coeffs,
+          size_t coeffs_size, SampleOf<Ops>* target, size_t target_size) {
+  size_t m = 0;
+
+  for (; m + Ops::Width <= target_size; m += Ops::Width) {
+    auto val = Ops::Load(target + m);
+
+    for (size_t j = 0; j < coeffs_size; j++) {
+      val = Ops::MultiplyAdd(Ops::Load(source + m + j),
+                             Ops::Broadcast(coeffs[coeffs_size - j - 1]), val);
+    }
+
+    Ops::Store(target + m, val);
+  }
+
+  for (; m < target_size; m++) {
+    AccumulatorOf<Ops> val = target[m];
+
+    for (size_t j = 0; j < coeffs_size; j++) {
+      val = Ops::MultiplyAdd(source[m + j], coeffs[coeffs_size - j - 1], val);
+    }
+
+    target[m] = static_cast<SampleOf<Ops>>(val);
+  }
+}
+
+template <class Ops>
+void SoftThreshold(const SampleOf<Ops>* data, AccumulatorOf<Ops> threshold,
+                   SampleOf<Ops>* result, size_t size) {
+  using Accumulator = AccumulatorOf<Ops>;
+  const auto upper = Ops::Broadcast(threshold);
+  const auto lower = Ops::Broadcast(-threshold);
+  size_t i = 0;
+
+  // Clamping to the threshold and subtracting the clamped value shrinks
+  // each value toward zero without a branch.
+  for (; i + Ops::Width <= size; i += Ops::Width) {
+    const auto val = Ops::Load(data + i);
+    Ops::Store(result + i,
+               Ops::Subtract(val, Ops::Min(Ops::Max(val, lower), upper)));
+  }
+
+  for (; i < size; i++) {
+    const Accumulator val = data[i];
+    const Accumulator clamped =
+        val < -threshold ? -threshold : (val > threshold ? threshold : val);
+    result[i] = static_cast<SampleOf<Ops>>(val - clamped);
+  }
+}
+
+template <class Ops>
+void HardThreshold(const SampleOf<Ops>* data, AccumulatorOf<Ops> threshold,
+                   SampleOf<Ops>* result, size_t size) {
+  using Accumulator = AccumulatorOf<Ops>;
+  const auto limit = Ops::Broadcast(threshold);
+  size_t i = 0;
+
+  for (; i + Ops::Width <= size; i += Ops::Width) {
+    const auto val = Ops::Load(data + i);
+    Ops::Store(result + i, Ops::KeepGreater(Ops::Abs(val), limit, val));
+  }
+
+  for (; i < size; i++) {
+    const Accumulator val = data[i];
+    const Accumulator magnitude = val < 0 ? -val : val;
+    result[i] = static_cast<SampleOf<Ops>>(magnitude > threshold ? val : 0);
+  }
+}
+
+// Call the body specialized for filter_size if there is one, otherwise the
+// generic body.
+
+template <class Ops, size_t... Sizes>
+void Convolve(const SampleOf<Ops>* data, const AccumulatorOf<Ops>* coeffs,
+              size_t coeffs_size, SampleOf<Ops>* result, size_t result_size,
+              FilterSizeList<Sizes...> /*unused*/) {
+  const bool fixed =
+      ((coeffs_size == Sizes &&
+        (ConvolveBody<Ops, Sizes>(data, coeffs, coeffs_size, result,
+                                  result_size),
+         true)) ||
+       ...);
+  if (!fixed) {
+    ConvolveBody<Ops, 0>(data, coeffs, coeffs_size, result, result_size);
+  }
+}
+
+template <class Ops, size_t... Sizes>
+void Decimate(const SampleOf<Ops>* data, const AccumulatorOf<Ops>* lowpass,
+              const AccumulatorOf<Ops>* highpass, size_t filter_size,
+              SampleOf<Ops>* approx, SampleOf<Ops>* details, size_t output_size,
+              FilterSizeList<Sizes...> /*unused*/) {
+  const bool fixed =
+      ((filter_size == Sizes && Sizes <= Ops::MaxUnrolledDecimateSize &&
+        (DecimateBody<Ops, Sizes>(data, lowpass, highpass, filter_size,
+                                  approx, details, output_size),
+         true)) ||
+       ...);
+  if (!fixed) {
+    DecimateBody<Ops, 0>(data, lowpass, highpass, filter_size, approx,
+                         details, output_size);
+  }
+}
+
+template <class Ops, size_t... Sizes>
+void DecimateDualPhase(const SampleOf<Ops>* data,
+                       const AccumulatorOf<Ops>* lowpass,
+                       const AccumulatorOf<Ops>* highpass, size_t filter_size,
+                       SampleOf<Ops>* even_approx, SampleOf<Ops>* even_details,
+                       SampleOf<Ops>* odd_approx, SampleOf<Ops>* odd_details,
+                       size_t output_size,
+                       FilterSizeList<Sizes...> /*unused*/) {
+  const bool fixed =
+      ((filter_size == Sizes && Sizes <= Ops::MaxUnrolledDecimateSize &&
+        (DecimateDualPhaseBody<Ops, Sizes>(
+             data, lowpass, highpass, filter_size, even_approx, even_details,
+             odd_approx, odd_details, output_size),
+         true)) ||
+       ...);
+  if (!fixed) {
+    DecimateDualPhaseBody<Ops, 0>(data, lowpass, highpass, filter_size,
+                                  even_approx, even_details, odd_approx,
+                                  odd_details, output_size);
+  }
+}
+
+template <class Ops, size_t... Sizes>
+void Reconstruct(const SampleOf<Ops>* coeffs, const AccumulatorOf<Ops>* filter,
+                 size_t filter_size, SampleOf<Ops>* data, size_t data_size,
+                 FilterSizeList<Sizes...> /*unused*/) {
+  const bool fixed =
+      ((filter_size == Sizes &&
+        (ReconstructBody<Ops, Sizes>(coeffs, filter, filter_size, data,
+                                     data_size),
+         true)) ||
+       ...);
+  if (!fixed) {
+    ReconstructBody<Ops, 0>(coeffs, filter, filter_size, data, data_size);
+  }
+}
+
+// The kernel entry points stored in BasicWaveletKernels.
+
+template <class Ops>
+void Convolve(const SampleOf<Ops>* data, const AccumulatorOf<Ops>* coeffs,
+              size_t coeffs_size, SampleOf<Ops>* result, size_t result_size) {
+  Convolve<Ops>(data, coeffs, coeffs_size, result, result_size,
+                BuiltInFilterSizes());
+}
+
+template <class Ops>
+void Decimate(const SampleOf<Ops>* data, const AccumulatorOf<Ops>* lowpass,
+              const AccumulatorOf<Ops>* highpass, size_t filter_size,
+              SampleOf<Ops>* approx, SampleOf<Ops>* details,
+              size_t output_size) {
+  Decimate<Ops>(data, lowpass, highpass, filter_size, approx, details,
+                output_size, BuiltInFilterSizes());
+}
+
+template <class Ops>
+void DecimateDualPhase(const SampleOf<Ops>* data,
+                       const AccumulatorOf<Ops>* lowpass,
+                       const AccumulatorOf<Ops>* highpass, size_t filter_size,
+                       SampleOf<Ops>* even_approx, SampleOf<Ops>* even_details,
+                       SampleOf<Ops>* odd_approx, SampleOf<Ops>* odd_details,
+                       size_t output_size) {
+  DecimateDualPhase<Ops>(data, lowpass, highpass, filter_size, even_approx,
+                         even_details, odd_approx, odd_details, output_size,
+                         BuiltInFilterSizes());
+}
+
+template <class Ops>
+void Reconstruct(const SampleOf<Ops>* coeffs, const AccumulatorOf<Ops>* filter,
+                 size_t filter_size, SampleOf<Ops>* data, size_t data_size) {
+  Reconstruct<Ops>(coeffs, filter, filter_size, data, data_size,
+                   BuiltInFilterSizes());
+}
+
+/**
+ * Build the table of kernel entry points for |Ops|.
+ */
+template <class Ops>
+constexpr BasicWaveletKernels<SampleOf<Ops>, AccumulatorOf<Ops>>
+MakeWaveletKernels(KernelIsa isa) {
+  return {&Convolve<Ops>,
+          &Decimate<Ops>,
+          &DecimateDualPhase<Ops>,
+          &Reconstruct<Ops>,
+          &DecimateChannels<Ops>,
+          &ReconstructChannels<Ops>,
+          &Lift<Ops>,
+          &SoftThreshold<Ops>,
+          &HardThreshold<Ops>,
+          isa};
+}
+
+}  // namespace kernels
+
+}  // namespace panwave
+
+#endif  // WAVELETKERNELSIMPL_H
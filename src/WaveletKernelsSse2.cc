@@ -0,0 +1,172 @@
+//-------------------------------------------------------------------------------------------------------
+// Copyright (C) Taylor Woll and panwave contributors. All rights reserved.
+// Licensed under the MIT license. See LICENSE.txt file in the project root for
+// full license information.
+//-------------------------------------------------------------------------------------------------------
+
+#include "WaveletKernelsImpl.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+
+#include <emmintrin.h>
+
+namespace {
+
+using panwave::KernelIsa;
+using panwave::WaveletKernelSet;
+using panwave::kernels::MakeWaveletKernels;
+
+struct Sse2DoubleOps {
+  using Sample = double;
+  using Accumulator = double;
+  using Vector = __m128d;
+  static constexpr size_t Width = 2;
+  static constexpr size_t MaxUnrolledDecimateSize = 8;
+
+  static Vector Zero() { return _mm_setzero_pd(); }
+  static Vector Broadcast(double x) { return _mm_set1_pd(x); }
+  static Vector Load(const double* p) { return _mm_loadu_pd(p); }
+  static void Store(double* p, Vector v) { _mm_storeu_pd(p, v); }
+  static Vector MultiplyAdd(Vector a, Vector b, Vector acc) {
+    return _mm_add_pd(acc, _mm_mul_pd(a, b));
+  }
+  static double MultiplyAdd(double a, double b, double acc) {
+    return acc + a * b;
+  }
+  static Vector Min(Vector a, Vector b) { return _mm_min_pd(a, b); }
+  static Vector Max(Vector a, Vector b) { return _mm_max_pd(a, b); }
+  static Vector Subtract(Vector a, Vector b) { return _mm_sub_pd(a, b); }
+  static Vector Abs(Vector v) {
+    return _mm_andnot_pd(_mm_set1_pd(-0.0), v);
+  }
+  static Vector KeepGreater(Vector a, Vector b, Vector v) {
+    return _mm_and_pd(_mm_cmpgt_pd(a, b), v);
+  }
+  static void LoadDeinterleaved(const double* p, Vector* even, Vector* odd) {
+    const Vector lo = _mm_loadu_pd(p);
+    const Vector hi = _mm_loadu_pd(p + Width);
+    *even = _mm_unpacklo_pd(lo, hi);
+    *odd = _mm_unpackhi_pd(lo, hi);
+  }
+  static void StoreInterleaved(double* p, Vector even, Vector odd) {
+    _mm_storeu_pd(p, _mm_unpacklo_pd(even, odd));
+    _mm_storeu_pd(p + Width, _mm_unpackhi_pd(even, odd));
+  }
+};
+
+struct Sse2FloatOps {
+  using Sample = float;
+  using Accumulator = float;
+  using Vector = __m128;
+  static constexpr size_t Width = 4;
+  static constexpr size_t MaxUnrolledDecimateSize = 8;
+
+  static Vector Zero() { return _mm_setzero_ps(); }
+  static Vector Broadcast(float x) { return _mm_set1_ps(x); }
+  static Vector Load(const float* p) { return _mm_loadu_ps(p); }
+  static void Store(float* p, Vector v) { _mm_storeu_ps(p, v); }
+  static Vector MultiplyAdd(Vector a, Vector b, Vector acc) {
+    return _mm_add_ps(acc, _mm_mul_ps(a, b));
+  }
+  static float MultiplyAdd(float a, float b, float acc) {
+    return acc + a * b;
+  }
+  static Vector Min(Vector a, Vector b) { return _mm_min_ps(a, b); }
+  static Vector Max(Vector a, Vector b) { return _mm_max_ps(a, b); }
+  static Vector Subtract(Vector a, Vector b) { return _mm_sub_ps(a, b); }
+  static Vector Abs(Vector v) {
+    return _mm_andnot_ps(_mm_set1_ps(-0.0F), v);
+  }
+  static Vector KeepGreater(Vector a, Vector b, Vector v) {
+    return _mm_and_ps(_mm_cmpgt_ps(a, b), v);
+  }
+  static void LoadDeinterleaved(const float* p, Vector* even, Vector* odd) {
+    const Vector lo = _mm_loadu_ps(p);
+    const Vector hi = _mm_loadu_ps(p + Width);
+    constexpr int EvenLanes = _MM_SHUFFLE(2, 0, 2, 0);
+    constexpr int OddLanes = _MM_SHUFFLE(3, 1, 3, 1);
+    *even = _mm_shuffle_ps(lo, hi, EvenLanes);
+    *odd = _mm_shuffle_ps(lo, hi, OddLanes);
+  }
+  static void StoreInterleaved(float* p, Vector even, Vector odd) {
+    _mm_storeu_ps(p, _mm_unpacklo_ps(even, odd));
+    _mm_storeu_ps(p + Width, _mm_unpackhi_ps(even, odd));
+  }
+};
+
+// Float samples accumulated in double. Each vector holds two samples
+// converted to double.
+struct Sse2FloatDoubleOps {
+  using Sample = float;
+  using Accumulator = double;
+  using Vector = __m128d;
+  static constexpr size_t Width = 2;
+  static constexpr size_t MaxUnrolledDecimateSize = 8;
+
+  static Vector Zero() { return _mm_setzero_pd(); }
+  static Vector Broadcast(double x) { return _mm_set1_pd(x); }
+  static Vector Load(const float* p) {
+    return _mm_cvtps_pd(_mm_castsi128_ps(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p))));
+  }
+  static void Store(float* p, Vector v) {
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(p),
+                     _mm_castps_si128(_mm_cvtpd_ps(v)));
+  }
+  static Vector MultiplyAdd(Vector a, Vector b, Vector acc) {
+    return _mm_add_pd(acc, _mm_mul_pd(a, b));
+  }
+  static double MultiplyAdd(double a, double b, double acc) {
+    return acc + a * b;
+  }
+  static Vector Min(Vector a, Vector b) { return _mm_min_pd(a, b); }
+  static Vector Max(Vector a, Vector b) { return _mm_max_pd(a, b); }
+  static Vector Subtract(Vector a, Vector b) { return _mm_sub_pd(a, b); }
+  static Vector Abs(Vector v) {
+    return _mm_andnot_pd(_mm_set1_pd(-0.0), v);
+  }
+  static Vector KeepGreater(Vector a, Vector b, Vector v) {
+    return _mm_and_pd(_mm_cmpgt_pd(a, b), v);
+  }
+  static void LoadDeinterleaved(const float* p, Vector* even, Vector* odd) {
+    const __m128 values = _mm_loadu_ps(p);
+    constexpr int EvenLanes = _MM_SHUFFLE(2, 0, 2, 0);
+    constexpr int OddLanes = _MM_SHUFFLE(3, 1, 3, 1);
+    *even = _mm_cvtps_pd(_mm_shuffle_ps(values, values, EvenLanes));
+    *odd = _mm_cvtps_pd(_mm_shuffle_ps(values, values, OddLanes));
+  }
+  static void StoreInterleaved(float* p, Vector even, Vector odd) {
+    const __m128 lo = _mm_cvtpd_ps(_mm_unpacklo_pd(even, odd));
+    const __m128 hi = _mm_cvtpd_ps(_mm_unpackhi_pd(even, odd));
+    _mm_storeu_ps(p, _mm_movelh_ps(lo, hi));
+  }
+};
+
+constexpr auto sse2DoubleKernels =
+    MakeWaveletKernels<Sse2DoubleOps>(KernelIsa::Sse2);
+constexpr auto sse2FloatKernels =
+    MakeWaveletKernels<Sse2FloatOps>(KernelIsa::Sse2);
+constexpr auto sse2FloatDoubleKernels =
+    MakeWaveletKernels<Sse2FloatDoubleOps>(KernelIsa::Sse2);
+
+constexpr WaveletKernelSet sse2Kernels = {
+    &sse2DoubleKernels, &sse2FloatKernels, &sse2FloatDoubleKernels};
+
+}  // namespace
+
+namespace panwave {
+
+const WaveletKernelSet* GetSse2WaveletKernels() { return &sse2Kernels; }
+
+}  // namespace panwave
+
+#else
+
+namespace panwave {
+
+const WaveletKernelSet* GetSse2WaveletKernels() { return nullptr; }
+
+}  // namespace panwave
+
+#endif
@@ -8,9 +8,349 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstddef>
+#include <functional>
+
+#include "Instrumentation.h"
+#include "LiftingScheme.h"
+#include "WaveletKernels.h"
+
+namespace {
+
+using panwave::DyadicMode;
+using panwave::PaddingMode;
+using panwave::Span;
+
+/**
+ * Return the number of elements DyadicDownsample produces from a signal of
+ * length |size| in |dyadic_mode|.
+ */
+size_t DownsampledSize(size_t size, DyadicMode dyadic_mode) {
+  return dyadic_mode == DyadicMode::Even ? (size + 1) / 2 : size / 2;
+}
+
+/**
+ * Return the number of elements DyadicUpsample produces from a signal of
+ * length |size| in |dyadic_mode|.<br/>
+ * Periodic padding repeats the upsampled coefficients every 2 * size
+ * elements instead, which drops the zero DyadicUpsample inserts after the
+ * last even mode coefficient and adds one after the last odd mode one.
+ */
+size_t UpsampledSize(size_t size, DyadicMode dyadic_mode,
+                     PaddingMode padding_mode) {
+  if (padding_mode == PaddingMode::Periodic) {
+    return size * 2;
+  }
+  return dyadic_mode == DyadicMode::Even ? size * 2 + 1 : size * 2 - 1;
+}
+
+/**
+ * Map |index| of a signal of |data_size| elements as it would appear after
+ * extending the signal via WaveletMath::Pad back to the element of the
+ * signal it holds. Negative indices refer to the left padding and indices
+ * beyond the end of the signal refer to the right padding.
+ * @return The index of the element in the signal or -1 if |index| holds a
+ * padded zero.
+ */
+ptrdiff_t PaddedIndex(size_t data_size, ptrdiff_t index,
+                      PaddingMode padding_mode) {
+  const auto size = static_cast<ptrdiff_t>(data_size);
+
+  if (index < 0 || index >= size) {
+    if (padding_mode == PaddingMode::Zeroes) {
+      return -1;
+    }
+
+    // Periodic padding repeats the signal. A signal of odd length is first
+    // extended by its last element so each period is of even length.
+    if (padding_mode == PaddingMode::Periodic) {
+      const ptrdiff_t period = size + size % 2;
+      index %= period;
+      if (index < 0) {
+        index += period;
+      }
+      return std::min(index, size - 1);
+    }
+
+    assert(padding_mode == PaddingMode::Symmetric);
+
+    // Symmetric padding mirrors the signal around its first and last
+    // elements. Mirrored indices which overflow the signal clamp to the far
+    // end element.
+    index = index < 0 ? std::min(-index, size - 1)
+                      : std::max(2 * size - 2 - index, ptrdiff_t{0});
+  }
+
+  return index;
+}
+
+/**
+ * Return the element at |index| of a signal of |data_size| elements as it
+ * would appear after extending the signal via WaveletMath::Pad. Only the
+ * part of the signal in |window|, which begins at element |window_begin|,
+ * is available.
+ * @see PaddedIndex
+ */
+template <class Sample>
+Sample PaddedSample(Span<const Sample> window, size_t window_begin,
+                    size_t data_size, ptrdiff_t index,
+                    PaddingMode padding_mode) {
+  index = PaddedIndex(data_size, index, padding_mode);
+  if (index < 0) {
+    return Sample{0};
+  }
+
+  const auto offset = static_cast<size_t>(index) - window_begin;
+  assert(static_cast<size_t>(index) >= window_begin && offset < window.size());
+  return window[offset];
+}
+
+/**
+ * Return the element at |index| of data as it would appear after extending
+ * data via WaveletMath::Pad.
+ */
+template <class Sample>
+Sample PaddedSample(Span<const Sample> data, ptrdiff_t index,
+                    PaddingMode padding_mode) {
+  return PaddedSample(data, 0, data.size(), index, padding_mode);
+}
+
+/**
+ * Map |index| of coefficients as they would appear after upsampling
+ * |coeffs_size| coefficients via WaveletMath::DyadicUpsample and then
+ * extending the upsampled coefficients via WaveletMath::Pad back to the
+ * coefficient it holds. The upsampled coefficients are never built.
+ * @return The index of the coefficient or -1 if |index| holds an inserted
+ * or padded zero.
+ */
+ptrdiff_t UpsampledIndex(size_t coeffs_size, ptrdiff_t index,
+                         DyadicMode dyadic_mode, PaddingMode padding_mode) {
+  // Mirror or wrap the index back into the upsampled coefficients the same
+  // way PaddedSample does.
+  index = PaddedIndex(UpsampledSize(coeffs_size, dyadic_mode, padding_mode),
+                      index, padding_mode);
+  if (index < 0) {
+    return -1;
+  }
+
+  const ptrdiff_t value_parity = dyadic_mode == DyadicMode::Even ? 1 : 0;
+  if (index % 2 != value_parity) {
+    return -1;
+  }
+
+  return (index - value_parity) / 2;
+}
+
+/**
+ * Find the element at |index| of coeffs as it would appear after upsampling
+ * and padding coeffs, see UpsampledIndex.
+ * @return False if the element is an inserted or padded zero. Otherwise
+ * true with the element stored in |value|.
+ */
+template <class Sample>
+bool UpsampledSample(Span<const Sample> coeffs, ptrdiff_t index,
+                     DyadicMode dyadic_mode, PaddingMode padding_mode,
+                     Sample* value) {
+  index = UpsampledIndex(coeffs.size(), index, dyadic_mode, padding_mode);
+  if (index < 0) {
+    return false;
+  }
+
+  *value = coeffs[static_cast<size_t>(index)];
+  return true;
+}
+
+/**
+ * The number of channels the boundary outputs of the channel transforms
+ * accumulate together.
+ */
+constexpr size_t ChannelBlockSize = 64;
+
+/**
+ * The number of outputs the undecimated transforms accumulate together.
+ */
+constexpr size_t UndecimatedBlockSize = 256;
+
+/**
+ * The number of outputs the undecimated transforms keep in registers while
+ * running through the filter taps.
+ */
+constexpr size_t UndecimatedLaneCount = 8;
+
+/**
+ * Add |weight| times count consecutive samples of the periodic signal
+ * |data|, starting at index |first|, to |sums|.
+ */
+template <class Sample, class Accumulator>
+void AccumulatePeriodic(Span<const Sample> data, size_t first,
+                        Accumulator weight, Accumulator* sums, size_t count) {
+  // Each run up to the end of data is contiguous and vectorizes.
+  for (size_t i = 0; i < count; first = 0) {
+    const size_t run = std::min(count - i, data.size() - first);
+    const Sample* samples = data.data() + first;
+    for (size_t r = 0; r < run; r++) {
+      sums[i + r] += weight * static_cast<Accumulator>(samples[r]);
+    }
+    i += run;
+  }
+}
+
+/**
+ * Filter |count| outputs whose dilated filter windows lie inside the
+ * signal. Output i is the sum over j, in order, of filters[f][j] times
+ * newest[i - j * dilation], for each of the |FilterCount| filters.<br/>
+ * A few outputs at a time are kept in registers, so each sample is loaded
+ * once per tap for every filter.
+ */
+template <size_t FilterCount, class Sample, class Accumulator>
+void FilterDilated(const Sample* newest,
+                   const Accumulator* const (&filters)[FilterCount],
+                   size_t filter_size, size_t dilation,
+                   Sample* const (&outputs)[FilterCount], size_t count,
+                   Accumulator scale) {
+  size_t i = 0;
+  for (; i + UndecimatedLaneCount <= count; i += UndecimatedLaneCount) {
+    Accumulator sums[FilterCount][UndecimatedLaneCount] = {};
+    const Sample* samples = newest + i;
+    for (size_t j = 0; j < filter_size; j++, samples -= dilation) {
+      for (size_t f = 0; f < FilterCount; f++) {
+        for (size_t r = 0; r < UndecimatedLaneCount; r++) {
+          sums[f][r] += filters[f][j] * static_cast<Accumulator>(samples[r]);
+        }
+      }
+    }
+    for (size_t f = 0; f < FilterCount; f++) {
+      for (size_t r = 0; r < UndecimatedLaneCount; r++) {
+        outputs[f][i + r] = static_cast<Sample>(sums[f][r] * scale);
+      }
+    }
+  }
+
+  for (; i < count; i++) {
+    for (size_t f = 0; f < FilterCount; f++) {
+      Accumulator sum = 0;
+      const Sample* samples = newest + i;
+      for (size_t j = 0; j < filter_size; j++, samples -= dilation) {
+        sum += filters[f][j] * static_cast<Accumulator>(*samples);
+      }
+      outputs[f][i] = static_cast<Sample>(sum * scale);
+    }
+  }
+}
+
+using IndexRange = panwave::WaveletWorkspace::IndexRange;
+
+/**
+ * The values of one lifting stream over a range of indices. The values are
+ * owned by a WaveletWorkspace.
+ */
+struct LiftingStream {
+  ptrdiff_t begin = 0;
+  double* values = nullptr;
+
+  double* At(ptrdiff_t index) { return this->values + (index - this->begin); }
+};
+
+/**
+ * Size the buffer of a lifting stream to hold the indices in |range| and
+ * point |stream| at it.
+ */
+void BindLiftingStream(const IndexRange& range, std::vector<double>* buffer,
+                       LiftingStream* stream) {
+  buffer->resize(
+      static_cast<size_t>(std::max(range.end - range.begin, ptrdiff_t{0})));
+  stream->begin = range.begin;
+  stream->values = buffer->data();
+}
+
+ptrdiff_t FloorHalf(ptrdiff_t x) { return x >= 0 ? x / 2 : -((1 - x) / 2); }
+
+/**
+ * Grow |range| to also cover |other|.
+ */
+void IncludeRange(IndexRange* range, const IndexRange& other) {
+  if (other.IsEmpty()) {
+    return;
+  }
+  if (range->IsEmpty()) {
+    *range = other;
+    return;
+  }
+  range->begin = std::min(range->begin, other.begin);
+  range->end = std::max(range->end, other.end);
+}
+
+/**
+ * Find which indices each lifting step has to update and which indices of
+ * each stream have to be filled before the first step.<br/>
+ * On input |ranges| holds the indices of each stream needed after the last
+ * step. On output it holds the indices needed before the first one.
+ * |updates| receives the indices each step updates, unless it is nullptr.
+ */
+void PlanLifting(const std::vector<panwave::LiftingScheme::Step>& steps,
+                 IndexRange ranges[2], std::vector<IndexRange>* updates) {
+  if (updates != nullptr) {
+    updates->resize(steps.size());
+  }
+
+  // Walk the steps from the last one to the first.
+  for (size_t index = steps.size(); index-- > 0;) {
+    const auto& step = steps[index];
+    const IndexRange update = ranges[step.target];
+
+    if (updates != nullptr) {
+      updates->operator[](index) = update;
+    }
+    if (update.IsEmpty()) {
+      continue;
+    }
+
+    IncludeRange(&ranges[1 - step.target],
+                 {update.begin - step.delay -
+                      static_cast<ptrdiff_t>(step.coeffs.size() - 1),
+                  update.end - step.delay});
+  }
+}
+
+/**
+ * Run one lifting step over the indices in |update|.
+ */
+void ApplyLiftingStep(const panwave::LiftingScheme::Step& step,
+                      const IndexRange& update, LiftingStream streams[2]) {
+  if (update.IsEmpty()) {
+    return;
+  }
+
+  const auto taps = static_cast<ptrdiff_t>(step.coeffs.size());
+  const double* source = streams[1 - step.target].At(
+      update.begin - step.delay - (taps - 1));
+
+  panwave::GetWaveletKernels().lift(
+      source, step.coeffs.data(), step.coeffs.size(),
+      streams[step.target].At(update.begin),
+      static_cast<size_t>(update.end - update.begin));
+}
+
+}  // namespace
 
 namespace panwave {
 
+WaveletWorkspace::WaveletWorkspace(size_t signal_size, size_t filter_size) {
+  this->Reserve(signal_size, filter_size);
+}
+
+void WaveletWorkspace::Reserve(size_t signal_size, size_t filter_size) {
+  // Each lifting stream holds one sample per output coefficient, or per
+  // pair of reconstructed samples, plus the samples the lifting steps read
+  // beyond either end. The steps of an L tap filter read fewer than L extra
+  // samples in total.
+  const size_t stream_size = (signal_size + filter_size) / 2 + filter_size;
+  for (auto& stream : this->lifting_streams_) {
+    stream.reserve(stream_size);
+  }
+  this->lifting_updates_.reserve(filter_size + 1);
+}
+
 void WaveletMath::Pad(const std::vector<double>& data,
                       std::vector<double>* extended_data, size_t pad_left,
                       size_t pad_right, PaddingMode padding_mode) {
@@ -45,6 +385,17 @@ void WaveletMath::Pad(const std::vector<double>& data,
          i--) {
       extended_data->operator[](index--) = data[data.size() - 1 - i];
     }
+  } else if (padding_mode == PaddingMode::Periodic) {
+    // The padding may wrap around data several times.
+    const auto left = static_cast<ptrdiff_t>(pad_left);
+    for (size_t i = 0; i < pad_left; i++) {
+      extended_data->operator[](i) = data[static_cast<size_t>(PaddedIndex(
+          data.size(), static_cast<ptrdiff_t>(i) - left, padding_mode))];
+    }
+    for (size_t i = pad_left + data.size(); i < extended_data->size(); i++) {
+      extended_data->operator[](i) = data[static_cast<size_t>(PaddedIndex(
+          data.size(), static_cast<ptrdiff_t>(i) - left, padding_mode))];
+    }
   } else {
     // If padding_mode is PaddingMode::Zeroes we have nothing to do.
     // The default value for double is 0.
@@ -60,16 +411,12 @@ void WaveletMath::Convolve(const std::vector<double>& data,
   assert(!coeffs.empty());
 
   result->resize(data.size() - (coeffs.size() - 1));
+  const PrimitiveTimer timer(Primitive::Convolve, coeffs.size(),
+                             data.size() * sizeof(double),
+                             result->size() * sizeof(double));
 
-  for (size_t i = 0; i < result->size(); i++) {
-    double val = 0.0;
-
-    for (size_t j = 0; j < coeffs.size(); j++) {
-      val += data[i + j] * coeffs[coeffs.size() - j - 1];
-    }
-
-    result->operator[](i) = val;
-  }
+  GetWaveletKernels().convolve(data.data(), coeffs.data(), coeffs.size(),
+                               result->data(), result->size());
 }
 
 void WaveletMath::DyadicDownsample(const std::vector<double>& data,
@@ -104,6 +451,196 @@ void WaveletMath::DyadicUpsample(const std::vector<double>& data,
   }
 }
 
+size_t WaveletMath::GetDecomposedSize(size_t data_size, size_t filter_size,
+                                      DyadicMode dyadic_mode,
+                                      PaddingMode padding_mode) {
+  // A periodic signal is decomposed over one period, which is of even
+  // length.
+  if (padding_mode == PaddingMode::Periodic) {
+    return (data_size + 1) / 2;
+  }
+  return DownsampledSize(data_size + filter_size - 1, dyadic_mode);
+}
+
+void WaveletMath::GetDecomposedRange(size_t data_size, size_t begin,
+                                     size_t end, size_t filter_size,
+                                     DyadicMode dyadic_mode,
+                                     PaddingMode padding_mode,
+                                     size_t* output_begin,
+                                     size_t* output_end) {
+  assert(output_begin);
+  assert(output_end);
+  assert(begin <= end && end <= data_size);
+
+  const size_t output_size =
+      GetDecomposedSize(data_size, filter_size, dyadic_mode, padding_mode);
+  if (begin == end) {
+    *output_begin = 0;
+    *output_end = 0;
+    return;
+  }
+
+  const auto size = static_cast<ptrdiff_t>(data_size);
+  const auto taps = static_cast<ptrdiff_t>(filter_size);
+  const ptrdiff_t first = dyadic_mode == DyadicMode::Even ? 0 : 1;
+
+  // The indices of the padded signal which hold elements of the range.
+  auto low = static_cast<ptrdiff_t>(begin);
+  auto high = static_cast<ptrdiff_t>(end);
+
+  // Periodic padding repeats the last filter_size - 1 elements of the
+  // signal before its first one. A range reaching into them changes the
+  // first outputs as well as those reading it directly, and only the whole
+  // range of outputs covers both.
+  if (padding_mode == PaddingMode::Periodic && end + filter_size > data_size) {
+    *output_begin = 0;
+    *output_end = output_size;
+    return;
+  }
+
+  if (padding_mode == PaddingMode::Symmetric) {
+    // A signal shorter than the filter repeats its end elements all through
+    // the padding, any output may read them.
+    if (size < taps) {
+      *output_begin = 0;
+      *output_end = output_size;
+      return;
+    }
+
+    // Element e is mirrored to index -e on the left and to index
+    // 2 * size - 2 - e on the right. Only the filter_size - 1 indices on
+    // either side of the signal are ever read.
+    if (begin < filter_size) {
+      low = std::min(low, 1 - static_cast<ptrdiff_t>(end));
+    }
+    if (end + filter_size > data_size) {
+      high = std::max(high, 2 * size - 1 - static_cast<ptrdiff_t>(begin));
+    }
+  }
+
+  // Output m reads the padded indices 2 * m + first - (filter_size - 1)
+  // through 2 * m + first.
+  const ptrdiff_t range_begin = -FloorHalf(first - low);
+  const ptrdiff_t range_end = FloorHalf(high + taps - 2 - first) + 1;
+  *output_begin = static_cast<size_t>(std::clamp(
+      range_begin, ptrdiff_t{0}, static_cast<ptrdiff_t>(output_size)));
+  *output_end = static_cast<size_t>(
+      std::clamp(range_end, static_cast<ptrdiff_t>(*output_begin),
+                 static_cast<ptrdiff_t>(output_size)));
+}
+
+void WaveletMath::GetDecomposedRange(size_t data_size, size_t begin,
+                                     size_t end,
+                                     const LiftingScheme& lifting_scheme,
+                                     DyadicMode dyadic_mode,
+                                     PaddingMode padding_mode,
+                                     size_t* output_begin,
+                                     size_t* output_end) {
+  assert(output_begin);
+  assert(output_end);
+  assert(begin <= end && end <= data_size);
+  assert(!lifting_scheme.IsEmpty());
+
+  const size_t filter_size = lifting_scheme.GetFilterSize();
+  const size_t output_size =
+      GetDecomposedSize(data_size, filter_size, dyadic_mode, padding_mode);
+  *output_begin = 0;
+  *output_end = 0;
+  if (begin == end) {
+    return;
+  }
+
+  // A signal shorter than the filter repeats its end elements all through
+  // the symmetric padding, any output may read them.
+  if (padding_mode == PaddingMode::Symmetric && data_size < filter_size) {
+    *output_end = output_size;
+    return;
+  }
+
+  const auto size = static_cast<ptrdiff_t>(data_size);
+  const ptrdiff_t first = dyadic_mode == DyadicMode::Even ? 0 : 1;
+  const auto& steps = lifting_scheme.GetSteps();
+
+  // The stream indices Decompose fills before the first step, and the
+  // padded indices those hold. Stream s index m holds padded index
+  // 2 * m + first - s.
+  IndexRange ranges[2];
+  for (size_t s = 0; s < 2; s++) {
+    const ptrdiff_t delay = lifting_scheme.GetDelay(s);
+    ranges[s] = {-delay, static_cast<ptrdiff_t>(output_size) - delay};
+  }
+  PlanLifting(steps, ranges, nullptr);
+  IndexRange padded = {};
+  for (size_t s = 0; s < 2; s++) {
+    const ptrdiff_t offset = first - static_cast<ptrdiff_t>(s);
+    IncludeRange(&padded, {2 * ranges[s].begin + offset,
+                           2 * (ranges[s].end - 1) + offset + 1});
+  }
+
+  // The padded indices which hold elements of the range. Decompose reads
+  // zero beyond the filter_size - 1 indices on either side of a signal
+  // which is not periodic, where only the mirrored copies of elements that
+  // close to an end are.
+  const auto range_begin = static_cast<ptrdiff_t>(begin);
+  const auto range_end = static_cast<ptrdiff_t>(end);
+  IndexRange changed = {range_begin, range_end};
+  if (padding_mode == PaddingMode::Symmetric) {
+    // Element e is mirrored to index -e on the left and to index
+    // 2 * size - 2 - e on the right.
+    if (begin < filter_size) {
+      IncludeRange(&changed, {1 - range_end, 1 - range_begin});
+    }
+    if (end + filter_size > data_size) {
+      IncludeRange(&changed,
+                   {2 * size - 1 - range_end, 2 * size - 1 - range_begin});
+    }
+  } else if (padding_mode == PaddingMode::Periodic) {
+    // Each period is of even length, a signal of odd length repeats its
+    // last element once more. Start from the first copy of the range which
+    // reaches into the padded indices.
+    const ptrdiff_t period = size + size % 2;
+    const ptrdiff_t image_end = range_end + (end == data_size ? size % 2 : 0);
+    const ptrdiff_t low = padded.begin - image_end;
+    ptrdiff_t shift =
+        (low >= 0 ? low / period : -((period - 1 - low) / period)) * period +
+        period;
+    for (; range_begin + shift < padded.end; shift += period) {
+      IncludeRange(&changed, {range_begin + shift, image_end + shift});
+    }
+  }
+
+  // Follow the changed samples through the steps. Step target index m
+  // reads source indices m - delay - (taps - 1) through m - delay.
+  IndexRange streams[2] = {};
+  for (size_t s = 0; s < 2; s++) {
+    const ptrdiff_t offset = first - static_cast<ptrdiff_t>(s);
+    streams[s] = {-FloorHalf(offset - changed.begin),
+                  -FloorHalf(offset - changed.end)};
+  }
+  for (const auto& step : steps) {
+    const IndexRange& source = streams[1 - step.target];
+    if (!source.IsEmpty()) {
+      IncludeRange(&streams[step.target],
+                   {source.begin + step.delay,
+                    source.end + step.delay +
+                        static_cast<ptrdiff_t>(step.coeffs.size()) - 1});
+    }
+  }
+
+  // Output m of stream s is stream index m - delay.
+  IndexRange outputs = {};
+  for (size_t s = 0; s < 2; s++) {
+    const ptrdiff_t delay = lifting_scheme.GetDelay(s);
+    IncludeRange(&outputs,
+                 {streams[s].begin + delay, streams[s].end + delay});
+  }
+  *output_begin = static_cast<size_t>(std::clamp(
+      outputs.begin, ptrdiff_t{0}, static_cast<ptrdiff_t>(output_size)));
+  *output_end = static_cast<size_t>(
+      std::clamp(outputs.end, static_cast<ptrdiff_t>(*output_begin),
+                 static_cast<ptrdiff_t>(output_size)));
+}
+
 void WaveletMath::Decompose(const std::vector<double>& data,
                             const std::vector<double>& lowpass_filter_coeffs,
                             const std::vector<double>& highpass_filter_coeffs,
@@ -112,21 +649,239 @@ void WaveletMath::Decompose(const std::vector<double>& data,
                             DyadicMode dyadic_mode, PaddingMode padding_mode) {
   assert(approx_coeffs);
   assert(details_coeffs);
+  assert(approx_coeffs != &data && details_coeffs != &data);
+
+  const size_t output_size = GetDecomposedSize(
+      data.size(), lowpass_filter_coeffs.size(), dyadic_mode, padding_mode);
+  approx_coeffs->resize(output_size);
+  details_coeffs->resize(output_size);
+
+  Decompose(Span<const double>(data), lowpass_filter_coeffs,
+            highpass_filter_coeffs, Span<double>(*approx_coeffs),
+            Span<double>(*details_coeffs), dyadic_mode, padding_mode);
+}
+
+void WaveletMath::Decompose(Span<const double> data,
+                            const std::vector<double>& lowpass_filter_coeffs,
+                            const std::vector<double>& highpass_filter_coeffs,
+                            Span<double> approx_coeffs,
+                            Span<double> details_coeffs,
+                            DyadicMode dyadic_mode, PaddingMode padding_mode) {
+  Decompose<double>(data, lowpass_filter_coeffs, highpass_filter_coeffs,
+                    approx_coeffs, details_coeffs, dyadic_mode, padding_mode);
+}
+
+template <class Sample, class Accumulator>
+void WaveletMath::Decompose(
+    Span<const NoDeduce<Sample>> data,
+    Span<const NoDeduce<Accumulator>> lowpass_filter_coeffs,
+    Span<const NoDeduce<Accumulator>> highpass_filter_coeffs,
+    Span<NoDeduce<Sample>> approx_coeffs,
+    Span<NoDeduce<Sample>> details_coeffs, DyadicMode dyadic_mode,
+    PaddingMode padding_mode) {
+  assert(!data.empty());
+  assert(approx_coeffs.size() ==
+         GetDecomposedSize(data.size(), lowpass_filter_coeffs.size(),
+                           dyadic_mode, padding_mode));
+
+  DecomposeRange<Sample, Accumulator>(
+      data, 0, data.size(), lowpass_filter_coeffs, highpass_filter_coeffs,
+      approx_coeffs, details_coeffs, 0, dyadic_mode, padding_mode);
+}
+
+template <class Sample, class Accumulator>
+void WaveletMath::DecomposeRange(
+    Span<const NoDeduce<Sample>> window, size_t window_begin,
+    size_t data_size, Span<const NoDeduce<Accumulator>> lowpass_filter_coeffs,
+    Span<const NoDeduce<Accumulator>> highpass_filter_coeffs,
+    Span<NoDeduce<Sample>> approx_coeffs,
+    Span<NoDeduce<Sample>> details_coeffs, size_t output_begin,
+    DyadicMode dyadic_mode, PaddingMode padding_mode) {
+  assert(approx_coeffs.data() != window.data() &&
+         details_coeffs.data() != window.data());
   assert(lowpass_filter_coeffs.size() == highpass_filter_coeffs.size());
   assert(!lowpass_filter_coeffs.empty());
+  assert(approx_coeffs.size() == details_coeffs.size());
+  assert(window_begin + window.size() <= data_size);
+  const PrimitiveTimer timer(
+      Primitive::Decompose, lowpass_filter_coeffs.size(),
+      window.size() * sizeof(Sample),
+      (approx_coeffs.size() + details_coeffs.size()) * sizeof(Sample));
+
+  // This is equivalent to padding data by filter_size - 1 on both sides,
+  // convolving the padded data with each filter, and then dyadically
+  // downsampling the convolution results. Instead of materializing any of
+  // those intermediate vectors, we only compute the convolution values which
+  // survive downsampling. Convolution values whose filter window lies fully
+  // inside data read it directly; the few values near either end read the
+  // virtual padded signal via PaddedSample.
+  const size_t filter_size = lowpass_filter_coeffs.size();
+  const size_t first = dyadic_mode == DyadicMode::Even ? 0U : 1U;
+  const size_t output_end = output_begin + approx_coeffs.size();
+
+  // Output m is computed from convolution index 2 * m + first whose filter
+  // window covers data[2 * m + first - (filter_size - 1)] through
+  // data[2 * m + first]. Find the range of outputs with windows fully inside
+  // data. Which outputs those are does not depend on the range requested,
+  // so each output is computed the same way whatever range it is part of.
+  const size_t interior_begin = std::clamp((filter_size - first) / 2,
+                                           output_begin, output_end);
+  const size_t interior_end = std::clamp(
+      data_size > first ? (data_size - 1 - first) / 2 + 1 : 0U,
+      interior_begin, output_end);
+
+  const auto filter_at = [&](size_t output_index) {
+    const auto start = static_cast<ptrdiff_t>(2 * output_index + first) -
+                       static_cast<ptrdiff_t>(filter_size - 1);
+    Accumulator low = 0;
+    Accumulator high = 0;
+
+    for (size_t j = 0; j < filter_size; j++) {
+      const Accumulator sample =
+          PaddedSample<Sample>(window, window_begin, data_size,
+                               start + static_cast<ptrdiff_t>(j), padding_mode);
+      low += sample * lowpass_filter_coeffs[filter_size - j - 1];
+      high += sample * highpass_filter_coeffs[filter_size - j - 1];
+    }
+
+    approx_coeffs[output_index - output_begin] = static_cast<Sample>(low);
+    details_coeffs[output_index - output_begin] = static_cast<Sample>(high);
+  };
+
+  for (size_t m = output_begin; m < interior_begin; m++) {
+    filter_at(m);
+  }
+
+  if (interior_end > interior_begin) {
+    assert(2 * interior_begin + first - (filter_size - 1) >= window_begin);
+    GetWaveletKernels<Sample, Accumulator>().decimate(
+        window.data() + 2 * interior_begin + first - (filter_size - 1) -
+            window_begin,
+        lowpass_filter_coeffs.data(), highpass_filter_coeffs.data(),
+        filter_size, approx_coeffs.data() + (interior_begin - output_begin),
+        details_coeffs.data() + (interior_begin - output_begin),
+        interior_end - interior_begin);
+  }
+
+  for (size_t m = interior_end; m < output_end; m++) {
+    filter_at(m);
+  }
+}
+
+void WaveletMath::DecomposeDualPhase(
+    Span<const double> data, const std::vector<double>& lowpass_filter_coeffs,
+    const std::vector<double>& highpass_filter_coeffs,
+    Span<double> even_approx_coeffs, Span<double> even_details_coeffs,
+    Span<double> odd_approx_coeffs, Span<double> odd_details_coeffs,
+    PaddingMode padding_mode) {
+  DecomposeDualPhase<double>(data, lowpass_filter_coeffs,
+                             highpass_filter_coeffs, even_approx_coeffs,
+                             even_details_coeffs, odd_approx_coeffs,
+                             odd_details_coeffs, padding_mode);
+}
+
+template <class Sample, class Accumulator>
+void WaveletMath::DecomposeDualPhase(
+    Span<const NoDeduce<Sample>> data,
+    Span<const NoDeduce<Accumulator>> lowpass_filter_coeffs,
+    Span<const NoDeduce<Accumulator>> highpass_filter_coeffs,
+    Span<NoDeduce<Sample>> even_approx_coeffs,
+    Span<NoDeduce<Sample>> even_details_coeffs,
+    Span<NoDeduce<Sample>> odd_approx_coeffs,
+    Span<NoDeduce<Sample>> odd_details_coeffs, PaddingMode padding_mode) {
+  assert(lowpass_filter_coeffs.size() == highpass_filter_coeffs.size());
+  assert(!lowpass_filter_coeffs.empty());
+  assert(!data.empty());
+
+  // The even and odd outputs together are every value of the convolution of
+  // the padded data with each filter. Even output m is convolution index
+  // 2 * m and odd output m is convolution index 2 * m + 1, see Decompose.
+  const size_t data_size = data.size();
+  const size_t filter_size = lowpass_filter_coeffs.size();
+  const size_t even_size =
+      GetDecomposedSize(data_size, filter_size, DyadicMode::Even, padding_mode);
+  const size_t odd_size =
+      GetDecomposedSize(data_size, filter_size, DyadicMode::Odd, padding_mode);
 
-  std::vector<double> data_padded;
-  std::vector<double> low_pass_data;
-  std::vector<double> high_pass_data;
-  const auto filter_size = lowpass_filter_coeffs.size();
+  assert(even_approx_coeffs.size() == even_size);
+  assert(even_details_coeffs.size() == even_size);
+  assert(odd_approx_coeffs.size() == odd_size);
+  assert(odd_details_coeffs.size() == odd_size);
+  const PrimitiveTimer timer(
+      Primitive::DecomposeDualPhase, filter_size, data_size * sizeof(Sample),
+      2 * (even_size + odd_size) * sizeof(Sample));
 
-  Pad(data, &data_padded, filter_size - 1, filter_size - 1, padding_mode);
+  // Find the range of m for which the filter windows of both convolution
+  // indices lie fully inside data. The window of index n covers
+  // data[n - (filter_size - 1)] through data[n]. The interior of each phase
+  // alone, as DecomposeRange finds it, may extend one output further on
+  // either side.
+  const size_t even_begin = std::min(even_size, filter_size / 2);
+  const size_t even_end =
+      std::max(even_begin, std::min(even_size, (data_size + 1) / 2));
+  const size_t odd_begin = std::min(odd_size, (filter_size - 1) / 2);
+  const size_t odd_end = std::max(odd_begin, std::min(odd_size, data_size / 2));
+  const size_t interior_begin = std::max(even_begin, odd_begin);
+  const size_t interior_end =
+      std::max(interior_begin, std::min(even_end, odd_end));
 
-  Convolve(data_padded, lowpass_filter_coeffs, &low_pass_data);
-  Convolve(data_padded, highpass_filter_coeffs, &high_pass_data);
+  const auto filter_at = [&](size_t index, Span<Sample> approx_coeffs,
+                             Span<Sample> details_coeffs) {
+    const auto start = static_cast<ptrdiff_t>(index) -
+                       static_cast<ptrdiff_t>(filter_size - 1);
+    Accumulator low = 0;
+    Accumulator high = 0;
 
-  DyadicDownsample(low_pass_data, approx_coeffs, dyadic_mode);
-  DyadicDownsample(high_pass_data, details_coeffs, dyadic_mode);
+    for (size_t j = 0; j < filter_size; j++) {
+      const Accumulator sample = PaddedSample<Sample>(
+          data, start + static_cast<ptrdiff_t>(j), padding_mode);
+      low += sample * lowpass_filter_coeffs[filter_size - j - 1];
+      high += sample * highpass_filter_coeffs[filter_size - j - 1];
+    }
+
+    approx_coeffs[index / 2] = static_cast<Sample>(low);
+    details_coeffs[index / 2] = static_cast<Sample>(high);
+  };
+
+  // Compute outputs [begin, end) of one phase the way DecomposeRange does,
+  // so every output matches the one Decompose computes.
+  const auto decompose_phase = [&](size_t phase, size_t phase_begin,
+                                   size_t phase_end, size_t begin, size_t end,
+                                   Span<Sample> approx_coeffs,
+                                   Span<Sample> details_coeffs) {
+    for (size_t m = begin; m < end; m++) {
+      if (m < phase_begin || m >= phase_end) {
+        filter_at(2 * m + phase, approx_coeffs, details_coeffs);
+      } else {
+        GetWaveletKernels<Sample, Accumulator>().decimate(
+            data.data() + 2 * m + phase - (filter_size - 1),
+            lowpass_filter_coeffs.data(), highpass_filter_coeffs.data(),
+            filter_size, approx_coeffs.data() + m, details_coeffs.data() + m,
+            1);
+      }
+    }
+  };
+
+  decompose_phase(0, even_begin, even_end, 0, interior_begin,
+                  even_approx_coeffs, even_details_coeffs);
+  decompose_phase(1, odd_begin, odd_end, 0, interior_begin, odd_approx_coeffs,
+                  odd_details_coeffs);
+
+  if (interior_end > interior_begin) {
+    GetWaveletKernels<Sample, Accumulator>().decimate_dual_phase(
+        data.data() + 2 * interior_begin - (filter_size - 1),
+        lowpass_filter_coeffs.data(), highpass_filter_coeffs.data(),
+        filter_size, even_approx_coeffs.data() + interior_begin,
+        even_details_coeffs.data() + interior_begin,
+        odd_approx_coeffs.data() + interior_begin,
+        odd_details_coeffs.data() + interior_begin,
+        interior_end - interior_begin);
+  }
+
+  decompose_phase(0, even_begin, even_end, interior_end, even_size,
+                  even_approx_coeffs, even_details_coeffs);
+  decompose_phase(1, odd_begin, odd_end, interior_end, odd_size,
+                  odd_approx_coeffs, odd_details_coeffs);
 }
 
 void WaveletMath::Reconstruct(const std::vector<double>& coeffs,
@@ -135,22 +890,932 @@ void WaveletMath::Reconstruct(const std::vector<double>& coeffs,
                               DyadicMode dyadic_mode,
                               PaddingMode padding_mode) {
   assert(data);
+  assert(data != &coeffs);
+
+  data->resize(data_size);
+  Reconstruct(Span<const double>(coeffs), reconstruction_coeffs,
+              Span<double>(*data), dyadic_mode, padding_mode);
+}
+
+void WaveletMath::Reconstruct(Span<const double> coeffs,
+                              const std::vector<double>& reconstruction_coeffs,
+                              Span<double> data, DyadicMode dyadic_mode,
+                              PaddingMode padding_mode) {
+  Reconstruct<double>(coeffs, reconstruction_coeffs, data, dyadic_mode,
+                      padding_mode);
+}
+
+template <class Sample, class Accumulator>
+void WaveletMath::Reconstruct(
+    Span<const NoDeduce<Sample>> coeffs,
+    Span<const NoDeduce<Accumulator>> reconstruction_coeffs,
+    Span<NoDeduce<Sample>> data, DyadicMode dyadic_mode,
+    PaddingMode padding_mode) {
+  assert(data.data() != coeffs.data());
+  assert(!coeffs.empty());
   assert(reconstruction_coeffs.size() > 2);
+  const PrimitiveTimer timer(Primitive::Reconstruct,
+                             reconstruction_coeffs.size(),
+                             coeffs.size() * sizeof(Sample),
+                             data.size() * sizeof(Sample));
+
+  // This is equivalent to dyadically upsampling coeffs, padding the upsampled
+  // coefficients by filter_size - 1 on both sides, convolving them with the
+  // reconstruction filter, and copying a data_size window out of the result.
+  // Rather than building any of those vectors, each element of the window is
+  // computed directly from coeffs. Half of the upsampled coefficients are the
+  // inserted zeroes so only every other filter tap contributes to an output
+  // value and the remaining taps are skipped.
+  const size_t data_size = data.size();
+  const size_t filter_size = reconstruction_coeffs.size();
+  const size_t upsampled_size =
+      UpsampledSize(coeffs.size(), dyadic_mode, padding_mode);
+  const size_t dyad_shift = dyadic_mode == DyadicMode::Even ? 0U : 2U;
+
+  // Periodic padding reconstructs every period of the signal.
+  assert(padding_mode == PaddingMode::Periodic ||
+         data_size + 1 <= upsampled_size + dyad_shift);
+
+  // Output n is computed from the upsampled coefficients with indices
+  // n + 1 - dyad_shift through n + filter_size - dyad_shift. Find the range
+  // of outputs for which all of those indices lie inside the upsampled
+  // coefficients.
+  const size_t interior_begin =
+      std::min(data_size, dyad_shift > 0 ? dyad_shift - 1 : 0U);
+  const size_t interior_end = std::max(
+      interior_begin,
+      std::min(data_size, upsampled_size + dyad_shift >= filter_size
+                              ? upsampled_size + dyad_shift - filter_size
+                              : 0U));
+
+  const auto filter_at = [&](size_t output_index) {
+    const auto start = static_cast<ptrdiff_t>(output_index + 1) -
+                       static_cast<ptrdiff_t>(dyad_shift);
+    Accumulator val = 0;
 
-  std::vector<double> upsampled_coeffs;
-  std::vector<double> upsampled_coeffs_padded;
-  std::vector<double> data_wide;
-  const auto filter_size = reconstruction_coeffs.size();
+    for (size_t j = 0; j < filter_size; j++) {
+      Sample sample = 0;
+      if (UpsampledSample<Sample>(coeffs, start + static_cast<ptrdiff_t>(j),
+                                  dyadic_mode, padding_mode, &sample)) {
+        val += static_cast<Accumulator>(sample) *
+               reconstruction_coeffs[filter_size - j - 1];
+      }
+    }
+
+    data[output_index] = static_cast<Sample>(val);
+  };
+
+  for (size_t n = 0; n < interior_begin; n++) {
+    filter_at(n);
+  }
+
+  // The window of the first interior output always begins on the first value
+  // in coeffs, which is where the kernel expects it to begin.
+  if (interior_end > interior_begin) {
+    GetWaveletKernels<Sample, Accumulator>().reconstruct(
+        coeffs.data(), reconstruction_coeffs.data(), filter_size,
+        data.data() + interior_begin, interior_end - interior_begin);
+  }
+
+  for (size_t n = interior_end; n < data_size; n++) {
+    filter_at(n);
+  }
+}
+
+template <class Sample, class Accumulator>
+void WaveletMath::DecomposeChannels(
+    Span<const NoDeduce<Sample>> data, size_t channel_count,
+    Span<const NoDeduce<Accumulator>> lowpass_filter_coeffs,
+    Span<const NoDeduce<Accumulator>> highpass_filter_coeffs,
+    Span<NoDeduce<Sample>> approx_coeffs,
+    Span<NoDeduce<Sample>> details_coeffs, DyadicMode dyadic_mode,
+    PaddingMode padding_mode) {
+  assert(channel_count > 0);
+  assert(approx_coeffs.size() ==
+         GetDecomposedSize(data.size() / channel_count,
+                           lowpass_filter_coeffs.size(), dyadic_mode,
+                           padding_mode) *
+             channel_count);
+  assert(details_coeffs.size() == approx_coeffs.size());
+
+  DecomposeChannelsRange<Sample, Accumulator>(
+      data, channel_count, lowpass_filter_coeffs, highpass_filter_coeffs,
+      approx_coeffs, details_coeffs, 0, dyadic_mode, padding_mode);
+}
+
+template <class Sample, class Accumulator>
+void WaveletMath::DecomposeChannelsRange(
+    Span<const NoDeduce<Sample>> data, size_t channel_count,
+    Span<const NoDeduce<Accumulator>> lowpass_filter_coeffs,
+    Span<const NoDeduce<Accumulator>> highpass_filter_coeffs,
+    Span<NoDeduce<Sample>> approx_coeffs,
+    Span<NoDeduce<Sample>> details_coeffs, size_t output_begin,
+    DyadicMode dyadic_mode, PaddingMode padding_mode) {
+  assert(channel_count > 0);
+  assert(!data.empty());
+  assert(data.size() % channel_count == 0);
+  assert(approx_coeffs.data() != data.data() &&
+         details_coeffs.data() != data.data());
+  assert(lowpass_filter_coeffs.size() == highpass_filter_coeffs.size());
+  assert(!lowpass_filter_coeffs.empty());
+  assert(approx_coeffs.size() % channel_count == 0);
+  assert(approx_coeffs.size() == details_coeffs.size());
+
+  // The same decomposition as DecomposeRange, with every index scaled by
+  // the channel count.
+  const size_t data_size = data.size() / channel_count;
+  const size_t filter_size = lowpass_filter_coeffs.size();
+  const size_t first = dyadic_mode == DyadicMode::Even ? 0U : 1U;
+  const size_t output_end = output_begin + approx_coeffs.size() / channel_count;
 
-  DyadicUpsample(coeffs, &upsampled_coeffs, dyadic_mode);
-  Pad(upsampled_coeffs, &upsampled_coeffs_padded, filter_size - 1,
-      filter_size - 1, padding_mode);
-  Convolve(upsampled_coeffs_padded, reconstruction_coeffs, &data_wide);
+  assert(output_end <= GetDecomposedSize(data_size, filter_size, dyadic_mode,
+                                         padding_mode));
+  const PrimitiveTimer timer(
+      Primitive::DecomposeChannels, filter_size, data.size() * sizeof(Sample),
+      (approx_coeffs.size() + details_coeffs.size()) * sizeof(Sample));
+
+  const size_t interior_begin = std::clamp((filter_size - first) / 2,
+                                           output_begin, output_end);
+  const size_t interior_end = std::clamp(
+      data_size > first ? (data_size - 1 - first) / 2 + 1 : 0U,
+      interior_begin, output_end);
+
+  // Boundary outputs map each tap to its padded index once and accumulate
+  // a block of channels at a time, each channel in the order filter_at in
+  // DecomposeRange accumulates it.
+  const auto filter_at = [&](size_t output_index) {
+    const auto start = static_cast<ptrdiff_t>(2 * output_index + first) -
+                       static_cast<ptrdiff_t>(filter_size - 1);
+    Accumulator low[ChannelBlockSize];
+    Accumulator high[ChannelBlockSize];
+
+    for (size_t block = 0; block < channel_count;
+         block += ChannelBlockSize) {
+      const size_t block_size =
+          std::min(ChannelBlockSize, channel_count - block);
+      std::fill_n(low, block_size, Accumulator{0});
+      std::fill_n(high, block_size, Accumulator{0});
+
+      for (size_t j = 0; j < filter_size; j++) {
+        const ptrdiff_t index = PaddedIndex(
+            data_size, start + static_cast<ptrdiff_t>(j), padding_mode);
+        const Sample* row =
+            index < 0 ? nullptr
+                      : data.data() +
+                            static_cast<size_t>(index) * channel_count + block;
+        const Accumulator low_tap = lowpass_filter_coeffs[filter_size - j - 1];
+        const Accumulator high_tap =
+            highpass_filter_coeffs[filter_size - j - 1];
+
+        for (size_t c = 0; c < block_size; c++) {
+          const Accumulator sample = row == nullptr ? Sample{0} : row[c];
+          low[c] += sample * low_tap;
+          high[c] += sample * high_tap;
+        }
+      }
 
+      for (size_t c = 0; c < block_size; c++) {
+        const size_t index =
+            (output_index - output_begin) * channel_count + block + c;
+        approx_coeffs[index] = static_cast<Sample>(low[c]);
+        details_coeffs[index] = static_cast<Sample>(high[c]);
+      }
+    }
+  };
+
+  for (size_t m = output_begin; m < interior_begin; m++) {
+    filter_at(m);
+  }
+
+  if (interior_end > interior_begin) {
+    GetWaveletKernels<Sample, Accumulator>().decimate_channels(
+        data.data() +
+            (2 * interior_begin + first - (filter_size - 1)) * channel_count,
+        lowpass_filter_coeffs.data(), highpass_filter_coeffs.data(),
+        filter_size,
+        approx_coeffs.data() + (interior_begin - output_begin) * channel_count,
+        details_coeffs.data() + (interior_begin - output_begin) * channel_count,
+        interior_end - interior_begin, channel_count);
+  }
+
+  for (size_t m = interior_end; m < output_end; m++) {
+    filter_at(m);
+  }
+}
+
+template <class Sample, class Accumulator>
+void WaveletMath::ReconstructChannels(
+    Span<const NoDeduce<Sample>> coeffs, size_t channel_count,
+    Span<const NoDeduce<Accumulator>> reconstruction_coeffs,
+    Span<NoDeduce<Sample>> data, DyadicMode dyadic_mode,
+    PaddingMode padding_mode) {
+  assert(channel_count > 0);
+  assert(data.data() != coeffs.data());
+  assert(!coeffs.empty());
+  assert(coeffs.size() % channel_count == 0);
+  assert(data.size() % channel_count == 0);
+  assert(reconstruction_coeffs.size() > 2);
+  const PrimitiveTimer timer(Primitive::ReconstructChannels,
+                             reconstruction_coeffs.size(),
+                             coeffs.size() * sizeof(Sample),
+                             data.size() * sizeof(Sample));
+
+  // The same reconstruction as Reconstruct, with every index scaled by the
+  // channel count.
+  const size_t coeffs_size = coeffs.size() / channel_count;
+  const size_t data_size = data.size() / channel_count;
+  const size_t filter_size = reconstruction_coeffs.size();
+  const size_t upsampled_size =
+      UpsampledSize(coeffs_size, dyadic_mode, padding_mode);
   const size_t dyad_shift = dyadic_mode == DyadicMode::Even ? 0U : 2U;
-  auto begin = data_wide.cbegin() + (filter_size - dyad_shift);
+
+  assert(padding_mode == PaddingMode::Periodic ||
+         data_size + 1 <= upsampled_size + dyad_shift);
+
+  const size_t interior_begin =
+      std::min(data_size, dyad_shift > 0 ? dyad_shift - 1 : 0U);
+  const size_t interior_end = std::max(
+      interior_begin,
+      std::min(data_size, upsampled_size + dyad_shift >= filter_size
+                              ? upsampled_size + dyad_shift - filter_size
+                              : 0U));
+
+  const auto filter_at = [&](size_t output_index) {
+    const auto start = static_cast<ptrdiff_t>(output_index + 1) -
+                       static_cast<ptrdiff_t>(dyad_shift);
+    Accumulator val[ChannelBlockSize];
+
+    for (size_t block = 0; block < channel_count;
+         block += ChannelBlockSize) {
+      const size_t block_size =
+          std::min(ChannelBlockSize, channel_count - block);
+      std::fill_n(val, block_size, Accumulator{0});
+
+      for (size_t j = 0; j < filter_size; j++) {
+        const ptrdiff_t index =
+            UpsampledIndex(coeffs_size, start + static_cast<ptrdiff_t>(j),
+                           dyadic_mode, padding_mode);
+        if (index < 0) {
+          continue;
+        }
+
+        const Sample* row = coeffs.data() +
+                            static_cast<size_t>(index) * channel_count + block;
+        const Accumulator tap = reconstruction_coeffs[filter_size - j - 1];
+        for (size_t c = 0; c < block_size; c++) {
+          val[c] += static_cast<Accumulator>(row[c]) * tap;
+        }
+      }
+
+      for (size_t c = 0; c < block_size; c++) {
+        data[output_index * channel_count + block + c] =
+            static_cast<Sample>(val[c]);
+      }
+    }
+  };
+
+  for (size_t n = 0; n < interior_begin; n++) {
+    filter_at(n);
+  }
+
+  if (interior_end > interior_begin) {
+    GetWaveletKernels<Sample, Accumulator>().reconstruct_channels(
+        coeffs.data(), reconstruction_coeffs.data(), filter_size,
+        data.data() + interior_begin * channel_count,
+        interior_end - interior_begin, channel_count);
+  }
+
+  for (size_t n = interior_end; n < data_size; n++) {
+    filter_at(n);
+  }
+}
+
+template <class Sample, class Accumulator>
+void WaveletMath::DecomposeUndecimated(
+    Span<const NoDeduce<Sample>> data,
+    Span<const NoDeduce<Accumulator>> lowpass_filter_coeffs,
+    Span<const NoDeduce<Accumulator>> highpass_filter_coeffs,
+    size_t dilation, Span<NoDeduce<Sample>> approx_coeffs,
+    Span<NoDeduce<Sample>> details_coeffs, size_t output_begin,
+    size_t output_count) {
+  assert(!data.empty());
+  assert(dilation > 0);
+  assert(approx_coeffs.data() != data.data() &&
+         details_coeffs.data() != data.data());
+  assert(lowpass_filter_coeffs.size() == highpass_filter_coeffs.size());
+  assert(!lowpass_filter_coeffs.empty());
+  assert(approx_coeffs.size() == data.size());
+  assert(details_coeffs.size() == data.size());
+  assert(output_count <= data.size());
+
+  const size_t data_size = data.size();
+  const size_t filter_size = lowpass_filter_coeffs.size();
+  const size_t reach = (filter_size - 1) * dilation;
+  const PrimitiveTimer timer(
+      Primitive::DecomposeUndecimated, filter_size,
+      std::min(data_size, output_count + reach) * sizeof(Sample),
+      2 * output_count * sizeof(Sample));
+
+  // Outputs before reach read samples which wrap around the end of data.
+  // They are computed a block at a time, each tap adding a contiguous run
+  // of data to the whole block. Every output sums its taps in the same
+  // order either way, so it does not depend on the range requested.
+  const auto periodic_outputs = [&](size_t begin, size_t end) {
+    Accumulator approx[UndecimatedBlockSize];
+    Accumulator details[UndecimatedBlockSize];
+    for (size_t n = begin; n < end; n += UndecimatedBlockSize) {
+      const size_t count = std::min(UndecimatedBlockSize, end - n);
+      std::fill_n(approx, count, Accumulator(0));
+      std::fill_n(details, count, Accumulator(0));
+
+      for (size_t j = 0; j < filter_size; j++) {
+        const size_t back = j * dilation % data_size;
+        const size_t first = n >= back ? n - back : n + data_size - back;
+        AccumulatePeriodic<Sample, Accumulator>(
+            data, first, lowpass_filter_coeffs[j], approx, count);
+        AccumulatePeriodic<Sample, Accumulator>(
+            data, first, highpass_filter_coeffs[j], details, count);
+      }
+
+      for (size_t i = 0; i < count; i++) {
+        approx_coeffs[n + i] = static_cast<Sample>(approx[i]);
+        details_coeffs[n + i] = static_cast<Sample>(details[i]);
+      }
+    }
+  };
+
+  const Accumulator* const filters[2] = {lowpass_filter_coeffs.data(),
+                                         highpass_filter_coeffs.data()};
+  size_t n = output_begin % data_size;
+  for (size_t done = 0; done < output_count;) {
+    // Outputs [n, end) do not wrap around the end of the outputs.
+    const size_t end = std::min(data_size, n + output_count - done);
+    const size_t interior_begin = std::clamp(reach, n, end);
+    periodic_outputs(n, interior_begin);
+
+    Sample* const outputs[2] = {approx_coeffs.data() + interior_begin,
+                                details_coeffs.data() + interior_begin};
+    FilterDilated<2, Sample, Accumulator>(
+        data.data() + interior_begin, filters, filter_size, dilation, outputs,
+        end - interior_begin, Accumulator(1));
+
+    done += end - n;
+    n = end % data_size;
+  }
+}
+
+template <class Sample, class Accumulator>
+void WaveletMath::ReconstructUndecimated(
+    Span<const NoDeduce<Sample>> coeffs,
+    Span<const NoDeduce<Accumulator>> reconstruction_coeffs,
+    size_t dilation, Span<NoDeduce<Sample>> data) {
+  assert(!coeffs.empty());
+  assert(dilation > 0);
+  assert(data.data() != coeffs.data());
+  assert(data.size() == coeffs.size());
+  assert(!reconstruction_coeffs.empty());
+
+  const size_t data_size = data.size();
+  const size_t filter_size = reconstruction_coeffs.size();
+  const size_t reach = (filter_size - 1) * dilation;
+  const PrimitiveTimer timer(Primitive::ReconstructUndecimated, filter_size,
+                             coeffs.size() * sizeof(Sample),
+                             data_size * sizeof(Sample));
+
+  // The reconstruction filters of an orthogonal wavelet are the reversed
+  // decomposition filters. Tap j reads the coefficient filter_size - 1 - j
+  // dilated taps after each output, undoing the delay of decomposition.
+  // Outputs from data_size - reach on read coefficients which wrap around.
+  const size_t interior_end = data_size > reach ? data_size - reach : 0U;
+  const Accumulator* const filters[1] = {reconstruction_coeffs.data()};
+  Sample* const outputs[1] = {data.data()};
+  FilterDilated<1, Sample, Accumulator>(coeffs.data() + reach, filters,
+                                        filter_size, dilation, outputs,
+                                        interior_end, Accumulator(0.5));
+
+  Accumulator sums[UndecimatedBlockSize];
+  for (size_t n = interior_end; n < data_size; n += UndecimatedBlockSize) {
+    const size_t count = std::min(UndecimatedBlockSize, data_size - n);
+    std::fill_n(sums, count, Accumulator(0));
+
+    for (size_t j = 0; j < filter_size; j++) {
+      const size_t ahead = (filter_size - 1 - j) * dilation % data_size;
+      AccumulatePeriodic<Sample, Accumulator>(
+          coeffs, (n + ahead) % data_size, reconstruction_coeffs[j], sums,
+          count);
+    }
+
+    for (size_t i = 0; i < count; i++) {
+      data[n + i] = static_cast<Sample>(sums[i] * Accumulator(0.5));
+    }
+  }
+}
+
+template <class Sample, class Accumulator>
+void WaveletMath::Threshold(Span<const NoDeduce<Sample>> data,
+                            double threshold, ThresholdRule rule,
+                            Span<NoDeduce<Sample>> result) {
+  assert(data.size() == result.size());
+  assert(threshold >= 0.0);
+  const PrimitiveTimer timer(Primitive::Threshold, 0,
+                             data.size() * sizeof(Sample),
+                             result.size() * sizeof(Sample));
+
+  const auto& kernels = GetWaveletKernels<Sample, Accumulator>();
+  const auto shrink = rule == ThresholdRule::Soft ? kernels.soft_threshold
+                                                  : kernels.hard_threshold;
+  shrink(data.data(), static_cast<Accumulator>(threshold), result.data(),
+         data.size());
+}
+
+void WaveletMath::Decompose(const std::vector<double>& data,
+                            const LiftingScheme& lifting_scheme,
+                            std::vector<double>* approx_coeffs,
+                            std::vector<double>* details_coeffs,
+                            DyadicMode dyadic_mode, PaddingMode padding_mode,
+                            WaveletWorkspace* workspace) {
+  assert(approx_coeffs);
+  assert(details_coeffs);
+  assert(approx_coeffs != &data && details_coeffs != &data);
+  assert(!lifting_scheme.IsEmpty());
+
+  const size_t output_size =
+      GetDecomposedSize(data.size(), lifting_scheme.GetFilterSize(),
+                        dyadic_mode, padding_mode);
+  approx_coeffs->resize(output_size);
+  details_coeffs->resize(output_size);
+
+  Decompose(Span<const double>(data), lifting_scheme,
+            Span<double>(*approx_coeffs), Span<double>(*details_coeffs),
+            dyadic_mode, padding_mode, workspace);
+}
+
+void WaveletMath::Decompose(Span<const double> data,
+                            const LiftingScheme& lifting_scheme,
+                            Span<double> approx_coeffs,
+                            Span<double> details_coeffs,
+                            DyadicMode dyadic_mode, PaddingMode padding_mode,
+                            WaveletWorkspace* workspace) {
+  Decompose<double>(data, lifting_scheme, approx_coeffs, details_coeffs,
+                    dyadic_mode, padding_mode, workspace);
+}
+
+template <class Sample>
+void WaveletMath::Decompose(Span<const NoDeduce<Sample>> data,
+                            const LiftingScheme& lifting_scheme,
+                            Span<NoDeduce<Sample>> approx_coeffs,
+                            Span<NoDeduce<Sample>> details_coeffs,
+                            DyadicMode dyadic_mode, PaddingMode padding_mode,
+                            WaveletWorkspace* workspace) {
+  assert(!lifting_scheme.IsEmpty());
+  assert(approx_coeffs.size() ==
+         GetDecomposedSize(data.size(), lifting_scheme.GetFilterSize(),
+                           dyadic_mode, padding_mode));
+  assert(details_coeffs.size() == approx_coeffs.size());
+
+  DecomposeRange<Sample>(data, lifting_scheme, approx_coeffs, details_coeffs,
+                         0, dyadic_mode, padding_mode, workspace);
+}
+
+template <class Sample>
+void WaveletMath::DecomposeRange(Span<const NoDeduce<Sample>> data,
+                                 const LiftingScheme& lifting_scheme,
+                                 Span<NoDeduce<Sample>> approx_coeffs,
+                                 Span<NoDeduce<Sample>> details_coeffs,
+                                 size_t output_begin, DyadicMode dyadic_mode,
+                                 PaddingMode padding_mode,
+                                 WaveletWorkspace* workspace) {
+  assert(approx_coeffs.data() != data.data() &&
+         details_coeffs.data() != data.data());
+  assert(!lifting_scheme.IsEmpty());
+  assert(!data.empty());
+  assert(approx_coeffs.size() == details_coeffs.size());
+
+  WaveletWorkspace local_workspace;
+  if (workspace == nullptr) {
+    workspace = &local_workspace;
+  }
+
+  // The virtual padded signal is split into two streams. Stream 0 holds the
+  // samples at the convolution indices which survive downsampling and
+  // stream 1 holds the samples just before them. The lifting steps turn the
+  // streams into the approximation and details coefficients in place.
+  const auto data_size = static_cast<ptrdiff_t>(data.size());
+  const auto filter_size =
+      static_cast<ptrdiff_t>(lifting_scheme.GetFilterSize());
+  const ptrdiff_t first = dyadic_mode == DyadicMode::Even ? 0 : 1;
+  const size_t output_count = approx_coeffs.size();
+  const auto& steps = lifting_scheme.GetSteps();
+
+  assert(output_begin + output_count <=
+         GetDecomposedSize(data.size(), lifting_scheme.GetFilterSize(),
+                           dyadic_mode, padding_mode));
+
+  const PrimitiveTimer timer(
+      Primitive::LiftingDecompose, lifting_scheme.GetFilterSize(),
+      data.size() * sizeof(Sample),
+      (approx_coeffs.size() + details_coeffs.size()) * sizeof(Sample));
+
+  // Output m of stream s is stream index m - delay.
+  IndexRange ranges[2];
+  for (size_t s = 0; s < 2; s++) {
+    const ptrdiff_t begin =
+        static_cast<ptrdiff_t>(output_begin) - lifting_scheme.GetDelay(s);
+    ranges[s] = {begin, begin + static_cast<ptrdiff_t>(output_count)};
+  }
+
+  std::vector<IndexRange>& updates = workspace->lifting_updates_;
+  PlanLifting(steps, ranges, &updates);
+
+  // Samples outside of the padded signal never contribute to an output.
+  // Reading zero for them keeps the lifting steps from cancelling large
+  // values. A periodic signal has no such samples, it repeats forever.
+  const bool periodic = padding_mode == PaddingMode::Periodic;
+  LiftingStream streams[2];
+  for (size_t s = 0; s < 2; s++) {
+    const ptrdiff_t offset = first - static_cast<ptrdiff_t>(s);
+    const IndexRange& range = ranges[s];
+    const ptrdiff_t inside_begin =
+        std::clamp(-FloorHalf(offset), range.begin, range.end);
+    const ptrdiff_t inside_end =
+        std::clamp(FloorHalf(data_size - 1 - offset) + 1, inside_begin,
+                   std::max(range.end, inside_begin));
+    const auto padded_at = [&](ptrdiff_t m) {
+      const ptrdiff_t index = 2 * m + offset;
+      return periodic || (index > -filter_size &&
+                          index < data_size + filter_size - 1)
+                 ? static_cast<double>(
+                       PaddedSample<Sample>(data, index, padding_mode))
+                 : 0.0;
+    };
+
+    BindLiftingStream(range, &workspace->lifting_streams_[s], &streams[s]);
+
+    for (ptrdiff_t m = range.begin; m < inside_begin; m++) {
+      *streams[s].At(m) = padded_at(m);
+    }
+    // Samples inside data are copied with a stride of two.
+    for (ptrdiff_t m = inside_begin; m < inside_end; m++) {
+      streams[s].values[m - range.begin] = data[2 * m + offset];
+    }
+    for (ptrdiff_t m = inside_end; m < range.end; m++) {
+      *streams[s].At(m) = padded_at(m);
+    }
+  }
+
+  for (size_t i = 0; i < steps.size(); i++) {
+    ApplyLiftingStep(steps[i], updates[i], streams);
+  }
+
+  const Span<Sample> outputs[2] = {approx_coeffs, details_coeffs};
+  for (size_t s = 0; s < 2; s++) {
+    const double scale = lifting_scheme.GetScale(s);
+    const double* values = streams[s].At(static_cast<ptrdiff_t>(output_begin) -
+                                         lifting_scheme.GetDelay(s));
+
+    for (size_t m = 0; m < output_count; m++) {
+      outputs[s][m] = static_cast<Sample>(scale * values[m]);
+    }
+  }
+}
+
+void WaveletMath::Reconstruct(const std::vector<double>& coeffs,
+                              const LiftingScheme& lifting_scheme,
+                              CoefficientType coeffs_type,
+                              std::vector<double>* data, size_t data_size,
+                              DyadicMode dyadic_mode,
+                              PaddingMode padding_mode,
+                              WaveletWorkspace* workspace) {
+  assert(data);
+  assert(data != &coeffs);
+
   data->resize(data_size);
-  std::copy_n(begin, data_size, data->begin());
+  Reconstruct(Span<const double>(coeffs), lifting_scheme, coeffs_type,
+              Span<double>(*data), dyadic_mode, padding_mode, workspace);
 }
 
+void WaveletMath::Reconstruct(Span<const double> coeffs,
+                              const LiftingScheme& lifting_scheme,
+                              CoefficientType coeffs_type, Span<double> data,
+                              DyadicMode dyadic_mode,
+                              PaddingMode padding_mode,
+                              WaveletWorkspace* workspace) {
+  Reconstruct<double>(coeffs, lifting_scheme, coeffs_type, data, dyadic_mode,
+                      padding_mode, workspace);
+}
+
+template <class Sample>
+void WaveletMath::Reconstruct(Span<const NoDeduce<Sample>> coeffs,
+                              const LiftingScheme& lifting_scheme,
+                              CoefficientType coeffs_type,
+                              Span<NoDeduce<Sample>> data,
+                              DyadicMode dyadic_mode,
+                              PaddingMode padding_mode,
+                              WaveletWorkspace* workspace) {
+  assert(!coeffs.empty());
+
+  if (coeffs_type == CoefficientType::Approximation) {
+    Reconstruct<Sample>(coeffs, Span<const Sample>(), lifting_scheme, data,
+                        dyadic_mode, padding_mode, workspace);
+  } else {
+    Reconstruct<Sample>(Span<const Sample>(), coeffs, lifting_scheme, data,
+                        dyadic_mode, padding_mode, workspace);
+  }
+}
+
+template <class Sample>
+void WaveletMath::Reconstruct(Span<const NoDeduce<Sample>> approx_coeffs,
+                              Span<const NoDeduce<Sample>> details_coeffs,
+                              const LiftingScheme& lifting_scheme,
+                              Span<NoDeduce<Sample>> data,
+                              DyadicMode dyadic_mode,
+                              PaddingMode padding_mode,
+                              WaveletWorkspace* workspace) {
+  const Span<const Sample> coeffs[2] = {approx_coeffs, details_coeffs};
+  const size_t coeffs_size = std::max(coeffs[0].size(), coeffs[1].size());
+  assert(coeffs_size != 0);
+  assert(!lifting_scheme.IsEmpty());
+  for ([[maybe_unused]] const Span<const Sample>& stream_coeffs : coeffs) {
+    assert(stream_coeffs.empty() || stream_coeffs.size() == coeffs_size);
+    assert(stream_coeffs.empty() || data.data() != stream_coeffs.data());
+  }
+
+  // The convolution fallback below runs inside this timer, so short
+  // signals are still counted as a lifting reconstruction.
+  const PrimitiveTimer timer(
+      Primitive::LiftingReconstruct, lifting_scheme.GetFilterSize(),
+      (coeffs[0].size() + coeffs[1].size()) * sizeof(Sample),
+      data.size() * sizeof(Sample));
+
+  // Run the lifting steps backwards starting from the coefficients in
+  // their streams, or zeroes for a stream without any. The streams end up
+  // holding the samples of the reconstructed signal interleaved the same
+  // way Decompose splits them.
+  const size_t data_size = data.size();
+  const auto filter_size =
+      static_cast<ptrdiff_t>(lifting_scheme.GetFilterSize());
+  const size_t upsampled_size =
+      UpsampledSize(coeffs_size, dyadic_mode, padding_mode);
+  const bool periodic = padding_mode == PaddingMode::Periodic;
+  const ptrdiff_t first = dyadic_mode == DyadicMode::Even ? 0 : 1;
+  const ptrdiff_t value_parity = dyadic_mode == DyadicMode::Even ? 1 : 0;
+  const auto& steps = lifting_scheme.GetInverseSteps();
+
+  assert(periodic ||
+         data_size + 1 <=
+             upsampled_size + (dyadic_mode == DyadicMode::Even ? 0U : 2U));
+
+  WaveletWorkspace local_workspace;
+  if (workspace == nullptr) {
+    workspace = &local_workspace;
+  }
+
+  // When the upsampled coefficients are shorter than the filter, symmetric
+  // padding clamps to the end values and can place them in between the
+  // upsampled coefficients. That can't be expressed in the lifting streams.
+  // With both streams present they are summed in a lifting stream buffer,
+  // which is always long enough for a signal this short.
+  if (static_cast<ptrdiff_t>(upsampled_size) < filter_size) {
+    const bool both = !coeffs[0].empty() && !coeffs[1].empty();
+    std::vector<double>& sum = workspace->lifting_streams_[0];
+    if (both) {
+      sum.assign(data_size, 0.0);
+    }
+    for (size_t s = 0; s < 2; s++) {
+      if (coeffs[s].empty()) {
+        continue;
+      }
+      Reconstruct<Sample, double>(coeffs[s],
+                                  lifting_scheme.GetReconstructionFilter(s),
+                                  data, dyadic_mode, padding_mode);
+      if (both) {
+        std::transform(sum.begin(), sum.end(), data.begin(), sum.begin(),
+                       std::plus<>());
+      }
+    }
+    if (both) {
+      std::transform(sum.begin(), sum.end(), data.begin(),
+                     [](double value) { return static_cast<Sample>(value); });
+    }
+    return;
+  }
+
+  // Stream s sample m lands on output 2 * m + first - s.
+  IndexRange outputs[2];
+  for (size_t s = 0; s < 2; s++) {
+    const ptrdiff_t offset = first - static_cast<ptrdiff_t>(s);
+    outputs[s] = {-FloorHalf(offset),
+                  FloorHalf(static_cast<ptrdiff_t>(data_size) - 1 - offset) +
+                      1};
+  }
+
+  IndexRange ranges[2] = {outputs[0], outputs[1]};
+  std::vector<IndexRange>& updates = workspace->lifting_updates_;
+  PlanLifting(steps, ranges, &updates);
+
+  LiftingStream streams[2];
+  for (size_t s = 0; s < 2; s++) {
+    BindLiftingStream(ranges[s], &workspace->lifting_streams_[s], &streams[s]);
+    std::fill_n(streams[s].values, workspace->lifting_streams_[s].size(), 0.0);
+  }
+
+  // Undo the scaling. Coefficients outside of the padded upsampled
+  // coefficients never contribute to an output so they are left as zero.
+  // Periodic coefficients repeat forever.
+  for (size_t s = 0; s < 2; s++) {
+    if (coeffs[s].empty()) {
+      continue;
+    }
+    const Span<const Sample> stream_coeffs = coeffs[s];
+    const ptrdiff_t delay = lifting_scheme.GetDelay(s);
+    const double inverse_scale = 1.0 / lifting_scheme.GetScale(s);
+    const IndexRange& range = ranges[s];
+    const ptrdiff_t inside_begin = std::clamp(-delay, range.begin, range.end);
+    const ptrdiff_t inside_end = std::clamp(
+        static_cast<ptrdiff_t>(coeffs_size) - delay, inside_begin,
+        std::max(range.end, inside_begin));
+    const auto padded_at = [&](ptrdiff_t m) {
+      const ptrdiff_t index = 2 * (m + delay) + value_parity;
+      Sample sample = 0;
+      if ((periodic ||
+           (index > -filter_size &&
+            index < static_cast<ptrdiff_t>(upsampled_size) + filter_size -
+                        1)) &&
+          UpsampledSample<Sample>(stream_coeffs, index, dyadic_mode,
+                                  padding_mode, &sample)) {
+        return sample * inverse_scale;
+      }
+      return 0.0;
+    };
+    LiftingStream& stream = streams[s];
+
+    for (ptrdiff_t m = range.begin; m < inside_begin; m++) {
+      *stream.At(m) = padded_at(m);
+    }
+    for (ptrdiff_t m = inside_begin; m < inside_end; m++) {
+      stream.values[m - range.begin] = stream_coeffs[m + delay] * inverse_scale;
+    }
+    for (ptrdiff_t m = inside_end; m < range.end; m++) {
+      *stream.At(m) = padded_at(m);
+    }
+  }
+
+  for (size_t i = 0; i < steps.size(); i++) {
+    ApplyLiftingStep(steps[i], updates[i], streams);
+  }
+
+  for (size_t s = 0; s < 2; s++) {
+    const ptrdiff_t offset = first - static_cast<ptrdiff_t>(s);
+    for (ptrdiff_t m = outputs[s].begin; m < outputs[s].end; m++) {
+      data[2 * m + offset] = static_cast<Sample>(*streams[s].At(m));
+    }
+  }
+}
+
+template void WaveletMath::Decompose<double, double>(
+    Span<const double>, Span<const double>, Span<const double>, Span<double>,
+    Span<double>, DyadicMode, PaddingMode);
+template void WaveletMath::Decompose<float, float>(
+    Span<const float>, Span<const float>, Span<const float>, Span<float>,
+    Span<float>, DyadicMode, PaddingMode);
+template void WaveletMath::Decompose<float, double>(
+    Span<const float>, Span<const double>, Span<const double>, Span<float>,
+    Span<float>, DyadicMode, PaddingMode);
+
+template void WaveletMath::DecomposeRange<double, double>(
+    Span<const double>, size_t, size_t, Span<const double>, Span<const double>,
+    Span<double>, Span<double>, size_t, DyadicMode, PaddingMode);
+template void WaveletMath::DecomposeRange<float, float>(
+    Span<const float>, size_t, size_t, Span<const float>, Span<const float>,
+    Span<float>, Span<float>, size_t, DyadicMode, PaddingMode);
+template void WaveletMath::DecomposeRange<float, double>(
+    Span<const float>, size_t, size_t, Span<const double>, Span<const double>,
+    Span<float>, Span<float>, size_t, DyadicMode, PaddingMode);
+
+template void WaveletMath::DecomposeDualPhase<double, double>(
+    Span<const double>, Span<const double>, Span<const double>, Span<double>,
+    Span<double>, Span<double>, Span<double>, PaddingMode);
+template void WaveletMath::DecomposeDualPhase<float, float>(
+    Span<const float>, Span<const float>, Span<const float>, Span<float>,
+    Span<float>, Span<float>, Span<float>, PaddingMode);
+template void WaveletMath::DecomposeDualPhase<float, double>(
+    Span<const float>, Span<const double>, Span<const double>, Span<float>,
+    Span<float>, Span<float>, Span<float>, PaddingMode);
+
+template void WaveletMath::Reconstruct<double, double>(Span<const double>,
+                                                       Span<const double>,
+                                                       Span<double>,
+                                                       DyadicMode,
+                                                       PaddingMode);
+template void WaveletMath::Reconstruct<float, float>(Span<const float>,
+                                                     Span<const float>,
+                                                     Span<float>, DyadicMode,
+                                                     PaddingMode);
+template void WaveletMath::Reconstruct<float, double>(Span<const float>,
+                                                      Span<const double>,
+                                                      Span<float>, DyadicMode,
+                                                      PaddingMode);
+
+template void WaveletMath::DecomposeChannels<double, double>(
+    Span<const double>, size_t, Span<const double>, Span<const double>,
+    Span<double>, Span<double>, DyadicMode, PaddingMode);
+template void WaveletMath::DecomposeChannels<float, float>(
+    Span<const float>, size_t, Span<const float>, Span<const float>,
+    Span<float>, Span<float>, DyadicMode, PaddingMode);
+template void WaveletMath::DecomposeChannels<float, double>(
+    Span<const float>, size_t, Span<const double>, Span<const double>,
+    Span<float>, Span<float>, DyadicMode, PaddingMode);
+
+template void WaveletMath::DecomposeChannelsRange<double, double>(
+    Span<const double>, size_t, Span<const double>, Span<const double>,
+    Span<double>, Span<double>, size_t, DyadicMode, PaddingMode);
+template void WaveletMath::DecomposeChannelsRange<float, float>(
+    Span<const float>, size_t, Span<const float>, Span<const float>,
+    Span<float>, Span<float>, size_t, DyadicMode, PaddingMode);
+template void WaveletMath::DecomposeChannelsRange<float, double>(
+    Span<const float>, size_t, Span<const double>, Span<const double>,
+    Span<float>, Span<float>, size_t, DyadicMode, PaddingMode);
+
+template void WaveletMath::ReconstructChannels<double, double>(
+    Span<const double>, size_t, Span<const double>, Span<double>, DyadicMode,
+    PaddingMode);
+template void WaveletMath::ReconstructChannels<float, float>(
+    Span<const float>, size_t, Span<const float>, Span<float>, DyadicMode,
+    PaddingMode);
+template void WaveletMath::ReconstructChannels<float, double>(
+    Span<const float>, size_t, Span<const double>, Span<float>, DyadicMode,
+    PaddingMode);
+
+template void WaveletMath::DecomposeUndecimated<double, double>(
+    Span<const double>, Span<const double>, Span<const double>, size_t,
+    Span<double>, Span<double>, size_t, size_t);
+template void WaveletMath::DecomposeUndecimated<float, float>(
+    Span<const float>, Span<const float>, Span<const float>, size_t,
+    Span<float>, Span<float>, size_t, size_t);
+template void WaveletMath::DecomposeUndecimated<float, double>(
+    Span<const float>, Span<const double>, Span<const double>, size_t,
+    Span<float>, Span<float>, size_t, size_t);
+
+template void WaveletMath::ReconstructUndecimated<double, double>(
+    Span<const double>, Span<const double>, size_t, Span<double>);
+template void WaveletMath::ReconstructUndecimated<float, float>(
+    Span<const float>, Span<const float>, size_t, Span<float>);
+template void WaveletMath::ReconstructUndecimated<float, double>(
+    Span<const float>, Span<const double>, size_t, Span<float>);
+
+template void WaveletMath::Threshold<double, double>(Span<const double>,
+                                                     double, ThresholdRule,
+                                                     Span<double>);
+template void WaveletMath::Threshold<float, float>(Span<const float>, double,
+                                                   ThresholdRule,
+                                                   Span<float>);
+template void WaveletMath::Threshold<float, double>(Span<const float>, double,
+                                                    ThresholdRule,
+                                                    Span<float>);
+
+template void WaveletMath::Decompose<double>(Span<const double>,
+                                             const LiftingScheme&,
+                                             Span<double>, Span<double>,
+                                             DyadicMode, PaddingMode,
+                                             WaveletWorkspace*);
+template void WaveletMath::Decompose<float>(Span<const float>,
+                                            const LiftingScheme&, Span<float>,
+                                            Span<float>, DyadicMode,
+                                            PaddingMode, WaveletWorkspace*);
+
+template void WaveletMath::DecomposeRange<double>(Span<const double>,
+                                                  const LiftingScheme&,
+                                                  Span<double>, Span<double>,
+                                                  size_t, DyadicMode,
+                                                  PaddingMode,
+                                                  WaveletWorkspace*);
+template void WaveletMath::DecomposeRange<float>(Span<const float>,
+                                                 const LiftingScheme&,
+                                                 Span<float>, Span<float>,
+                                                 size_t, DyadicMode,
+                                                 PaddingMode,
+                                                 WaveletWorkspace*);
+
+template void WaveletMath::Reconstruct<double>(Span<const double>,
+                                               const LiftingScheme&,
+                                               CoefficientType, Span<double>,
+                                               DyadicMode, PaddingMode,
+                                               WaveletWorkspace*);
+template void WaveletMath::Reconstruct<float>(Span<const float>,
+                                              const LiftingScheme&,
+                                              CoefficientType, Span<float>,
+                                              DyadicMode, PaddingMode,
+                                              WaveletWorkspace*);
+
+template void WaveletMath::Reconstruct<double>(Span<const double>,
+                                               Span<const double>,
+                                               const LiftingScheme&,
+                                               Span<double>, DyadicMode,
+                                               PaddingMode, WaveletWorkspace*);
+template void WaveletMath::Reconstruct<float>(Span<const float>,
+                                              Span<const float>,
+                                              const LiftingScheme&,
+                                              Span<float>, DyadicMode,
+                                              PaddingMode, WaveletWorkspace*);
+
 }  // namespace panwave
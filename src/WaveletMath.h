@@ -7,9 +7,12 @@
 #ifndef WAVELETMATH_H
 #define WAVELETMATH_H
 
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 
+#include "Span.h"
+
 namespace panwave {
 
 /**
@@ -21,10 +24,105 @@ enum class DyadicMode : uint8_t { Even = 0, Odd };
 
 /**
  * When padding data in WaveletMath::Pad, this mode controls what value
- * is used for the padding elements in the extended data vector.
+ * is used for the padding elements in the extended data vector.<br/>
+ * Zeroes pads with zero and Symmetric mirrors the signal around its end
+ * elements. Periodic repeats the signal, first extended by a copy of its
+ * last element if its length is odd. A decomposition with periodic padding
+ * yields exactly half as many coefficients as the signal has elements,
+ * rounded up, however long the filters are.
  * @see Pad
  */
-enum class PaddingMode : uint8_t { Zeroes = 0, Symmetric };
+enum class PaddingMode : uint8_t { Zeroes = 0, Symmetric, Periodic };
+
+/**
+ * Selects how decomposition and reconstruction apply the wavelet filters.
+ * <br/>
+ * Convolution filters the signal with the wavelet filters directly.<br/>
+ * Lifting factors the filters into lifting steps and applies those in place,
+ * which needs roughly half the arithmetic to decompose a signal or to
+ * reconstruct it from both of its children. Reconstructing from one child
+ * alone costs as much as from both, which is more than convolution skipping
+ * the zeroes of the upsampled coefficients needs. It is only available for
+ * orthogonal wavelets such as Daubechies and Symlets.
+ * @see LiftingScheme
+ */
+enum class TransformEngine : uint8_t { Convolution = 0, Lifting };
+
+/**
+ * Identifies which of the two sets of coefficients produced by a
+ * decomposition is being reconstructed.
+ */
+enum class CoefficientType : uint8_t { Approximation = 0, Details };
+
+/**
+ * How coefficients are shrunk by a threshold.<br/>
+ * Hard keeps the coefficients whose magnitude exceeds the threshold and
+ * zeroes the others. Soft also moves the coefficients it keeps toward zero
+ * by the threshold, so the result does not jump at the threshold.
+ * @see WaveletMath::Threshold
+ */
+enum class ThresholdRule : uint8_t { Hard = 0, Soft };
+
+/**
+ * Names T in a context template arguments are not deduced from, so an
+ * argument only has to convert to T. A stand-in for c++20's
+ * std::type_identity_t.
+ */
+template <class T>
+struct TypeIdentity {
+  using type = T;
+};
+template <class T>
+using NoDeduce = typename TypeIdentity<T>::type;
+
+class LiftingScheme;
+
+/**
+ * Scratch memory used by the WaveletMath primitives.<br/>
+ * Decompositions and reconstructions which are passed a workspace keep
+ * their intermediate values in it instead of allocating them on every
+ * call. Buffers only ever grow, so once a workspace has been used for the
+ * largest signal it will see, further calls do not allocate.<br/>
+ * The convolution primitives compute their outputs directly from their
+ * inputs and need no scratch memory.<br/>
+ * A workspace may be reused across calls but not shared between threads.
+ * @see WaveletMath::Decompose
+ * @see WaveletMath::Reconstruct
+ */
+class WaveletWorkspace {
+ public:
+  /**
+   * A half-open range [begin, end) of indices into a lifting stream.
+   */
+  struct IndexRange {
+    ptrdiff_t begin;
+    ptrdiff_t end;
+
+    bool IsEmpty() const { return this->end <= this->begin; }
+  };
+
+  WaveletWorkspace() = default;
+
+  /**
+   * Construct a workspace large enough for signals of up to signal_size
+   * elements filtered with filters of filter_size taps.
+   * @see Reserve
+   */
+  WaveletWorkspace(size_t signal_size, size_t filter_size);
+
+  /**
+   * Grow the buffers so decomposing a signal of up to signal_size elements,
+   * or reconstructing one, with filters of filter_size taps does not
+   * allocate.
+   */
+  void Reserve(size_t signal_size, size_t filter_size);
+
+ private:
+  friend class WaveletMath;
+
+  std::vector<double> lifting_streams_[2];
+  std::vector<IndexRange> lifting_updates_;
+};
 
 /**
  * A container for static methods useful to compute wavelet math functions.
@@ -60,6 +158,109 @@ class WaveletMath {
                         DyadicMode dyadic_mode = DyadicMode::Odd,
                         PaddingMode padding_mode = PaddingMode::Zeroes);
 
+  /**
+   * Decompose a signal into caller-provided approximation and details
+   * coefficient buffers.<br/>
+   * Identical to the overload taking vectors except that nothing is
+   * resized. Both destination buffers must hold exactly
+   * GetDecomposedSize(data.size(), filter size, dyadic_mode, padding_mode)
+   * elements and must not overlap data.
+   * @see GetDecomposedSize
+   */
+  static void Decompose(Span<const double> data,
+                        const std::vector<double>& lowpass_filter_coeffs,
+                        const std::vector<double>& highpass_filter_coeffs,
+                        Span<double> approx_coeffs, Span<double> details_coeffs,
+                        DyadicMode dyadic_mode = DyadicMode::Odd,
+                        PaddingMode padding_mode = PaddingMode::Zeroes);
+
+  /**
+   * Decompose a signal of any supported sample type into caller-provided
+   * buffers.<br/>
+   * Identical to the overload taking spans of doubles. Template argument
+   * |Sample| is the type of the signal and of the coefficients.
+   * |Accumulator| is the type of the filter taps and of the sums computed
+   * from them. Double samples are accumulated in double, float samples in
+   * either float or double. The template arguments are not deduced, call
+   * Decompose<float>(...) or Decompose<float, double>(...).
+   */
+  template <class Sample, class Accumulator = Sample>
+  static void Decompose(
+      Span<const NoDeduce<Sample>> data,
+      Span<const NoDeduce<Accumulator>> lowpass_filter_coeffs,
+      Span<const NoDeduce<Accumulator>> highpass_filter_coeffs,
+      Span<NoDeduce<Sample>> approx_coeffs,
+      Span<NoDeduce<Sample>> details_coeffs,
+      DyadicMode dyadic_mode = DyadicMode::Odd,
+      PaddingMode padding_mode = PaddingMode::Zeroes);
+
+  /**
+   * Compute a range of the outputs of Decompose from part of a signal.<br/>
+   * Each output is identical to the one Decompose computes from the whole
+   * signal, so a signal which arrives in pieces can be decomposed as the
+   * pieces arrive.
+   * @param window A contiguous part of the signal. Must hold every element
+   *               the requested outputs are computed from, including the
+   *               elements symmetric padding mirrors into their filter
+   *               windows.
+   * @param window_begin Index of the first element of window in the signal.
+   * @param data_size The number of elements in the signal. While the signal
+   *                  is still arriving, the number of elements so far may be
+   *                  passed as long as none of the requested outputs reads
+   *                  beyond them.
+   * @param approx_coeffs Receives approximation outputs output_begin onward,
+   *                      as many as it holds.
+   * @param details_coeffs Receives the details outputs of the same range.
+   * @param output_begin Index of the first output to compute.
+   * @see Decompose
+   */
+  template <class Sample, class Accumulator = Sample>
+  static void DecomposeRange(
+      Span<const NoDeduce<Sample>> window, size_t window_begin,
+      size_t data_size, Span<const NoDeduce<Accumulator>> lowpass_filter_coeffs,
+      Span<const NoDeduce<Accumulator>> highpass_filter_coeffs,
+      Span<NoDeduce<Sample>> approx_coeffs,
+      Span<NoDeduce<Sample>> details_coeffs, size_t output_begin,
+      DyadicMode dyadic_mode = DyadicMode::Odd,
+      PaddingMode padding_mode = PaddingMode::Zeroes);
+
+  /**
+   * Decompose a signal in both dyadic modes at once.<br/>
+   * Produces the same coefficients as calling Decompose once with
+   * DyadicMode::Even and once with DyadicMode::Odd, but the signal is
+   * filtered in a single pass and the padding around it is only computed
+   * once.<br/>
+   * The even destination buffers must hold exactly
+   * GetDecomposedSize(data.size(), filter size, DyadicMode::Even,
+   * padding_mode) elements, the odd ones GetDecomposedSize(data.size(),
+   * filter size, DyadicMode::Odd, padding_mode) elements. None may overlap
+   * data.
+   * @see Decompose
+   */
+  static void DecomposeDualPhase(
+      Span<const double> data, const std::vector<double>& lowpass_filter_coeffs,
+      const std::vector<double>& highpass_filter_coeffs,
+      Span<double> even_approx_coeffs, Span<double> even_details_coeffs,
+      Span<double> odd_approx_coeffs, Span<double> odd_details_coeffs,
+      PaddingMode padding_mode = PaddingMode::Zeroes);
+
+  /**
+   * Decompose a signal of any supported sample type in both dyadic modes at
+   * once.
+   * @see DecomposeDualPhase
+   * @see Decompose
+   */
+  template <class Sample, class Accumulator = Sample>
+  static void DecomposeDualPhase(
+      Span<const NoDeduce<Sample>> data,
+      Span<const NoDeduce<Accumulator>> lowpass_filter_coeffs,
+      Span<const NoDeduce<Accumulator>> highpass_filter_coeffs,
+      Span<NoDeduce<Sample>> even_approx_coeffs,
+      Span<NoDeduce<Sample>> even_details_coeffs,
+      Span<NoDeduce<Sample>> odd_approx_coeffs,
+      Span<NoDeduce<Sample>> odd_details_coeffs,
+      PaddingMode padding_mode = PaddingMode::Zeroes);
+
   /**
    * Reconstruct a signal from approximation or details coefficients.
    * @param coeffs Either the approximation or details coefficients
@@ -81,6 +282,381 @@ class WaveletMath {
                           DyadicMode dyadic_mode = DyadicMode::Odd,
                           PaddingMode padding_mode = PaddingMode::Zeroes);
 
+  /**
+   * Reconstruct a signal into a caller-provided buffer.<br/>
+   * Identical to the overload taking vectors with data_size equal to
+   * data.size(). The buffer must not overlap coeffs.
+   */
+  static void Reconstruct(Span<const double> coeffs,
+                          const std::vector<double>& reconstruction_coeffs,
+                          Span<double> data,
+                          DyadicMode dyadic_mode = DyadicMode::Odd,
+                          PaddingMode padding_mode = PaddingMode::Zeroes);
+
+  /**
+   * Reconstruct a signal of any supported sample type into a
+   * caller-provided buffer.
+   * @see Reconstruct
+   * @see Decompose
+   */
+  template <class Sample, class Accumulator = Sample>
+  static void Reconstruct(
+      Span<const NoDeduce<Sample>> coeffs,
+      Span<const NoDeduce<Accumulator>> reconstruction_coeffs,
+      Span<NoDeduce<Sample>> data, DyadicMode dyadic_mode = DyadicMode::Odd,
+      PaddingMode padding_mode = PaddingMode::Zeroes);
+
+  /**
+   * Decompose several signals of the same length at once.<br/>
+   * The signals are interleaved: element i of channel c is at
+   * data[i * channel_count + c]. The coefficients are interleaved the same
+   * way, so approx_coeffs and details_coeffs must each hold channel_count
+   * times GetDecomposedSize(data.size() / channel_count, filter size,
+   * dyadic_mode, padding_mode) elements. Each channel receives the
+   * coefficients Decompose computes from it on its own. The kernels run
+   * their vector lanes across the channels, which keeps them busy however
+   * short the signals are.
+   * @see Decompose
+   */
+  template <class Sample, class Accumulator = Sample>
+  static void DecomposeChannels(
+      Span<const NoDeduce<Sample>> data, size_t channel_count,
+      Span<const NoDeduce<Accumulator>> lowpass_filter_coeffs,
+      Span<const NoDeduce<Accumulator>> highpass_filter_coeffs,
+      Span<NoDeduce<Sample>> approx_coeffs,
+      Span<NoDeduce<Sample>> details_coeffs,
+      DyadicMode dyadic_mode = DyadicMode::Odd,
+      PaddingMode padding_mode = PaddingMode::Zeroes);
+
+  /**
+   * Compute a range of the outputs of DecomposeChannels.<br/>
+   * Every channel of each output in the range is identical to the one
+   * DecomposeChannels computes from the whole signal.
+   * @param approx_coeffs Receives the channels of the approximation outputs
+   *                      output_begin onward, as many outputs as it holds
+   *                      channel_count elements for.
+   * @param details_coeffs Receives the details outputs of the same range.
+   * @param output_begin Index of the first output to compute.
+   * @see DecomposeChannels
+   * @see DecomposeRange
+   */
+  template <class Sample, class Accumulator = Sample>
+  static void DecomposeChannelsRange(
+      Span<const NoDeduce<Sample>> data, size_t channel_count,
+      Span<const NoDeduce<Accumulator>> lowpass_filter_coeffs,
+      Span<const NoDeduce<Accumulator>> highpass_filter_coeffs,
+      Span<NoDeduce<Sample>> approx_coeffs,
+      Span<NoDeduce<Sample>> details_coeffs, size_t output_begin,
+      DyadicMode dyadic_mode = DyadicMode::Odd,
+      PaddingMode padding_mode = PaddingMode::Zeroes);
+
+  /**
+   * Reconstruct several signals of the same length at once from their
+   * channel-interleaved coefficients.<br/>
+   * Each channel of data receives the signal Reconstruct computes from the
+   * coefficients of that channel on its own.
+   * @see DecomposeChannels
+   * @see Reconstruct
+   */
+  template <class Sample, class Accumulator = Sample>
+  static void ReconstructChannels(
+      Span<const NoDeduce<Sample>> coeffs, size_t channel_count,
+      Span<const NoDeduce<Accumulator>> reconstruction_coeffs,
+      Span<NoDeduce<Sample>> data, DyadicMode dyadic_mode = DyadicMode::Odd,
+      PaddingMode padding_mode = PaddingMode::Zeroes);
+
+  /**
+   * Decompose a signal without downsampling, with the filters dilated by
+   * inserting dilation - 1 zeroes between their taps.<br/>
+   * This is one step of the undecimated (a trous) transform. The signal is
+   * extended periodically, so both outputs are as long as data:
+   * approx_coeffs[n] is the sum over j of lowpass_filter_coeffs[j] times
+   * data[(n - j * dilation) mod data.size()], and details_coeffs[n] the
+   * same with the highpass filter.<br/>
+   * Only outputs (output_begin + i) mod data.size() for i below
+   * output_count are written, the rest are left as they are.
+   * @param data The signal data we wish to decompose.
+   * @param lowpass_filter_coeffs Low-pass decomposition filter.
+   * @param highpass_filter_coeffs High-pass decomposition filter.
+   * @param dilation The spacing of the filter taps, 2^depth for a node at
+   *                 that depth of an undecimated tree.
+   * @param approx_coeffs Destination approximation coefficients, as long
+   *                      as data. Must not overlap data.
+   * @param details_coeffs Destination details coefficients, as long as
+   *                       data. Must not overlap data.
+   * @param output_begin The first output to write.
+   * @param output_count The number of outputs to write, at most
+   *                     data.size().
+   * @see ReconstructUndecimated
+   */
+  template <class Sample, class Accumulator = Sample>
+  static void DecomposeUndecimated(
+      Span<const NoDeduce<Sample>> data,
+      Span<const NoDeduce<Accumulator>> lowpass_filter_coeffs,
+      Span<const NoDeduce<Accumulator>> highpass_filter_coeffs,
+      size_t dilation, Span<NoDeduce<Sample>> approx_coeffs,
+      Span<NoDeduce<Sample>> details_coeffs, size_t output_begin,
+      size_t output_count);
+
+  /**
+   * Reconstruct the contribution of approximation or details coefficients
+   * of an undecimated decomposition to the signal they were computed
+   * from.<br/>
+   * data[n] is half the sum over j of reconstruction_coeffs[j] times
+   * coeffs[(n + (filter size - 1 - j) * dilation) mod coeffs.size()]. The
+   * contributions of the approximation and details coefficients of a signal
+   * add up to the signal for orthogonal wavelets.
+   * @param coeffs Coefficients computed by DecomposeUndecimated.
+   * @param reconstruction_coeffs The reconstruction filter matching the
+   *                              kind of coefficients.
+   * @param dilation The dilation coeffs were decomposed with.
+   * @param data Destination for the contribution, as long as coeffs. Any
+   *             existing contents are overwritten. Must not overlap
+   *             coeffs.
+   * @see DecomposeUndecimated
+   */
+  template <class Sample, class Accumulator = Sample>
+  static void ReconstructUndecimated(
+      Span<const NoDeduce<Sample>> coeffs,
+      Span<const NoDeduce<Accumulator>> reconstruction_coeffs,
+      size_t dilation, Span<NoDeduce<Sample>> data);
+
+  /**
+   * Shrink a set of coefficients by a threshold.<br/>
+   * Hard thresholding copies each value whose magnitude exceeds threshold
+   * and zeroes the others. Soft thresholding also subtracts threshold from
+   * the magnitude of each value it keeps.
+   * @param data The coefficients to shrink.
+   * @param threshold The threshold, at least zero.
+   * @param rule Whether to threshold hard or soft.
+   * @param result Destination for the shrunk coefficients, as long as data.
+   *               May be data itself, which shrinks the coefficients in
+   *               place, but must not otherwise overlap it.
+   * @see ThresholdRule
+   */
+  template <class Sample, class Accumulator = Sample>
+  static void Threshold(Span<const NoDeduce<Sample>> data, double threshold,
+                        ThresholdRule rule, Span<NoDeduce<Sample>> result);
+
+  /**
+   * Decompose a signal into approximation and details coefficients via a
+   * lifting scheme.<br/>
+   * Produces the same coefficients as filtering data with the wavelet
+   * filters the lifting scheme was factored from.
+   * @param data The signal data we wish to decompose.
+   * @param lifting_scheme The factored wavelet filters.
+   * @param approx_coeffs Destination approximation coefficients. Any
+   *                      existing contents will be overwritten.
+   * @param details_coeffs Destination details coefficients. Any
+   *                      existing contents will be overwritten.
+   * @param dyadic_mode Mode we should use when dyadically downsampling.
+   *                    (default: Odd)
+   * @param padding_mode Padding mode we should use when padding the
+   *                     signal data. (Default: Zeroes)
+   * @param workspace Scratch memory for the lifting streams. If nullptr,
+   *                  the streams are allocated for this call only.
+   *                  (default: nullptr)
+   * @see LiftingScheme::Factor
+   */
+  static void Decompose(const std::vector<double>& data,
+                        const LiftingScheme& lifting_scheme,
+                        std::vector<double>* approx_coeffs,
+                        std::vector<double>* details_coeffs,
+                        DyadicMode dyadic_mode = DyadicMode::Odd,
+                        PaddingMode padding_mode = PaddingMode::Zeroes,
+                        WaveletWorkspace* workspace = nullptr);
+
+  /**
+   * Decompose a signal via a lifting scheme into caller-provided
+   * approximation and details coefficient buffers.<br/>
+   * Identical to the overload taking vectors except that nothing is
+   * resized. Both destination buffers must hold exactly
+   * GetDecomposedSize(data.size(), filter size, dyadic_mode, padding_mode)
+   * elements and must not overlap data.
+   * @see GetDecomposedSize
+   */
+  static void Decompose(Span<const double> data,
+                        const LiftingScheme& lifting_scheme,
+                        Span<double> approx_coeffs, Span<double> details_coeffs,
+                        DyadicMode dyadic_mode = DyadicMode::Odd,
+                        PaddingMode padding_mode = PaddingMode::Zeroes,
+                        WaveletWorkspace* workspace = nullptr);
+
+  /**
+   * Decompose a signal of any supported sample type via a lifting scheme
+   * into caller-provided buffers.<br/>
+   * The lifting steps always run in double. Call as Decompose<float>(...).
+   * @see Decompose
+   */
+  template <class Sample>
+  static void Decompose(Span<const NoDeduce<Sample>> data,
+                        const LiftingScheme& lifting_scheme,
+                        Span<NoDeduce<Sample>> approx_coeffs,
+                        Span<NoDeduce<Sample>> details_coeffs,
+                        DyadicMode dyadic_mode = DyadicMode::Odd,
+                        PaddingMode padding_mode = PaddingMode::Zeroes,
+                        WaveletWorkspace* workspace = nullptr);
+
+  /**
+   * Compute a range of the outputs of Decompose via a lifting scheme.<br/>
+   * Each output is identical to the one Decompose computes, but the
+   * lifting steps only run over the stream indices the range needs. Call
+   * as DecomposeRange<float>(...).
+   * @param approx_coeffs Receives approximation outputs output_begin onward,
+   *                      as many as it holds.
+   * @param details_coeffs Receives the details outputs of the same range.
+   * @param output_begin Index of the first output to compute.
+   * @see Decompose
+   * @see GetDecomposedRange
+   */
+  template <class Sample>
+  static void DecomposeRange(Span<const NoDeduce<Sample>> data,
+                             const LiftingScheme& lifting_scheme,
+                             Span<NoDeduce<Sample>> approx_coeffs,
+                             Span<NoDeduce<Sample>> details_coeffs,
+                             size_t output_begin,
+                             DyadicMode dyadic_mode = DyadicMode::Odd,
+                             PaddingMode padding_mode = PaddingMode::Zeroes,
+                             WaveletWorkspace* workspace = nullptr);
+
+  /**
+   * Reconstruct a signal from approximation or details coefficients via a
+   * lifting scheme.<br/>
+   * Produces the same signal as filtering the upsampled coefficients with
+   * the matching reconstruction filter of the wavelet the lifting scheme was
+   * factored from.
+   * @param coeffs Either the approximation or details coefficients
+   *               produced during a decomposition.
+   * @param lifting_scheme The factored wavelet filters.
+   * @param coeffs_type Which kind of coefficients coeffs holds.
+   * @param data Destination vector for the reconstructed signal. Any
+   *             existing contents will be erased.
+   * @param data_size Size of the reconstructed signal.
+   * @param dyadic_mode Mode we should use when dyadically upsampling.
+   *                    (default: Odd)
+   * @param padding_mode Padding mode we should use when padding the
+   *                     coefficient data. (Default: Zeroes)
+   * @param workspace Scratch memory for the lifting streams. If nullptr,
+   *                  the streams are allocated for this call only.
+   *                  (default: nullptr)
+   * @see LiftingScheme::Factor
+   */
+  static void Reconstruct(const std::vector<double>& coeffs,
+                          const LiftingScheme& lifting_scheme,
+                          CoefficientType coeffs_type,
+                          std::vector<double>* data, size_t data_size,
+                          DyadicMode dyadic_mode = DyadicMode::Odd,
+                          PaddingMode padding_mode = PaddingMode::Zeroes,
+                          WaveletWorkspace* workspace = nullptr);
+
+  /**
+   * Reconstruct a signal via a lifting scheme into a caller-provided
+   * buffer.<br/>
+   * Identical to the overload taking vectors with data_size equal to
+   * data.size(). The buffer must not overlap coeffs.
+   */
+  static void Reconstruct(Span<const double> coeffs,
+                          const LiftingScheme& lifting_scheme,
+                          CoefficientType coeffs_type, Span<double> data,
+                          DyadicMode dyadic_mode = DyadicMode::Odd,
+                          PaddingMode padding_mode = PaddingMode::Zeroes,
+                          WaveletWorkspace* workspace = nullptr);
+
+  /**
+   * Reconstruct a signal of any supported sample type via a lifting scheme
+   * into a caller-provided buffer.<br/>
+   * The lifting steps always run in double. Call as Reconstruct<float>(...).
+   * @see Reconstruct
+   */
+  template <class Sample>
+  static void Reconstruct(Span<const NoDeduce<Sample>> coeffs,
+                          const LiftingScheme& lifting_scheme,
+                          CoefficientType coeffs_type,
+                          Span<NoDeduce<Sample>> data,
+                          DyadicMode dyadic_mode = DyadicMode::Odd,
+                          PaddingMode padding_mode = PaddingMode::Zeroes,
+                          WaveletWorkspace* workspace = nullptr);
+
+  /**
+   * Reconstruct a signal from both its approximation and details
+   * coefficients via a lifting scheme into a caller-provided buffer.<br/>
+   * Produces the sum of the signals reconstructed from either kind of
+   * coefficients alone, but runs the lifting steps only once. The
+   * single-stream overloads run every step too, so a signal reconstructed
+   * from just one kind of coefficients costs as much as this.
+   * Call as Reconstruct<float>(...).
+   * @param approx_coeffs The approximation coefficients, or an empty span
+   *                      to reconstruct from the details alone.
+   * @param details_coeffs The details coefficients, or an empty span to
+   *                       reconstruct from the approximation alone. Must
+   *                       be as long as approx_coeffs unless either is
+   *                       empty.
+   * @see Reconstruct
+   */
+  template <class Sample>
+  static void Reconstruct(Span<const NoDeduce<Sample>> approx_coeffs,
+                          Span<const NoDeduce<Sample>> details_coeffs,
+                          const LiftingScheme& lifting_scheme,
+                          Span<NoDeduce<Sample>> data,
+                          DyadicMode dyadic_mode = DyadicMode::Odd,
+                          PaddingMode padding_mode = PaddingMode::Zeroes,
+                          WaveletWorkspace* workspace = nullptr);
+
+  /**
+   * Get the number of approximation (or details) coefficients Decompose
+   * produces from a signal.
+   * @param data_size The number of elements in the signal.
+   * @param filter_size The length of the decomposition filters.
+   * @param dyadic_mode Mode used when dyadically downsampling.
+   * @param padding_mode Padding mode used during decomposition. Periodic
+   *                     padding produces (data_size + 1) / 2 coefficients
+   *                     whatever the filter size and dyadic mode.
+   *                     (default: Zeroes)
+   */
+  static size_t GetDecomposedSize(
+      size_t data_size, size_t filter_size, DyadicMode dyadic_mode,
+      PaddingMode padding_mode = PaddingMode::Zeroes);
+
+  /**
+   * Find which outputs of Decompose depend on a range of the signal.<br/>
+   * These are the outputs whose filter windows read any element in
+   * [begin, end), including the copies symmetric padding mirrors into the
+   * padding around the signal. Every other output keeps its value when
+   * elements in the range change. Periodic padding wraps the elements near
+   * the end of the signal around into the windows of the first outputs, so
+   * a range that close to the end gives every output.
+   * @param data_size The number of elements in the signal.
+   * @param begin Index of the first element of the range.
+   * @param end Index one past the last element of the range.
+   * @param filter_size The length of the decomposition filters.
+   * @param dyadic_mode Mode used when dyadically downsampling.
+   * @param padding_mode Padding mode used during decomposition.
+   * @param output_begin Receives the index of the first dependent output.
+   * @param output_end Receives the index one past the last dependent
+   *                   output. Equal to output_begin if the range is empty.
+   * @see DecomposeRange
+   */
+  static void GetDecomposedRange(size_t data_size, size_t begin, size_t end,
+                                 size_t filter_size, DyadicMode dyadic_mode,
+                                 PaddingMode padding_mode,
+                                 size_t* output_begin, size_t* output_end);
+
+  /**
+   * Find which outputs of a decomposition via a lifting scheme depend on a
+   * range of the signal.<br/>
+   * The range is followed through every lifting step. A step may read
+   * further than the wavelet filters do, so the outputs found can be a few
+   * more than the filters give, but every output whose rounding the range
+   * can affect is among them.
+   * @see GetDecomposedRange
+   * @see DecomposeRange
+   */
+  static void GetDecomposedRange(size_t data_size, size_t begin, size_t end,
+                                 const LiftingScheme& lifting_scheme,
+                                 DyadicMode dyadic_mode,
+                                 PaddingMode padding_mode,
+                                 size_t* output_begin, size_t* output_end);
+
   /**
    * Dyadically upsample a data signal.<br/>
    * All of the original values from data are included in the upsampled
@@ -146,7 +722,11 @@ class WaveletMath {
    * longer than data size, the last or first element of data is used
    * for all the elements which would overflow data.<br/>
    * For example, [1,2,3] symmetrically padded by 3 on the left and
-   * right produces [3,3,2,1,2,3,2,1,1]
+   * right produces [3,3,2,1,2,3,2,1,1]<br/>
+   * If padding_mode is Periodic, the inserted elements repeat data, which
+   * is first extended by its last element if its length is odd. For
+   * example, [1,2,3] periodically padded by 3 on the left and right
+   * produces [2,3,3,1,2,3,3,1,2]. The padding may be longer than data.
    * @param data The original data we want to pad.
    * @param extended_data The destination for our padded data. It will
    *                      have length equal to pad_left + pad_right +
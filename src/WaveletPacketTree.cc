@@ -6,6 +6,7 @@
 
 #include "WaveletPacketTree.h"
 
+#include <algorithm>
 #include <cassert>
 
 #include "Wavelet.h"
@@ -20,85 +21,271 @@ constexpr size_t ChildIndexRight = 1;
 
 namespace panwave {
 
-WaveletPacketTree::WaveletPacketTree(size_t height, const Wavelet* wavelet,
-                                     DyadicMode dyadic_mode,
-                                     PaddingMode padding_mode)
-    : WaveletPacketTreeTemplateBase(height, wavelet),
+template <class Sample, class Accumulator>
+BasicWaveletPacketTree<Sample, Accumulator>::BasicWaveletPacketTree(
+    size_t height, const Wavelet* wavelet, DyadicMode dyadic_mode,
+    PaddingMode padding_mode, TransformEngine engine)
+    : WaveletPacketTreeTemplateBase<2, Sample, Accumulator>(height, wavelet,
+                                                            engine),
       dyadic_mode_(dyadic_mode),
       padding_mode_(padding_mode) {}
 
-void WaveletPacketTree::Decompose() { this->DecomposeNode(0); }
+template <class Sample, class Accumulator>
+BasicWaveletPacketTree<Sample, Accumulator>::BasicWaveletPacketTree(
+    size_t height, const Wavelet* wavelet, size_t channel_count,
+    DyadicMode dyadic_mode, PaddingMode padding_mode)
+    : WaveletPacketTreeTemplateBase<2, Sample, Accumulator>(
+          height, wavelet, TransformEngine::Convolution, channel_count),
+      dyadic_mode_(dyadic_mode),
+      padding_mode_(padding_mode) {}
 
-void WaveletPacketTree::Reconstruct(size_t level) {
-  // Unmark all nodes in the tree.
-  this->Unmark();
+template <class Sample, class Accumulator>
+DyadicMode BasicWaveletPacketTree<Sample, Accumulator>::GetChildDyadicMode(
+    size_t /*child_index*/) const {
+  return this->dyadic_mode_;
+}
 
-  // Mark only the leaf node for the level we want to isolate.
-  this->IsolateLevel(level);
+template <class Sample, class Accumulator>
+CoefficientType
+BasicWaveletPacketTree<Sample, Accumulator>::GetChildCoefficientType(
+    size_t child_index) const {
+  return child_index == ChildIndexLeft ? CoefficientType::Approximation
+                                       : CoefficientType::Details;
+}
 
-  // Reconstruct the signal at the requested level.
-  this->ReconstructNode(0);
+template <class Sample, class Accumulator>
+void BasicWaveletPacketTree<Sample, Accumulator>::Reconstruct(size_t level) {
+  const TreeProfile::Scope scope(&this->profile_);
+  this->Reconstruct(level, this->GetReconstructedRoot());
+  this->ReleaseRootSignalView();
 }
 
-void WaveletPacketTree::IsolateLevel(size_t level) {
+template <class Sample, class Accumulator>
+void BasicWaveletPacketTree<Sample, Accumulator>::Reconstruct(
+    size_t level, Span<Sample> signal) {
   assert(level < this->GetWaveletLevelCount());
 
+  const TreeProfile::Scope scope(&this->profile_);
+
   // This is a binary tree, the number of wavelet levels is equal to the
-  // number of leaves.
-  this->SetMark(this->GetFirstLeaf() + level);
+  // number of leaves. Only the nodes on the path from the leaf for level up
+  // to the root are reconstructed.
+  this->ReconstructPath(this->GetFirstLeaf() + level, this->padding_mode_,
+                        signal);
 }
 
-void WaveletPacketTree::DecomposeNode(size_t node) {
-  if (this->IsLeaf(node)) {
-    return;
+template <class Sample, class Accumulator>
+void BasicWaveletPacketTree<Sample, Accumulator>::ReconstructAll(
+    Span<Sample> levels) {
+  const size_t level_count = this->GetWaveletLevelCount();
+  const size_t signal_size = this->GetNodeData(0).signal.size();
+
+  assert(levels.size() == level_count * signal_size);
+
+  const TreeProfile::Scope scope(&this->profile_);
+
+  // Each level is reconstructed straight into its row of levels.
+  for (size_t level = 0; level < level_count; level++) {
+    this->ReconstructPath(this->GetFirstLeaf() + level, this->padding_mode_,
+                          levels.subspan(level * signal_size, signal_size));
   }
+}
 
-  const size_t left = this->GetChild(node, ChildIndexLeft);
-  const size_t right = this->GetChild(node, ChildIndexRight);
+template <class Sample, class Accumulator>
+double BasicWaveletPacketTree<Sample, Accumulator>::DecomposeBestBasis(
+    const BasicBasisCost<Sample>& cost,
+    std::vector<BasicBasisNode<Sample>>* basis) {
+  assert(!this->GetNodeData(0).signal.empty());
+
+  const TreeProfile::Scope scope(&this->profile_);
+  basis->clear();
+  const Span<const Sample> root = this->GetNodeData(0).signal;
+  return this->SearchBestBasis(0, 0, 0, cost.Evaluate(root), cost, basis);
+}
+
+template <class Sample, class Accumulator>
+double BasicWaveletPacketTree<Sample, Accumulator>::SearchBestBasis(
+    size_t node, size_t depth, size_t position, double node_cost,
+    const BasicBasisCost<Sample>& cost,
+    std::vector<BasicBasisNode<Sample>>* basis) {
+  if (!this->IsLeaf(node)) {
+    if (this->lazy_) {
+      this->DecomposeLazily(node);
+    } else {
+      this->DecomposeNodeTimed(node);
+    }
 
-  WaveletMath::Decompose(this->GetNodeData(node).signal,
-                         this->wavelet_->lowpassDecompositionFilter_,
-                         this->wavelet_->highpassDecompositionFilter_,
-                         &this->GetNodeData(left).signal,
-                         &this->GetNodeData(right).signal, this->dyadic_mode_,
-                         this->padding_mode_);
+    const size_t left = this->GetChild(node, ChildIndexLeft);
+    const size_t right = this->GetChild(node, ChildIndexRight);
+    const double left_cost = cost.Evaluate(this->GetNodeData(left).signal);
+    const double right_cost = cost.Evaluate(this->GetNodeData(right).signal);
 
-  this->DecomposeNode(left);
-  this->DecomposeNode(right);
+    // The subtrees below children which do not beat their parent are
+    // never decomposed.
+    if (left_cost + right_cost < node_cost) {
+      return this->SearchBestBasis(left, depth + 1, 2 * position, left_cost,
+                                   cost, basis) +
+             this->SearchBestBasis(right, depth + 1, 2 * position + 1,
+                                   right_cost, cost, basis);
+    }
+  }
+
+  basis->push_back(
+      {depth, position, node_cost, this->GetNodeData(node).signal});
+  return node_cost;
 }
 
-void WaveletPacketTree::ReconstructNode(size_t node) {
+template <class Sample, class Accumulator>
+void BasicWaveletPacketTree<Sample, Accumulator>::ThresholdLeaves(
+    const BasicThreshold<Sample>& threshold) {
+  assert(!this->GetNodeData(0).signal.empty());
+
+  const TreeProfile::Scope scope(&this->profile_);
+  // The root of a tree of height 1 is its only leaf.
+  this->CopyRootSignalView();
+  this->ReserveDenoiseSignals();
+  for (size_t leaf = this->GetFirstLeaf(); leaf <= this->GetLastLeaf();
+       leaf++) {
+    this->GetComputedSignal(leaf);
+    this->ThresholdLeaf(leaf, threshold, this->GetNodeData(leaf).signal);
+  }
+}
+
+template <class Sample, class Accumulator>
+void BasicWaveletPacketTree<Sample, Accumulator>::Denoise(
+    const BasicThreshold<Sample>& threshold) {
+  const TreeProfile::Scope scope(&this->profile_);
+  this->Denoise(threshold, this->GetReconstructedRoot());
+  this->ReleaseRootSignalView();
+}
+
+template <class Sample, class Accumulator>
+void BasicWaveletPacketTree<Sample, Accumulator>::Denoise(
+    const BasicThreshold<Sample>& threshold, Span<Sample> signal) {
+  assert(signal.size() == this->GetNodeData(0).signal.size());
+
+  const TreeProfile::Scope scope(&this->profile_);
+  // A lazy tree computes every leaf before signal, which may be the root,
+  // is written.
+  if (this->lazy_) {
+    for (size_t leaf = this->GetFirstLeaf(); leaf <= this->GetLastLeaf();
+         leaf++) {
+      this->GetComputedSignal(leaf);
+    }
+  }
+  this->ReserveDenoiseSignals();
+  this->DenoiseNode(0, 0, threshold, signal);
+}
+
+template <class Sample, class Accumulator>
+void BasicWaveletPacketTree<Sample, Accumulator>::DenoiseNode(
+    size_t node, size_t depth, const BasicThreshold<Sample>& threshold,
+    Span<Sample> signal) {
   if (this->IsLeaf(node)) {
+    this->ThresholdLeaf(node, threshold, signal);
     return;
   }
 
+  // Both children are denoised before the node is reconstructed from them
+  // in one go. The deeper buffers are free again by the time each child is
+  // done.
   const size_t left = this->GetChild(node, ChildIndexLeft);
   const size_t right = this->GetChild(node, ChildIndexRight);
+  const Span<Sample> approx_signal =
+      Span<Sample>(this->denoise_signals_[2 * depth]);
+  const Span<Sample> details_signal =
+      Span<Sample>(this->denoise_signals_[2 * depth + 1]);
+  const Span<Sample> scratch =
+      Span<Sample>(this->denoise_details_).subspan(0, signal.size());
+
+  this->DenoiseNode(left, depth + 1, threshold, approx_signal);
+  this->DenoiseNode(right, depth + 1, threshold, details_signal);
+
+  // Both children are reconstructed together, so the time is recorded
+  // under the approximation child.
+  const NodeTimer timer(&this->profile_, left, true);
+  this->ReconstructSignal(approx_signal, details_signal, signal, scratch,
+                          this->dyadic_mode_, this->padding_mode_);
+}
 
-  ReconstructNode(left);
-  ReconstructNode(right);
+template <class Sample, class Accumulator>
+void BasicWaveletPacketTree<Sample, Accumulator>::ThresholdLeaf(
+    size_t leaf, const BasicThreshold<Sample>& threshold,
+    Span<Sample> result) {
+  const Span<const Sample> coeffs = this->GetComputedSignal(leaf);
+  assert(result.size() == coeffs.size());
 
-  const std::vector<double>* child_signal = nullptr;
-  const std::vector<double>* reconstruction_filter = nullptr;
+  if (threshold.keep_approximation && leaf == this->GetFirstLeaf()) {
+    if (result.data() != coeffs.data()) {
+      std::copy(coeffs.begin(), coeffs.end(), result.begin());
+    }
+    return;
+  }
 
-  if (this->IsMarked(left)) {
-    assert(!this->IsMarked(right));
-    child_signal = &this->GetNodeData(left).signal;
-    reconstruction_filter = &this->wavelet_->lowpassReconstructionFilter_;
-  } else if (this->IsMarked(right)) {
-    assert(!this->IsMarked(left));
-    child_signal = &this->GetNodeData(right).signal;
-    reconstruction_filter = &this->wavelet_->highpassReconstructionFilter_;
+  // Each channel is gathered into the first part of the scratch memory and
+  // thresholded there by the threshold chosen from its own coefficients,
+  // exactly as a tree of that channel alone would threshold it.
+  const size_t channel_count = this->channel_count_;
+  if (channel_count > 1) {
+    const size_t size = coeffs.size() / channel_count;
+    const Span<Sample> channel =
+        Span<Sample>(this->denoise_details_).subspan(0, size);
+    const Span<Sample> scratch =
+        Span<Sample>(this->denoise_details_).subspan(size, size);
+    for (size_t c = 0; c < channel_count; c++) {
+      for (size_t i = 0; i < size; i++) {
+        channel[i] = coeffs[i * channel_count + c];
+      }
+      const double value = threshold.Select(channel, scratch);
+      WaveletMath::Threshold<Sample, Accumulator>(channel, value,
+                                                  threshold.rule, channel);
+      for (size_t i = 0; i < size; i++) {
+        result[i * channel_count + c] = channel[i];
+      }
+    }
+    return;
   }
 
-  if (child_signal != nullptr) {
-    this->SetMark(node);
+  // A separate result doubles as the scratch memory of the selection, which
+  // is done with it before the coefficients are shrunk into it.
+  const Span<Sample> scratch = result.data() == coeffs.data()
+                                   ? Span<Sample>(this->denoise_details_)
+                                   : result;
+  const double value = threshold.Select(coeffs, scratch);
+  WaveletMath::Threshold<Sample, Accumulator>(coeffs, value, threshold.rule,
+                                              result);
+}
 
-    auto& data = this->GetNodeData(node);
-    WaveletMath::Reconstruct(*child_signal, *reconstruction_filter,
-                             &data.signal, data.signal.size(),
-                             this->dyadic_mode_, this->padding_mode_);
+template <class Sample, class Accumulator>
+void BasicWaveletPacketTree<Sample, Accumulator>::ReserveDenoiseSignals() {
+  // Every node at a depth is as long as the others.
+  const size_t height = this->GetHeight();
+  size_t max_size = this->GetNodeData(0).signal.size();
+  this->denoise_signals_.resize(2 * (height - 1));
+  for (size_t depth = 1; depth < height; depth++) {
+    const size_t size =
+        this->GetNodeData(this->GetNodeAt(depth, 0)).signal.size();
+    this->denoise_signals_[2 * depth - 2].resize(size);
+    this->denoise_signals_[2 * depth - 1].resize(size);
+    max_size = std::max(max_size, size);
   }
+  this->denoise_details_.resize(max_size);
+}
+
+template <class Sample, class Accumulator>
+void BasicWaveletPacketTree<Sample, Accumulator>::DecomposeNodeSignal(
+    size_t node) {
+  const size_t left = this->GetChild(node, ChildIndexLeft);
+  const size_t right = this->GetChild(node, ChildIndexRight);
+
+  this->DecomposeSignal(this->GetNodeData(node).signal,
+                        this->GetNodeData(left).signal,
+                        this->GetNodeData(right).signal, this->dyadic_mode_,
+                        this->padding_mode_);
 }
 
+template class BasicWaveletPacketTree<double>;
+template class BasicWaveletPacketTree<float>;
+template class BasicWaveletPacketTree<float, double>;
+
 }  // namespace panwave
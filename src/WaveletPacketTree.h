@@ -7,6 +7,13 @@
 #ifndef WAVELETPACKETTREE_H
 #define WAVELETPACKETTREE_H
 
+#include <vector>
+
+#include "BasisCost.h"
+#include "AlignedAllocator.h"
+#include "Span.h"
+#include "StaticWavelet.h"
+#include "Threshold.h"
 #include "WaveletMath.h"
 #include "WaveletPacketTreeTemplateBase.h"
 
@@ -20,9 +27,14 @@ class Wavelet;
  * During decomposition, each node is decomposed into details and
  * approximation coefficients. The approximation coefficients are stored in
  * the left (0th) child while the details coefficients are stored in the
- * right (1st) child.
+ * right (1st) child.<br/>
+ * Template argument |Sample| is the type of the signal values and
+ * |Accumulator| the type the filters are applied in.
+ * @see WaveletPacketTreeTemplateBase
  */
-class WaveletPacketTree : public WaveletPacketTreeTemplateBase<2> {
+template <class Sample, class Accumulator = Sample>
+class BasicWaveletPacketTree
+    : public WaveletPacketTreeTemplateBase<2, Sample, Accumulator> {
  public:
   /**
    * Construct a WaveletPacketTree instance.<br/>
@@ -36,29 +48,173 @@ class WaveletPacketTree : public WaveletPacketTreeTemplateBase<2> {
    *                    convolutions. (default: Odd)
    * @param padding_mode How we should pad the signal data during
    *                     decomposition / reconstruction. (default: Zeroes)
+   * @param engine How the wavelet filters are applied. A wavelet which
+   *               cannot be factored into lifting steps, such as coif4, is
+   *               applied by convolution instead. (default: Convolution)
    * @see Wavelet
+   * @see GetTransformEngine
    * @see Decompose
    * @see Reconstruct
    */
-  WaveletPacketTree(size_t height, const Wavelet* wavelet,
-                    DyadicMode dyadic_mode = DyadicMode::Odd,
-                    PaddingMode padding_mode = PaddingMode::Zeroes);
-  ~WaveletPacketTree() override = default;
+  BasicWaveletPacketTree(size_t height, const Wavelet* wavelet,
+                         DyadicMode dyadic_mode = DyadicMode::Odd,
+                         PaddingMode padding_mode = PaddingMode::Zeroes,
+                         TransformEngine engine = TransformEngine::Convolution);
+
+  /**
+   * Construct a WaveletPacketTree instance using a compile-time wavelet.<br/>
+   * The tree uses the Wavelet object shared by all users of StaticWavelet
+   * type |wavelet|, which lives until the program exits.
+   * @see StaticWavelet
+   */
+  template <Wavelet::WaveletType Type, size_t VanishingMoment>
+  BasicWaveletPacketTree(size_t height,
+                         StaticWavelet<Type, VanishingMoment> /*wavelet*/,
+                         DyadicMode dyadic_mode = DyadicMode::Odd,
+                         PaddingMode padding_mode = PaddingMode::Zeroes,
+                         TransformEngine engine = TransformEngine::Convolution)
+      : BasicWaveletPacketTree(
+            height, &StaticWavelet<Type, VanishingMoment>::GetWavelet(),
+            dyadic_mode, padding_mode, engine) {}
+  ~BasicWaveletPacketTree() override = default;
 
-  void Decompose() override;
   void Reconstruct(size_t level) override;
+  void Reconstruct(size_t level, Span<Sample> signal) override;
+  void ReconstructAll(Span<Sample> levels) override;
+
+  /**
+   * Search greedily for a basis of packet nodes with a low cost,
+   * decomposing only the nodes the search visits.<br/>
+   * Starting at the root, a node is decomposed into its children and split
+   * when the children together cost less than it does. Each child is then
+   * searched the same way. Otherwise the node becomes part of the basis
+   * and nothing below it is computed. Leaves are never split.<br/>
+   * This prunes the tree top down, so it is not guaranteed to find the
+   * basis of lowest cost: a node is kept whenever its children cost more,
+   * even if its grandchildren would cost less. The bottom-up search of
+   * Coifman and Wickerhauser finds that basis, but has to decompose every
+   * node.<br/>
+   * The basis covers the whole signal exactly once. The coefficients of its
+   * nodes stay valid until the root signal is set or the tree is
+   * decomposed again. Nodes below the basis are not updated, so a tree
+   * which is not lazy has to be decomposed before reading them. The cost of
+   * a node of a multichannel tree covers every channel, so all of the
+   * channels share one basis.
+   * @param cost The additive cost to minimize.
+   * @param basis Destination for the nodes of the basis, from left to
+   *              right. Existing contents are overwritten.
+   * @return The total cost of the basis.
+   * @see BasicBasisCost
+   */
+  double DecomposeBestBasis(const BasicBasisCost<Sample>& cost,
+                            std::vector<BasicBasisNode<Sample>>* basis);
+
+  /**
+   * Threshold the coefficients of every leaf in place.<br/>
+   * Each leaf is shrunk by the threshold chosen from its own coefficients.
+   * The leaves keep the shrunk coefficients until the tree is decomposed
+   * again, so every later reconstruction is denoised. Each channel of a
+   * multichannel tree is thresholded by the threshold chosen from its own
+   * coefficients, as a tree of that channel alone would threshold it.<br/>
+   * A tree which is not lazy must have been decomposed.
+   * @param threshold How the leaves are thresholded.
+   * @see Denoise
+   */
+  void ThresholdLeaves(const BasicThreshold<Sample>& threshold);
+
+  /**
+   * Reconstruct the root signal from thresholded leaves, leaving the
+   * decomposed tree untouched.<br/>
+   * Thresholding is fused into the reconstruction. Each leaf is shrunk as
+   * ThresholdLeaves would shrink it straight into a scratch buffer, and
+   * each node below the root is reconstructed once from both of its
+   * children. The result equals thresholding the leaves and adding up the
+   * reconstructions of every wavelet level, but each node is reconstructed
+   * once rather than once per leaf below it.<br/>
+   * A tree which is not lazy must have been decomposed.
+   * @param threshold How the leaves are thresholded.
+   * @see Reconstruct
+   */
+  void Denoise(const BasicThreshold<Sample>& threshold);
+
+  /**
+   * Reconstruct a signal from thresholded leaves into a buffer of the
+   * caller.<br/>
+   * The buffer receives the signal Denoise(threshold) would leave in the
+   * root signal. Neither the root signal nor the decomposed node signals
+   * are modified.
+   * @param threshold How the leaves are thresholded.
+   * @param signal Destination for the denoised signal. Must hold as many
+   *               elements as the root signal and must not overlap any
+   *               node of the tree.
+   * @see Denoise
+   */
+  void Denoise(const BasicThreshold<Sample>& threshold, Span<Sample> signal);
 
  protected:
-  void IsolateLevel(size_t level);
+  DyadicMode GetChildDyadicMode(size_t child_index) const override;
+  CoefficientType GetChildCoefficientType(
+      size_t child_index) const override;
+  PaddingMode GetPaddingMode() const override { return this->padding_mode_; }
 
-  void DecomposeNode(size_t node);
-  void ReconstructNode(size_t node);
+  void DecomposeNodeSignal(size_t node) override;
+
+  /**
+   * Construct a tree decomposing |channel_count| interleaved signals at
+   * once with the convolution engine.
+   * @see BasicMultichannelWaveletPacketTree
+   */
+  BasicWaveletPacketTree(size_t height, const Wavelet* wavelet,
+                         size_t channel_count, DyadicMode dyadic_mode,
+                         PaddingMode padding_mode);
 
  private:
+  /**
+   * Add the greedily pruned basis of the subtree below node to basis.
+   * @param node_cost The cost of the coefficients of node.
+   * @return The total cost of the nodes added.
+   */
+  double SearchBestBasis(size_t node, size_t depth, size_t position,
+                         double node_cost, const BasicBasisCost<Sample>& cost,
+                         std::vector<BasicBasisNode<Sample>>* basis);
+
+  /**
+   * Write the signal the subtree below node reconstructs from thresholded
+   * leaves into signal.
+   * @param depth The depth of node.
+   */
+  void DenoiseNode(size_t node, size_t depth,
+                   const BasicThreshold<Sample>& threshold,
+                   Span<Sample> signal);
+
+  /**
+   * Write the thresholded coefficients of leaf into result, which may be
+   * the signal of the leaf itself.
+   */
+  void ThresholdLeaf(size_t leaf, const BasicThreshold<Sample>& threshold,
+                     Span<Sample> result);
+
+  /**
+   * Size the buffers Denoise works in for the current root signal.
+   */
+  void ReserveDenoiseSignals();
+
   DyadicMode dyadic_mode_;
   PaddingMode padding_mode_;
+  // The reconstructed signals of the approximation and details children of
+  // a node at each depth below the root, in that order, while denoising.
+  std::vector<AlignedVector<Sample>> denoise_signals_;
+  // The reconstruction of the details child of a node while denoising with
+  // convolution, and the scratch memory of threshold selection. As long as
+  // the largest node.
+  AlignedVector<Sample> denoise_details_;
 };
 
+/**
+ * A wavelet packet tree of double signals.
+ */
+using WaveletPacketTree = BasicWaveletPacketTree<double>;
+
 }  // namespace panwave
 
 #endif  // WAVELETPACKETTREE_H
@@ -9,31 +9,40 @@
 
 #include <vector>
 
+#include "Span.h"
 #include "Tree.h"
 
 namespace panwave {
 
+class TaskScheduler;
+
 /**
  * Base class for all wavelet packet tree specialization types.<br/>
  * This abstract class is an interface to hold methods common to
- * various wavelet packet trees.
+ * various wavelet packet trees.<br/>
+ * Template argument |Sample| is the type of the signal values held by the
+ * tree, either double or float.
  */
-class WaveletPacketTreeBase {
+template <class Sample>
+class BasicWaveletPacketTreeBase {
  public:
-  WaveletPacketTreeBase(const WaveletPacketTreeBase&) = delete;
-  WaveletPacketTreeBase(const WaveletPacketTreeBase&&) = delete;
-  WaveletPacketTreeBase& operator=(const WaveletPacketTreeBase&) = delete;
-  WaveletPacketTreeBase& operator=(const WaveletPacketTreeBase&&) = delete;
+  BasicWaveletPacketTreeBase(const BasicWaveletPacketTreeBase&) = delete;
+  BasicWaveletPacketTreeBase(const BasicWaveletPacketTreeBase&&) = delete;
+  BasicWaveletPacketTreeBase& operator=(const BasicWaveletPacketTreeBase&) =
+      delete;
+  BasicWaveletPacketTreeBase& operator=(const BasicWaveletPacketTreeBase&&) =
+      delete;
 
-  WaveletPacketTreeBase() = default;
-  virtual ~WaveletPacketTreeBase() = default;
+  BasicWaveletPacketTreeBase() = default;
+  virtual ~BasicWaveletPacketTreeBase() = default;
 
   /**
    * This struct is just a container used to hold the signal data for each
-   * node in the wavelet packet tree.
+   * node in the wavelet packet tree.<br/>
+   * The signal is a view into storage owned by the tree.
    */
   struct WaveletPacketTreeNodeData {
-    std::vector<double> signal;
+    Span<Sample> signal;
   };
 
   /**
@@ -41,11 +50,39 @@ class WaveletPacketTreeBase {
    * Starting with the root node, decomposes recursively every node in
    * the tree stopping at the leaf nodes.<br/>
    * This is not a sparse decomposition, all nodes will have decomposed
-   * signal data after executing.
+   * signal data after executing, unless the tree decomposes lazily.
    * @see SetRootSignal
    */
   virtual void Decompose() = 0;
 
+  /**
+   * The default minimum number of coefficients a subtree must produce before
+   * a parallel decomposition runs it as a separate task.
+   * @see SetTaskScheduler
+   */
+  static constexpr size_t DefaultGrainSize = 1 << 15;
+
+  /**
+   * Make Decompose run independent subtrees in parallel.<br/>
+   * Once a node has been decomposed, the subtrees below its children are
+   * spawned as tasks on scheduler. Subtrees producing fewer than grain_size
+   * coefficients are decomposed serially by the task which reached them,
+   * so the many small nodes near the leaves are not scheduled one by
+   * one.<br/>
+   * The result is identical to a serial decomposition. Each thread outside
+   * of scheduler which drives the tree reserves its scratch memory the
+   * first time it does, after which it allocates no more than a serial
+   * tree would.
+   * @param scheduler Scheduler to run tasks on, or nullptr to decompose
+   *                  serially, which is how trees start out. Must outlive
+   *                  the tree or a later call with nullptr.
+   * @param grain_size Minimum size of a task, in coefficients.
+   *                   DefaultGrainSize suits most signals.
+   * @see Decompose
+   */
+  virtual void SetTaskScheduler(TaskScheduler* scheduler,
+                                size_t grain_size) = 0;
+
   /**
    * Reconstruct an isolated wavelet level.<br/>
    * Beginning at the leaf nodes, recursively reconstruct up all levels
@@ -57,6 +94,31 @@ class WaveletPacketTreeBase {
    */
   virtual void Reconstruct(size_t level) = 0;
 
+  /**
+   * Reconstruct an isolated wavelet level into a buffer of the caller.<br/>
+   * The buffer receives the signal Reconstruct(level) would leave in the
+   * root signal. Neither the root signal nor the decomposed node signals
+   * are modified.
+   * @param level The wavelet level we should isolate and reconstruct.
+   * @param signal Destination for the reconstructed signal. Must hold as
+   *               many elements as the root signal and must not overlap any
+   *               node of the tree.
+   * @see Reconstruct
+   */
+  virtual void Reconstruct(size_t level, Span<Sample> signal) = 0;
+
+  /**
+   * Reconstruct every wavelet level at once.<br/>
+   * Row i of levels receives the signal Reconstruct(i) would leave in the
+   * root signal. Unlike Reconstruct, neither the root signal nor the
+   * decomposed node signals are modified.
+   * @param levels Destination matrix of GetWaveletLevelCount() rows of
+   *               GetRootSignal().size() samples each, stored row after
+   *               row. Existing contents are overwritten.
+   * @see Reconstruct
+   */
+  virtual void ReconstructAll(Span<Sample> levels) = 0;
+
   /**
    * Set the root node signal.<br/>
    * This signal data is used during decomposition to construct all
@@ -64,13 +126,40 @@ class WaveletPacketTreeBase {
    * @param signal Values from signal are copied into the root node.
    * @see Decompose
    */
-  virtual void SetRootSignal(const std::vector<double>& signal) = 0;
+  virtual void SetRootSignal(const std::vector<Sample>& signal) = 0;
+
+  /**
+   * Set the root node signal to a buffer of the caller without copying
+   * it.<br/>
+   * The tree reads the root signal straight from the buffer, which must
+   * stay valid and unchanged until the next call to SetRootSignal or
+   * SetRootSignalView. The tree never writes to it. Reconstruct(level)
+   * reconstructs into a root signal of the tree's own instead, which
+   * replaces the view. GetRootSignal and UpdateRootSignal copy the view
+   * into the tree first.
+   * @param signal The root signal.
+   * @see SetRootSignal
+   */
+  virtual void SetRootSignalView(Span<const Sample> signal) = 0;
+
+  /**
+   * Overwrite part of the root signal and update the decomposition to
+   * match.<br/>
+   * Only the coefficients whose filter windows read the changed samples,
+   * directly or through their ancestors, are recomputed. Afterwards every
+   * node holds what decomposing the updated root signal from scratch
+   * would give it, so the tree must have been decomposed first.
+   * @param begin Index of the first root signal value to overwrite.
+   * @param samples The new values. The root signal is not resized.
+   * @see SetRootSignal
+   */
+  virtual void UpdateRootSignal(size_t begin, Span<const Sample> samples) = 0;
 
   /**
    * Get a read-only view of the root node signal data.
    * @see Reconstruct
    */
-  virtual const std::vector<double>& GetRootSignal() = 0;
+  virtual const std::vector<Sample>& GetRootSignal() = 0;
 
   /**
    * Get the number of wavelet levels this tree is capable of
@@ -79,6 +168,11 @@ class WaveletPacketTreeBase {
   virtual size_t GetWaveletLevelCount() const = 0;
 };
 
+/**
+ * The base class of wavelet packet trees holding double signals.
+ */
+using WaveletPacketTreeBase = BasicWaveletPacketTreeBase<double>;
+
 }  // namespace panwave
 
 #endif  // WAVELETPACKETTREEBASE_H
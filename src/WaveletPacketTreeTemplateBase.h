@@ -7,45 +7,944 @@
 #ifndef WAVELETPACKETTREETEMPLATEBASE_H
 #define WAVELETPACKETTREETEMPLATEBASE_H
 
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <string>
 #include <vector>
 
+#include "AlignedAllocator.h"
+#include "Instrumentation.h"
+#include "LiftingScheme.h"
+#include "Span.h"
+#include "TaskScheduler.h"
 #include "Tree.h"
+#include "TreeFile.h"
+#include "Wavelet.h"
+#include "WaveletMath.h"
 #include "WaveletPacketTreeBase.h"
 
 namespace panwave {
 
-class Wavelet;
-
 /**
  * A templated base class from which specialized wavelet packet tree
  * implementations can derive.<br/>
- * Template argument |k| is the number of children per node.
+ * Template argument |k| is the number of children per node.<br/>
+ * Template argument |Sample| is the type of the signal values and
+ * |Accumulator| the type the filters are applied in. The wavelet filters are
+ * converted to Accumulator once, when the tree is constructed. Lifting
+ * always accumulates in double.<br/>
+ * The coefficients of every node below the root are kept in a single
+ * aligned buffer, node after node in tree order, each beginning on a
+ * SignalAlignment boundary. The buffer is laid out when a root signal of a
+ * new length is set. Setting further root signals of the same length only
+ * copies the signal.<br/>
+ * A tree may decompose several signals together. The root signal then
+ * holds channel_count signals of the same length, interleaved so element i
+ * of channel c is at index i * channel_count + c, and every node holds the
+ * coefficients of all channels interleaved the same way.<br/>
+ * In lazy mode the nodes are not decomposed by Decompose. A node is
+ * decomposed, along with any ancestors which are not yet, the first time
+ * the coefficients of one of its children are needed, and each node only
+ * holds storage once it has been computed.
+ * @see SetLazyDecomposition
  */
-template <size_t k>
+template <size_t k, class Sample = double, class Accumulator = Sample>
 class WaveletPacketTreeTemplateBase
-    : public Tree<WaveletPacketTreeBase::WaveletPacketTreeNodeData, k>,
-      public WaveletPacketTreeBase {
+    : public Tree<typename BasicWaveletPacketTreeBase<
+                      Sample>::WaveletPacketTreeNodeData,
+                  k>,
+      public BasicWaveletPacketTreeBase<Sample> {
  public:
-  WaveletPacketTreeTemplateBase(size_t height, const Wavelet* wavelet)
-      : Tree<WaveletPacketTreeNodeData, k>(height),
-        WaveletPacketTreeBase(),
-        wavelet_(wavelet) {}
+  using NodeData =
+      typename BasicWaveletPacketTreeBase<Sample>::WaveletPacketTreeNodeData;
+
+  WaveletPacketTreeTemplateBase(
+      size_t height, const Wavelet* wavelet,
+      TransformEngine engine = TransformEngine::Convolution,
+      size_t channel_count = 1)
+      : Tree<NodeData, k>(height),
+        BasicWaveletPacketTreeBase<Sample>(),
+        wavelet_(wavelet),
+        engine_(engine),
+        channel_count_(channel_count),
+        lowpass_decomposition_filter_(
+            wavelet->lowpassDecompositionFilter_.cbegin(),
+            wavelet->lowpassDecompositionFilter_.cend()),
+        highpass_decomposition_filter_(
+            wavelet->highpassDecompositionFilter_.cbegin(),
+            wavelet->highpassDecompositionFilter_.cend()),
+        lowpass_reconstruction_filter_(
+            wavelet->lowpassReconstructionFilter_.cbegin(),
+            wavelet->lowpassReconstructionFilter_.cend()),
+        highpass_reconstruction_filter_(
+            wavelet->highpassReconstructionFilter_.cbegin(),
+            wavelet->highpassReconstructionFilter_.cend()),
+        workspaces_(1) {
+    // Lifting only transforms a single channel.
+    assert(channel_count > 0);
+    assert(engine == TransformEngine::Convolution || channel_count == 1);
 
-  void SetRootSignal(const std::vector<double>& signal) override {
-    auto& data = this->GetNodeData(0);
-    data.signal.assign(signal.cbegin(), signal.cend());
+    // A wavelet which cannot be factored into lifting steps is applied by
+    // convolution, which GetTransformEngine reports.
+    if (this->engine_ == TransformEngine::Lifting &&
+        !LiftingScheme::Factor(*this->wavelet_, &this->lifting_scheme_)) {
+      this->engine_ = TransformEngine::Convolution;
+    }
+
+    if (InstrumentationEnabled) {
+      this->profile_.SetShape(k, this->GetLastLeaf() + 1);
+    }
   }
 
-  const std::vector<double>& GetRootSignal() override {
-    return this->GetNodeData(0).signal;
+  void Decompose() override {
+    const TreeProfile::Scope scope(&this->profile_);
+    // Lazy trees decompose each node when its children are first read.
+    if (!this->lazy_) {
+      this->DecomposeNode(0);
+    }
+  }
+
+  void SetRootSignal(const std::vector<Sample>& signal) override {
+    const TreeProfile::Scope scope(&this->profile_);
+    this->root_signal_.assign(signal.cbegin(), signal.cend());
+    this->root_view_ = false;
+    this->SetRoot(Span<Sample>(this->root_signal_));
+  }
+
+  void SetRootSignalView(Span<const Sample> signal) override {
+    const TreeProfile::Scope scope(&this->profile_);
+    // The root of a tree is only ever read, never written, while it is a
+    // view.
+    this->root_view_ = true;
+    this->SetRoot(
+        Span<Sample>(const_cast<Sample*>(signal.data()), signal.size()));
+  }
+
+  void UpdateRootSignal(size_t begin, Span<const Sample> samples) override {
+    assert(begin + samples.size() <= this->GetNodeData(0).signal.size());
+
+    const TreeProfile::Scope scope(&this->profile_);
+    this->CopyRootSignalView();
+    std::copy(samples.begin(), samples.end(),
+              this->root_signal_.begin() + static_cast<ptrdiff_t>(begin));
+    if (samples.empty()) {
+      return;
+    }
+
+    // Each position of a node holds one sample of every channel.
+    const size_t channel_count = this->channel_count_;
+    this->UpdateNode(0, begin / channel_count,
+                     (begin + samples.size() + channel_count - 1) /
+                         channel_count);
+  }
+
+  const std::vector<Sample>& GetRootSignal() override {
+    const TreeProfile::Scope scope(&this->profile_);
+    this->CopyRootSignalView();
+    return this->root_signal_;
+  }
+
+  void SetTaskScheduler(TaskScheduler* scheduler,
+                        size_t grain_size) override {
+    const TreeProfile::Scope scope(&this->profile_);
+    this->scheduler_ = scheduler;
+    this->grain_size_ = grain_size;
+
+    // Tasks may run on any worker, each of which needs its own scratch
+    // memory.
+    this->workspaces_.resize(
+        scheduler == nullptr ? 1 : scheduler->GetWorkerCount());
+    this->ReserveWorkspaces();
   }
 
   size_t GetWaveletLevelCount() const override {
     return static_cast<size_t>(std::pow(2, this->GetHeight() - 1));
   }
 
+  /**
+   * Choose whether nodes are decomposed when they are first read instead
+   * of by Decompose.<br/>
+   * A lazy tree computes a node, and every ancestor not yet computed, the
+   * first time GetNodeSignal or a reconstruction reads it, then keeps it
+   * until the next call to SetRootSignal. Nodes which are never read are
+   * never computed or allocated. Reading a few leaves of a tall tree costs
+   * a few paths from the root rather than the whole tree.<br/>
+   * Reading any node decomposes the root first, so the nodes are computed
+   * from the signal last passed to SetRootSignal even after Reconstruct has
+   * overwritten the root signal. Lazy decomposition ignores the task
+   * scheduler. Trees start out eager, call
+   * Decompose again after switching back.
+   * @see GetNodeSignal
+   */
+  void SetLazyDecomposition(bool lazy) {
+    if (lazy == this->lazy_) {
+      return;
+    }
+
+    const TreeProfile::Scope scope(&this->profile_);
+    this->lazy_ = lazy;
+    // Every node of a mapped tree is already computed.
+    if (!this->GetNodeData(0).signal.empty() &&
+        this->mapped_file_ == nullptr) {
+      this->LayoutNodes();
+    }
+  }
+
+  /**
+   * Get the coefficients held by a node.<br/>
+   * A lazy tree decomposes whatever the node is computed from first. Other
+   * trees must have been decomposed since the root signal was set.
+   * @param depth The depth of the node. The root has depth 0 and the leaves
+   *              depth GetHeight() - 1.
+   * @param position The position of the node among the k^depth nodes at
+   *                 its depth, from left to right. A leaf of a
+   *                 WaveletPacketTree holds wavelet level position.
+   * @see SetLazyDecomposition
+   */
+  Span<const Sample> GetNodeSignal(size_t depth, size_t position) {
+    const TreeProfile::Scope scope(&this->profile_);
+    return this->GetComputedSignal(this->GetNodeAt(depth, position));
+  }
+
+  /**
+   * Write the wavelet, modes, shape and the coefficients of every node to a
+   * file which can later be mapped by a tree of the same kind.<br/>
+   * A tree which is not lazy must have been decomposed. The root is written
+   * as the root signal is now, so save a tree before Reconstruct overwrites
+   * it. A lazy tree first decomposes every node it has not computed yet.
+   * @param path Path of the file, which is replaced if it exists.
+   * @return False if the file could not be written.
+   * @see TreeFile
+   * @see MapFile
+   */
+  bool Save(const std::string& path) {
+    assert(!this->GetNodeData(0).signal.empty());
+
+    const TreeProfile::Scope scope(&this->profile_);
+    const size_t node_count = this->GetLastLeaf() + 1;
+    std::vector<Span<const char>> nodes(node_count);
+    for (size_t node = 0; node < node_count; node++) {
+      const Span<const Sample> signal = this->GetComputedSignal(node);
+      nodes[node] = Span<const char>(
+          reinterpret_cast<const char*>(signal.data()),
+          signal.size() * sizeof(Sample));
+    }
+
+    const TreeFile::Description description = {
+        k,
+        this->GetHeight(),
+        this->channel_count_,
+        sizeof(Sample),
+        this->GetChildDyadicMode(0),
+        this->GetPaddingMode(),
+        this->engine_};
+    return TreeFile::Write(path, description, *this->wavelet_, nodes);
+  }
+
+  /**
+   * Read the root signal and every node from a mapped file without
+   * decomposing.<br/>
+   * The nodes point into the mapping instead of being copied, so the pages
+   * of a node are only read from the file when the node is. Reconstruct,
+   * ReconstructAll and GetNodeSignal work directly off the mapped
+   * coefficients. Only the root signal is copied, since Reconstruct
+   * overwrites it. The file must stay open until the next call to
+   * SetRootSignal, which moves the nodes back into memory owned by the
+   * tree.<br/>
+   * The file must have been saved by a tree with the same number of
+   * children, height, channel count, sample type, modes, transform engine
+   * and decomposition filters as this one. A tree constructed with the
+   * wavelet, modes and engine the file describes matches it.
+   * @param file An open file.
+   * @return False if the file holds a different kind of tree. The tree is
+   * not changed in this case.
+   * @see Save
+   * @see TreeFile::GetDescription
+   */
+  bool MapFile(TreeFile* file) {
+    assert(file->IsOpen());
+
+    const TreeFile::Description& description = file->GetDescription();
+    if (description.children != k ||
+        description.height != this->GetHeight() ||
+        description.channel_count != this->channel_count_ ||
+        description.sample_size != sizeof(Sample) ||
+        description.dyadic_mode != this->GetChildDyadicMode(0) ||
+        description.padding_mode != this->GetPaddingMode() ||
+        description.engine != this->engine_ ||
+        file->GetWavelet().lowpassDecompositionFilter_ !=
+            this->wavelet_->lowpassDecompositionFilter_ ||
+        file->GetWavelet().highpassDecompositionFilter_ !=
+            this->wavelet_->highpassDecompositionFilter_) {
+      return false;
+    }
+
+    // Every node must be as long as decomposing the root would make it.
+    const Span<const Sample> root = file->GetNodeSignal<Sample>(0);
+    if (root.empty() || root.size() % this->channel_count_ != 0) {
+      return false;
+    }
+    std::vector<size_t> sizes(file->GetNodeCount());
+    sizes[0] = root.size();
+    for (size_t node = 1; node < sizes.size(); node++) {
+      sizes[node] = this->GetChildSignalSize(sizes[this->GetParent(node)],
+                                             this->GetChildIndex(node));
+      if (file->GetNodeSignal<Sample>(node).size() != sizes[node]) {
+        return false;
+      }
+    }
+
+    const TreeProfile::Scope scope(&this->profile_);
+    this->mapped_file_ = file;
+    this->root_signal_.assign(root.begin(), root.end());
+    this->root_view_ = false;
+    this->GetNodeData(0).signal = Span<Sample>(this->root_signal_);
+    this->LayoutNodes();
+    for (size_t node = 1; node < sizes.size(); node++) {
+      this->GetNodeData(node).signal = file->GetNodeSignal<Sample>(node);
+    }
+    std::fill(this->decomposed_.begin(), this->decomposed_.end(), true);
+    return true;
+  }
+
+  /**
+   * Get the counts and timings of the work done by this tree since it was
+   * constructed or the profile was last reset.<br/>
+   * The profile stays empty unless panwave is built with
+   * PANWAVE_INSTRUMENTATION defined.
+   * @see TreeProfile
+   */
+  const TreeProfile& GetProfile() const { return this->profile_; }
+
+  /**
+   * Get how the wavelet filters are applied. A tree constructed with
+   * TransformEngine::Lifting uses convolution if its wavelet cannot be
+   * factored into lifting steps.
+   * @see LiftingScheme::Factor
+   */
+  TransformEngine GetTransformEngine() const { return this->engine_; }
+
+  /**
+   * Zero the counters of the profile of this tree.
+   */
+  void ResetProfile() { this->profile_.Reset(); }
+
  protected:
+  /**
+   * Make root the signal of the root node. The nodes are laid out again if
+   * its length changed.
+   */
+  void SetRoot(Span<Sample> root) {
+    // A mapped tree moves its nodes back into memory of its own.
+    const Span<Sample> previous = this->GetNodeData(0).signal;
+    const bool resized = root.size() != previous.size() ||
+                         previous.empty() || this->mapped_file_ != nullptr;
+    this->mapped_file_ = nullptr;
+    this->GetNodeData(0).signal = root;
+    if (resized) {
+      this->LayoutNodes();
+    } else {
+      // Every node was computed from the previous signal.
+      std::fill(this->decomposed_.begin(), this->decomposed_.end(), false);
+    }
+  }
+
+  /**
+   * Copy a root signal view into the root signal of the tree, which
+   * becomes the root.
+   * @see SetRootSignalView
+   */
+  void CopyRootSignalView() {
+    if (this->root_view_) {
+      const Span<const Sample> view = this->GetNodeData(0).signal;
+      this->root_signal_.assign(view.begin(), view.end());
+      this->ReleaseRootSignalView();
+    }
+  }
+
+  /**
+   * Get the buffer Reconstruct(level) writes the root signal to.<br/>
+   * A view is never written, so a tree whose root is a view reconstructs
+   * into a root signal of its own, which replaces the view once
+   * ReleaseRootSignalView is called.
+   */
+  Span<Sample> GetReconstructedRoot() {
+    if (this->root_view_) {
+      this->root_signal_.resize(this->GetNodeData(0).signal.size());
+      return Span<Sample>(this->root_signal_);
+    }
+    return this->GetNodeData(0).signal;
+  }
+
+  /**
+   * Make the root signal of the tree the root again in place of a view.
+   */
+  void ReleaseRootSignalView() {
+    if (this->root_view_) {
+      this->GetNodeData(0).signal = Span<Sample>(this->root_signal_);
+      this->root_view_ = false;
+    }
+  }
+
+  /**
+   * Get the dyadic mode used to decompose a node into its child with index
+   * |child_index|.
+   */
+  virtual DyadicMode GetChildDyadicMode(size_t child_index) const = 0;
+
+  /**
+   * Get which coefficients of its parent's decomposition the child with
+   * index |child_index| holds.
+   */
+  virtual CoefficientType GetChildCoefficientType(
+      size_t child_index) const = 0;
+
+  /**
+   * Get the padding mode used to decompose and reconstruct the nodes.
+   */
+  virtual PaddingMode GetPaddingMode() const = 0;
+
+  /**
+   * Get the number of samples in the signal of the child with index
+   * |child_index| of a node whose signal holds |parent_size| samples.
+   */
+  virtual size_t GetChildSignalSize(size_t parent_size,
+                                    size_t child_index) const {
+    const size_t channel_count = this->channel_count_;
+    return WaveletMath::GetDecomposedSize(
+               parent_size / channel_count,
+               this->lowpass_decomposition_filter_.size(),
+               this->GetChildDyadicMode(child_index),
+               this->GetPaddingMode()) *
+           channel_count;
+  }
+
+  /**
+   * Decompose the signal of node, which is not a leaf, into the signals of
+   * its children.
+   */
+  virtual void DecomposeNodeSignal(size_t node) = 0;
+
+  /**
+   * Decompose the signal of node into the signals of its children, timing
+   * the decomposition in the profile of the tree.
+   */
+  void DecomposeNodeTimed(size_t node) {
+    const NodeTimer timer(&this->profile_, node, false);
+    this->DecomposeNodeSignal(node);
+  }
+
+  /**
+   * Decompose node into its children, then each child into its subtree.
+   */
+  void DecomposeNode(size_t node) {
+    if (this->IsLeaf(node)) {
+      return;
+    }
+
+    this->DecomposeNodeTimed(node);
+    this->DecomposeChildren(node);
+  }
+
+  /**
+   * Recompute the coefficients below node which depend on the positions of
+   * its signal in [begin, end).<br/>
+   * Only the outputs which read the range are recomputed, at each level,
+   * with either transform engine and any number of channels.
+   * @see WaveletMath::GetDecomposedRange
+   */
+  virtual void UpdateNode(size_t node, size_t begin, size_t end) {
+    // A lazy tree computes the nodes it has not yet from the updated
+    // signal when they are read.
+    if (this->IsLeaf(node) || (this->lazy_ && !this->decomposed_[node])) {
+      return;
+    }
+
+    const Span<const Sample> signal = this->GetNodeData(node).signal;
+    const size_t size = signal.size() / this->channel_count_;
+    const size_t filter_size = this->lowpass_decomposition_filter_.size();
+    const bool lifting = this->channel_count_ == 1 &&
+                         this->engine_ == TransformEngine::Lifting;
+    const NodeTimer timer(&this->profile_, node, false);
+
+    // Each approximation child is decomposed along with the details child
+    // which uses the same dyadic mode. The children are updated once this
+    // node is done, so its time does not include theirs.
+    size_t child_begin[k] = {};
+    size_t child_end[k] = {};
+    for (size_t i = 0; i < k; i++) {
+      if (this->GetChildCoefficientType(i) != CoefficientType::Approximation) {
+        continue;
+      }
+
+      const DyadicMode dyadic_mode = this->GetChildDyadicMode(i);
+      size_t j = 0;
+      while (this->GetChildCoefficientType(j) != CoefficientType::Details ||
+             this->GetChildDyadicMode(j) != dyadic_mode) {
+        j++;
+        assert(j < k);
+      }
+
+      size_t output_begin = 0;
+      size_t output_end = 0;
+      if (lifting) {
+        WaveletMath::GetDecomposedRange(size, begin, end,
+                                        this->lifting_scheme_, dyadic_mode,
+                                        this->GetPaddingMode(), &output_begin,
+                                        &output_end);
+      } else {
+        WaveletMath::GetDecomposedRange(size, begin, end, filter_size,
+                                        dyadic_mode, this->GetPaddingMode(),
+                                        &output_begin, &output_end);
+      }
+
+      if (output_end > output_begin) {
+        const size_t channel_count = this->channel_count_;
+        const size_t offset = output_begin * channel_count;
+        const size_t count = (output_end - output_begin) * channel_count;
+        this->DecomposeSignalRange(
+            signal,
+            this->GetNodeData(this->GetChild(node, i))
+                .signal.subspan(offset, count),
+            this->GetNodeData(this->GetChild(node, j))
+                .signal.subspan(offset, count),
+            output_begin, dyadic_mode, this->GetPaddingMode());
+      }
+
+      child_begin[i] = child_begin[j] = output_begin;
+      child_end[i] = child_end[j] = output_end;
+    }
+
+    for (size_t i = 0; i < k; i++) {
+      this->UpdateNode(this->GetChild(node, i), child_begin[i], child_end[i]);
+    }
+  }
+
+  /**
+   * Get the signal of node, decomposing it first if the tree is lazy.
+   * @see GetNodeSignal
+   */
+  Span<const Sample> GetComputedSignal(size_t node) {
+    if (this->lazy_ && node != 0) {
+      this->DecomposeLazily(this->GetParent(node));
+    }
+    return this->GetNodeData(node).signal;
+  }
+
+  /**
+   * Decompose node into its children unless a lazy tree already has,
+   * decomposing its ancestors first where they have not been.
+   */
+  void DecomposeLazily(size_t node) {
+    if (this->decomposed_[node]) {
+      return;
+    }
+    if (node != 0) {
+      this->DecomposeLazily(this->GetParent(node));
+    }
+
+    // The children keep their storage until the root signal changes length
+    // so setting another signal does not allocate again. Children placed by
+    // PlaceNodes already have storage.
+    for (size_t i = 0; i < k; i++) {
+      const size_t child = this->GetChild(node, i);
+      auto& signal = this->GetNodeData(child).signal;
+      if (signal.data() == nullptr) {
+        auto& storage = this->node_storage_[child];
+        storage.resize(signal.size());
+        signal = Span<Sample>(storage.data(), storage.size());
+      }
+    }
+
+    this->DecomposeNodeTimed(node);
+    this->decomposed_[node] = true;
+  }
+
+  /**
+   * Decompose the subtrees below each child of node.<br/>
+   * With a task scheduler set, every child subtree producing at least
+   * grain_size_ coefficients but the last is spawned as a task. The last is
+   * decomposed by the calling thread, which then helps with the remaining
+   * tasks until they are done.
+   * @see SetTaskScheduler
+   */
+  void DecomposeChildren(size_t node) {
+    const size_t first_child = this->GetChild(node, 0);
+
+    if (this->scheduler_ == nullptr ||
+        this->GetSubtreeCoefficientCount(first_child) < this->grain_size_) {
+      for (size_t i = 0; i < k; i++) {
+        this->DecomposeNode(first_child + i);
+      }
+      return;
+    }
+
+    const auto decompose_task = [](void* context, size_t child) {
+      auto* tree = static_cast<WaveletPacketTreeTemplateBase*>(context);
+      const TreeProfile::Scope scope(&tree->profile_);
+      tree->DecomposeNode(child);
+    };
+
+    TaskScheduler::TaskGroup group;
+    for (size_t i = 0; i + 1 < k; i++) {
+      this->scheduler_->Spawn(&group, {decompose_task, this, first_child + i});
+    }
+    this->DecomposeNode(first_child + k - 1);
+    this->scheduler_->Wait(&group);
+  }
+
+  /**
+   * Get the number of coefficients held by node and all of its
+   * descendants.<br/>
+   * The nodes at a depth are all as long as each other, so each level of
+   * the subtree is sized from one node of the level above it.
+   */
+  size_t GetSubtreeCoefficientCount(size_t node) {
+    size_t depth = 0;
+    for (size_t ancestor = node; ancestor != 0;
+         ancestor = this->GetParent(ancestor)) {
+      depth++;
+    }
+
+    size_t node_size = this->GetNodeData(node).signal.size();
+    size_t level_node_count = 1;
+    size_t count = node_size;
+    for (size_t level = depth + 1; level < this->GetHeight(); level++) {
+      node_size = this->GetChildSignalSize(node_size, 0);
+      level_node_count *= k;
+      count += node_size * level_node_count;
+    }
+    return count;
+  }
+
+  /**
+   * Size the nodes for the current root signal and point them into the node
+   * buffer.
+   */
+  void LayoutNodes() {
+    const size_t node_count = this->GetLastLeaf() + 1;
+
+    assert(this->GetNodeData(0).signal.size() % this->channel_count_ == 0);
+    this->decomposed_.assign(node_count, false);
+
+    // Each node is sized from its parent, which comes before it. Record the
+    // sizes first and place the nodes once they are all known.
+    // ReconstructPath reconstructs the root straight into its destination,
+    // the scratch buffers only hold nodes below it.
+    size_t max_size = 0;
+    for (size_t node = 1; node < node_count; node++) {
+      const size_t parent_size =
+          this->GetNodeData(this->GetParent(node)).signal.size();
+      const size_t size =
+          this->GetChildSignalSize(parent_size, this->GetChildIndex(node));
+      this->GetNodeData(node).signal = Span<Sample>(nullptr, size);
+      max_size = std::max(max_size, size);
+    }
+
+    for (auto& scratch : this->scratch_signals_) {
+      scratch.resize(max_size);
+    }
+
+    this->node_storage_.clear();
+    this->PlaceNodes();
+    this->ReserveWorkspaces();
+  }
+
+  /**
+   * Point the nodes below the root, which LayoutNodes has just sized, at
+   * their storage.<br/>
+   * Nodes which are left pointing at nullptr are allocated one by one when
+   * a lazy tree first computes them. A mapped tree points its nodes into
+   * the file afterwards. Otherwise every node is placed in the node buffer,
+   * each beginning on a SignalAlignment boundary.
+   */
+  virtual void PlaceNodes() {
+    constexpr size_t alignment = SignalAlignment / sizeof(Sample);
+    const size_t node_count = this->GetLastLeaf() + 1;
+    const auto aligned_size = [](size_t size) {
+      return (size + alignment - 1) / alignment * alignment;
+    };
+
+    // Mapped trees read every node from the file.
+    if (this->mapped_file_ != nullptr) {
+      AlignedVector<Sample>().swap(this->node_buffer_);
+      return;
+    }
+
+    // Lazy trees allocate each node when it is first computed.
+    if (this->lazy_) {
+      AlignedVector<Sample>().swap(this->node_buffer_);
+      this->node_storage_.resize(node_count);
+      return;
+    }
+
+    size_t buffer_size = 0;
+    for (size_t node = 1; node < node_count; node++) {
+      buffer_size += aligned_size(this->GetNodeData(node).signal.size());
+    }
+
+    this->node_buffer_.resize(buffer_size);
+    size_t offset = 0;
+    for (size_t node = 1; node < node_count; node++) {
+      auto& data = this->GetNodeData(node);
+      data.signal = Span<Sample>(this->node_buffer_.data() + offset,
+                                 data.signal.size());
+      offset += aligned_size(data.signal.size());
+    }
+  }
+
+  /**
+   * Reserve the workspace of every worker for the current root signal.
+   * Threads outside of the scheduler reserve their own in GetWorkspace.
+   */
+  void ReserveWorkspaces() {
+    for (auto& workspace : this->workspaces_) {
+      this->ReserveWorkspace(&workspace);
+    }
+  }
+
+  /**
+   * Reserve workspace for transforming the current root signal.
+   */
+  void ReserveWorkspace(WaveletWorkspace* workspace) {
+    workspace->Reserve(this->GetNodeData(0).signal.size(),
+                       this->wavelet_->lowpassDecompositionFilter_.size());
+  }
+
+  /**
+   * Get the workspace of the calling thread.
+   */
+  WaveletWorkspace* GetWorkspace() {
+    if (this->scheduler_ == nullptr) {
+      return &this->workspaces_[0];
+    }
+    const size_t worker = this->scheduler_->GetCurrentWorker();
+    if (worker != 0) {
+      return &this->workspaces_[worker];
+    }
+    // The workspace is grown to its full size the first time a thread uses
+    // it for this root signal, so only that first call allocates.
+    WaveletWorkspace* workspace = GetCallerWorkspace();
+    this->ReserveWorkspace(workspace);
+    return workspace;
+  }
+
+  /**
+   * Get the workspace of the calling thread when it is not a worker of the
+   * scheduler.<br/>
+   * Every such thread is worker 0, and several of them may run tasks of
+   * this tree at once, so each has a workspace of its own. It is shared by
+   * all trees the thread runs tasks for, one at a time, and reserved by
+   * each of them on first use.
+   */
+  static WaveletWorkspace* GetCallerWorkspace() {
+    thread_local WaveletWorkspace workspace;
+    return &workspace;
+  }
+
+  /**
+   * Decompose signal into approximation and details coefficients with the
+   * transform engine selected for this tree.
+   * @see WaveletMath::Decompose
+   * @see WaveletMath::DecomposeChannels
+   */
+  void DecomposeSignal(Span<const Sample> signal, Span<Sample> approx_coeffs,
+                       Span<Sample> details_coeffs, DyadicMode dyadic_mode,
+                       PaddingMode padding_mode) {
+    if (this->channel_count_ > 1) {
+      WaveletMath::DecomposeChannels<Sample, Accumulator>(
+          signal, this->channel_count_, this->lowpass_decomposition_filter_,
+          this->highpass_decomposition_filter_, approx_coeffs, details_coeffs,
+          dyadic_mode, padding_mode);
+    } else if (this->engine_ == TransformEngine::Lifting) {
+      WaveletMath::Decompose<Sample>(signal, this->lifting_scheme_,
+                                     approx_coeffs, details_coeffs,
+                                     dyadic_mode, padding_mode,
+                                     this->GetWorkspace());
+    } else {
+      WaveletMath::Decompose<Sample, Accumulator>(
+          signal, this->lowpass_decomposition_filter_,
+          this->highpass_decomposition_filter_, approx_coeffs, details_coeffs,
+          dyadic_mode, padding_mode);
+    }
+  }
+
+  /**
+   * Compute a range of the coefficients DecomposeSignal computes from a
+   * signal with the transform engine selected for this tree.
+   * @param approx_coeffs Receives the approximation coefficients of
+   *                      outputs output_begin onward, every channel of
+   *                      each.
+   * @param details_coeffs Receives the details coefficients of the same
+   *                       outputs.
+   * @see WaveletMath::DecomposeRange
+   * @see WaveletMath::DecomposeChannelsRange
+   */
+  void DecomposeSignalRange(Span<const Sample> signal,
+                            Span<Sample> approx_coeffs,
+                            Span<Sample> details_coeffs, size_t output_begin,
+                            DyadicMode dyadic_mode,
+                            PaddingMode padding_mode) {
+    if (this->channel_count_ > 1) {
+      WaveletMath::DecomposeChannelsRange<Sample, Accumulator>(
+          signal, this->channel_count_, this->lowpass_decomposition_filter_,
+          this->highpass_decomposition_filter_, approx_coeffs, details_coeffs,
+          output_begin, dyadic_mode, padding_mode);
+    } else if (this->engine_ == TransformEngine::Lifting) {
+      WaveletMath::DecomposeRange<Sample>(
+          signal, this->lifting_scheme_, approx_coeffs, details_coeffs,
+          output_begin, dyadic_mode, padding_mode, this->GetWorkspace());
+    } else {
+      WaveletMath::DecomposeRange<Sample, Accumulator>(
+          signal, 0, signal.size(), this->lowpass_decomposition_filter_,
+          this->highpass_decomposition_filter_, approx_coeffs, details_coeffs,
+          output_begin, dyadic_mode, padding_mode);
+    }
+  }
+
+  /**
+   * Reconstruct a signal from approximation or details coefficients with
+   * the transform engine selected for this tree.
+   * @see WaveletMath::Reconstruct
+   * @see WaveletMath::ReconstructChannels
+   */
+  void ReconstructSignal(Span<const Sample> coeffs,
+                         CoefficientType coeffs_type, Span<Sample> signal,
+                         DyadicMode dyadic_mode, PaddingMode padding_mode) {
+    if (this->channel_count_ > 1) {
+      WaveletMath::ReconstructChannels<Sample, Accumulator>(
+          coeffs, this->channel_count_,
+          coeffs_type == CoefficientType::Approximation
+              ? this->lowpass_reconstruction_filter_
+              : this->highpass_reconstruction_filter_,
+          signal, dyadic_mode, padding_mode);
+    } else if (this->engine_ == TransformEngine::Lifting) {
+      WaveletMath::Reconstruct<Sample>(coeffs, this->lifting_scheme_,
+                                       coeffs_type, signal, dyadic_mode,
+                                       padding_mode, this->GetWorkspace());
+    } else {
+      WaveletMath::Reconstruct<Sample, Accumulator>(
+          coeffs,
+          coeffs_type == CoefficientType::Approximation
+              ? this->lowpass_reconstruction_filter_
+              : this->highpass_reconstruction_filter_,
+          signal, dyadic_mode, padding_mode);
+    }
+  }
+
+  /**
+   * Reconstruct a signal from both its approximation and details
+   * coefficients with the transform engine selected for this tree.<br/>
+   * Lifting runs its steps once for both. Otherwise the details are
+   * reconstructed into scratch and added to the signal.
+   * @param scratch Scratch memory as long as signal. Unused when lifting.
+   * @see ReconstructSignal
+   */
+  void ReconstructSignal(Span<const Sample> approx_coeffs,
+                         Span<const Sample> details_coeffs,
+                         Span<Sample> signal, Span<Sample> scratch,
+                         DyadicMode dyadic_mode, PaddingMode padding_mode) {
+    if (this->channel_count_ == 1 &&
+        this->engine_ == TransformEngine::Lifting) {
+      WaveletMath::Reconstruct<Sample>(approx_coeffs, details_coeffs,
+                                       this->lifting_scheme_, signal,
+                                       dyadic_mode, padding_mode,
+                                       this->GetWorkspace());
+      return;
+    }
+
+    assert(scratch.size() == signal.size());
+    this->ReconstructSignal(approx_coeffs, CoefficientType::Approximation,
+                            signal, dyadic_mode, padding_mode);
+    this->ReconstructSignal(details_coeffs, CoefficientType::Details, scratch,
+                            dyadic_mode, padding_mode);
+    std::transform(signal.begin(), signal.end(), scratch.begin(),
+                   signal.begin(), std::plus<>());
+  }
+
+  /**
+   * Reconstruct the signal of one node all the way up to the root.<br/>
+   * Each ancestor is reconstructed from only the child on the path. The
+   * intermediate signals are kept in scratch buffers so the node data is
+   * left untouched.
+   * @param node The node to reconstruct.
+   * @param padding_mode Padding mode used during reconstruction.
+   * @param signal Destination for the reconstructed signal. Must hold as
+   *               many elements as the root signal and must not overlap
+   *               any node.
+   */
+  void ReconstructPath(size_t node, PaddingMode padding_mode,
+                       Span<Sample> signal) {
+    const Span<const Sample> root = this->GetNodeData(0).signal;
+    assert(signal.size() == root.size());
+
+    if (node == 0) {
+      if (signal.data() != root.data()) {
+        std::copy(root.begin(), root.end(), signal.begin());
+      }
+      return;
+    }
+
+    Span<const Sample> coeffs = this->GetComputedSignal(node);
+    size_t scratch_index = 0;
+
+    while (node != 0) {
+      const size_t parent = this->GetParent(node);
+      const size_t child_index = this->GetChildIndex(node);
+      const size_t parent_size = this->GetNodeData(parent).signal.size();
+      const Span<Sample> parent_signal =
+          parent == 0 ? signal
+                      : Span<Sample>(this->scratch_signals_[scratch_index])
+                            .subspan(0, parent_size);
+
+      {
+        const NodeTimer timer(&this->profile_, node, true);
+        this->ReconstructSignal(
+            coeffs, this->GetChildCoefficientType(child_index), parent_signal,
+            this->GetChildDyadicMode(child_index), padding_mode);
+      }
+
+      coeffs = parent_signal;
+      scratch_index = 1 - scratch_index;
+      node = parent;
+    }
+  }
+
+  // Declared first so it outlives the buffers which record into it.
+  TreeProfile profile_;
   const Wavelet* wavelet_;
+  TransformEngine engine_;
+  // The number of signals interleaved in the root signal.
+  size_t channel_count_;
+  // The filters of wavelet_ in the type they are applied in.
+  std::vector<Accumulator> lowpass_decomposition_filter_;
+  std::vector<Accumulator> highpass_decomposition_filter_;
+  std::vector<Accumulator> lowpass_reconstruction_filter_;
+  std::vector<Accumulator> highpass_reconstruction_filter_;
+  LiftingScheme lifting_scheme_;
+  TaskScheduler* scheduler_ = nullptr;
+  size_t grain_size_ = BasicWaveletPacketTreeBase<Sample>::DefaultGrainSize;
+  // Scratch memory for the transforms, sized from the root signal. One per
+  // worker of scheduler_, or just one when decomposing serially. Threads
+  // outside of scheduler_ use GetCallerWorkspace instead of the first.
+  std::vector<WaveletWorkspace> workspaces_;
+  std::vector<Sample> root_signal_;
+  // Whether the root node points into a buffer of the caller instead of
+  // root_signal_.
+  bool root_view_ = false;
+  // Coefficients of all nodes below the root.
+  AlignedVector<Sample> node_buffer_;
+  bool lazy_ = false;
+  // Whether each node has been decomposed into its children, in lazy mode.
+  std::vector<bool> decomposed_;
+  // Coefficients of each node computed so far, in lazy mode.
+  std::vector<AlignedVector<Sample>> node_storage_;
+  // The file the nodes point into, if they were mapped by MapFile.
+  TreeFile* mapped_file_ = nullptr;
+  // Intermediate signals of ReconstructPath, each as large as the largest
+  // node.
+  AlignedVector<Sample> scratch_signals_[2];
 };
 
 }  // namespace panwave
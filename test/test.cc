@@ -5,26 +5,164 @@
 //-------------------------------------------------------------------------------------------------------
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <fstream>
+#include <functional>
 #include <iostream>
 #include <iterator>
+#include <limits>
+#include <new>
 #include <sstream>
+#include <thread>
 #include <vector>
 
+#include "AlignedAllocator.h"
+#include "BasisCost.h"
+#include "InPlaceWaveletPacketTree.h"
+#include "Instrumentation.h"
+#include "LiftingScheme.h"
+#include "MultichannelWaveletPacketTree.h"
+#include "StaticWavelet.h"
 #include "StationaryWaveletPacketTree.h"
+#include "StreamingWaveletPacketTree.h"
+#include "TaskScheduler.h"
+#include "Threshold.h"
+#include "TreeFile.h"
+#include "UndecimatedWaveletPacketTree.h"
+#include "WaveletKernels.h"
 #include "WaveletMath.h"
 #include "WaveletPacketTree.h"
 #include "WaveletPacketTreeBase.h"
 
+using panwave::AlignedVector;
+using panwave::BasicWaveletKernels;
+using panwave::BasisCost;
+using panwave::BasisNode;
+using panwave::CoefficientType;
+using panwave::CostFunction;
 using panwave::DyadicMode;
+using panwave::InPlaceWaveletPacketTree;
+using panwave::InstrumentationEnabled;
+using panwave::KernelIsa;
+using panwave::LiftingScheme;
+using panwave::MultichannelWaveletPacketTree;
+using panwave::NodeCounters;
 using panwave::PaddingMode;
+using panwave::Primitive;
+using panwave::PrimitiveCounters;
+using panwave::StaticWavelet;
+using panwave::Span;
 using panwave::StationaryWaveletPacketTree;
+using panwave::StreamingWaveletPacketTree;
+using panwave::TaskScheduler;
+using panwave::Threshold;
+using panwave::ThresholdRule;
+using panwave::ThresholdSelection;
+using panwave::TransformEngine;
+using panwave::TreeFile;
+using panwave::TreeProfile;
+using panwave::UndecimatedWaveletPacketTree;
 using panwave::Wavelet;
 using panwave::WaveletMath;
 using panwave::WaveletPacketTree;
 using panwave::WaveletPacketTreeBase;
 
+namespace {
+
+// The number of calls to operator new so far, in any of its forms, from
+// any thread.
+std::atomic<size_t> allocationCount{0};
+
+// Allocate an over-aligned block from malloc. The pointer malloc returned
+// is stored right before the aligned block.
+void* AllocateAligned(size_t size, std::align_val_t alignment) {
+  const auto align = std::max(static_cast<size_t>(alignment), sizeof(void*));
+  void* const block = std::malloc(size + align + sizeof(void*));
+  if (block == nullptr) {
+    throw std::bad_alloc();
+  }
+  const auto address = reinterpret_cast<uintptr_t>(block) + sizeof(void*);
+  void** const ptr =
+      reinterpret_cast<void**>((address + align - 1) / align * align);
+  ptr[-1] = block;
+  return ptr;
+}
+
+void FreeAligned(void* ptr) {
+  if (ptr != nullptr) {
+    std::free(static_cast<void**>(ptr)[-1]);
+  }
+}
+
+}  // namespace
+
+// The replaced operators are kept out of line. Once inlined, the compiler
+// would pair the malloc and free inside them with the operator new and
+// delete of the caller and report them as mismatched.
+#if defined(_MSC_VER)
+#define TEST_NOINLINE __declspec(noinline)
+#else
+#define TEST_NOINLINE __attribute__((noinline))
+#endif
+
+TEST_NOINLINE void* operator new(size_t size) {
+  allocationCount++;
+  void* ptr = std::malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+TEST_NOINLINE void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, size_t /*size*/) noexcept {
+  ::operator delete(ptr);
+}
+
+void* operator new[](size_t size) { return ::operator new(size); }
+
+void operator delete[](void* ptr) noexcept { ::operator delete(ptr); }
+
+void operator delete[](void* ptr, size_t /*size*/) noexcept {
+  ::operator delete(ptr);
+}
+
+// AlignedAllocator allocates through the aligned forms.
+TEST_NOINLINE void* operator new(size_t size, std::align_val_t alignment) {
+  allocationCount++;
+  return AllocateAligned(size, alignment);
+}
+
+TEST_NOINLINE void operator delete(void* ptr,
+                                   std::align_val_t /*alignment*/) noexcept {
+  FreeAligned(ptr);
+}
+
+void operator delete(void* ptr, size_t /*size*/,
+                     std::align_val_t alignment) noexcept {
+  ::operator delete(ptr, alignment);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+  return ::operator new(size, alignment);
+}
+
+void operator delete[](void* ptr, std::align_val_t alignment) noexcept {
+  ::operator delete(ptr, alignment);
+}
+
+void operator delete[](void* ptr, size_t /*size*/,
+                       std::align_val_t alignment) noexcept {
+  ::operator delete(ptr, alignment);
+}
+
 namespace testing {
 
 void Print(const std::vector<double>* vec) {
@@ -102,9 +240,6 @@ void TestWPTs(size_t max_height, const std::vector<double>& signal,
   for (size_t i = 0; i < max_height; i++) {
     TestWPT(i + 1, signal, wavelet);
   }
-  // SWPT takes longer to compute. Limit the max_height.
-  constexpr size_t max_height_swpt = 7;
-  max_height = std::min(max_height, max_height_swpt);
   for (size_t i = 0; i < max_height; i++) {
     TestSWPT(i + 1, signal, wavelet);
   }
@@ -159,6 +294,1568 @@ void TestPad(const std::vector<double>& data,
   Check(&expected, &actual);
 }
 
+void TestDecompose(const std::vector<double>& signal, const Wavelet* wavelet,
+                   DyadicMode dyadic_mode, PaddingMode padding_mode) {
+  // Reference decomposition built from the pad, convolve, and downsample
+  // primitives.
+  const size_t filter_size = wavelet->lowpassDecompositionFilter_.size();
+  std::vector<double> padded;
+  std::vector<double> convolved;
+  std::vector<double> expected_approx;
+  std::vector<double> expected_details;
+  WaveletMath::Pad(signal, &padded, filter_size - 1, filter_size - 1,
+                   padding_mode);
+  WaveletMath::Convolve(padded, wavelet->lowpassDecompositionFilter_,
+                        &convolved);
+  WaveletMath::DyadicDownsample(convolved, &expected_approx, dyadic_mode);
+  WaveletMath::Convolve(padded, wavelet->highpassDecompositionFilter_,
+                        &convolved);
+  WaveletMath::DyadicDownsample(convolved, &expected_details, dyadic_mode);
+
+  // Periodic padding only keeps the outputs of one period.
+  const size_t output_size = WaveletMath::GetDecomposedSize(
+      signal.size(), filter_size, dyadic_mode, padding_mode);
+  expected_approx.resize(output_size);
+  expected_details.resize(output_size);
+
+  std::vector<double> approx;
+  std::vector<double> details;
+  WaveletMath::Decompose(signal, wavelet->lowpassDecompositionFilter_,
+                         wavelet->highpassDecompositionFilter_, &approx,
+                         &details, dyadic_mode, padding_mode);
+  Check(&expected_approx, &approx);
+  Check(&expected_details, &details);
+}
+
+void TestDecomposeDualPhase(const std::vector<double>& signal,
+                            const Wavelet* wavelet, PaddingMode padding_mode) {
+  const DyadicMode dyadic_modes[] = {DyadicMode::Even, DyadicMode::Odd};
+  std::vector<double> expected_approx[2];
+  std::vector<double> expected_details[2];
+  std::vector<double> approx[2];
+  std::vector<double> details[2];
+
+  for (size_t i = 0; i < 2; i++) {
+    WaveletMath::Decompose(signal, wavelet->lowpassDecompositionFilter_,
+                           wavelet->highpassDecompositionFilter_,
+                           &expected_approx[i], &expected_details[i],
+                           dyadic_modes[i], padding_mode);
+    approx[i].resize(expected_approx[i].size());
+    details[i].resize(expected_details[i].size());
+  }
+
+  WaveletMath::DecomposeDualPhase(signal, wavelet->lowpassDecompositionFilter_,
+                                  wavelet->highpassDecompositionFilter_,
+                                  approx[0], details[0], approx[1],
+                                  details[1], padding_mode);
+  for (size_t i = 0; i < 2; i++) {
+    Check(&expected_approx[i], &approx[i]);
+    Check(&expected_details[i], &details[i]);
+  }
+}
+
+void TestReconstruct(const std::vector<double>& coeffs,
+                     const std::vector<double>& filter, size_t data_size,
+                     DyadicMode dyadic_mode, PaddingMode padding_mode) {
+  // Reference reconstruction built from the upsample, pad, and convolve
+  // primitives.
+  const size_t filter_size = filter.size();
+  std::vector<double> upsampled;
+  std::vector<double> padded;
+  std::vector<double> convolved;
+  WaveletMath::DyadicUpsample(coeffs, &upsampled, dyadic_mode);
+  // Periodic padding repeats the upsampled coefficients every twice as many
+  // elements as there are coefficients, and reconstructs a whole period,
+  // which reads one element further.
+  size_t pad_right = filter_size - 1;
+  if (padding_mode == PaddingMode::Periodic) {
+    upsampled.resize(coeffs.size() * 2);
+    pad_right++;
+  }
+  WaveletMath::Pad(upsampled, &padded, filter_size - 1, pad_right,
+                   padding_mode);
+  WaveletMath::Convolve(padded, filter, &convolved);
+  const size_t dyad_shift = dyadic_mode == DyadicMode::Even ? 0U : 2U;
+  const auto begin = convolved.cbegin() + (filter_size - dyad_shift);
+  const std::vector<double> expected(begin, begin + data_size);
+
+  std::vector<double> actual;
+  WaveletMath::Reconstruct(coeffs, filter, &actual, data_size, dyadic_mode,
+                           padding_mode);
+  Check(&expected, &actual);
+}
+
+void TestReconstructions() {
+  std::cout << "Testing WaveletMath::Reconstruct" << std::endl;
+  constexpr size_t max_coeffs_size = 30;
+  const DyadicMode dyadic_modes[] = {DyadicMode::Even, DyadicMode::Odd};
+  const PaddingMode padding_modes[] = {
+      PaddingMode::Zeroes, PaddingMode::Symmetric, PaddingMode::Periodic};
+  const Wavelet::WaveletType types[] = {Wavelet::WaveletType::Daubechies,
+                                        Wavelet::WaveletType::Coiflet};
+  Wavelet wavelet;
+
+  for (const auto type : types) {
+    for (size_t p = Wavelet::GetWaveletMinimumP(type);
+         p <= Wavelet::GetWaveletMaximumP(type); p++) {
+      Wavelet::GetWaveletCoefficients(&wavelet, type, p);
+      for (size_t size = 1; size <= max_coeffs_size; size++) {
+        std::vector<double> coeffs(size);
+        for (size_t i = 0; i < size; i++) {
+          coeffs[i] = static_cast<double>((i * 5) % 13) - 6.0;
+        }
+        for (const auto dyadic_mode : dyadic_modes) {
+          // Reconstruct every window size the padded convolution supports.
+          const size_t max_data_size = size * 2;
+          for (const auto padding_mode : padding_modes) {
+            for (size_t data_size = 1; data_size <= max_data_size;
+                 data_size++) {
+              TestReconstruct(coeffs, wavelet.lowpassReconstructionFilter_,
+                              data_size, dyadic_mode, padding_mode);
+              TestReconstruct(coeffs, wavelet.highpassReconstructionFilter_,
+                              data_size, dyadic_mode, padding_mode);
+            }
+          }
+        }
+      }
+    }
+  }
+  std::cout << "Pass" << std::endl;
+}
+
+void TestDecompositions() {
+  std::cout << "Testing WaveletMath::Decompose" << std::endl;
+  constexpr size_t max_signal_size = 40;
+  const DyadicMode dyadic_modes[] = {DyadicMode::Even, DyadicMode::Odd};
+  const PaddingMode padding_modes[] = {
+      PaddingMode::Zeroes, PaddingMode::Symmetric, PaddingMode::Periodic};
+  const Wavelet::WaveletType types[] = {Wavelet::WaveletType::Daubechies,
+                                        Wavelet::WaveletType::Coiflet};
+  Wavelet wavelet;
+
+  for (const auto type : types) {
+    for (size_t p = Wavelet::GetWaveletMinimumP(type);
+         p <= Wavelet::GetWaveletMaximumP(type); p++) {
+      Wavelet::GetWaveletCoefficients(&wavelet, type, p);
+      for (size_t size = 1; size <= max_signal_size; size++) {
+        std::vector<double> signal(size);
+        for (size_t i = 0; i < size; i++) {
+          signal[i] = static_cast<double>((i * 7) % 11) - 5.0;
+        }
+        for (const auto dyadic_mode : dyadic_modes) {
+          for (const auto padding_mode : padding_modes) {
+            TestDecompose(signal, &wavelet, dyadic_mode, padding_mode);
+          }
+        }
+        for (const auto padding_mode : padding_modes) {
+          TestDecomposeDualPhase(signal, &wavelet, padding_mode);
+        }
+      }
+    }
+  }
+  std::cout << "Pass" << std::endl;
+}
+
+void TestLifting(const Wavelet* wavelet) {
+  LiftingScheme scheme;
+  if (!LiftingScheme::Factor(*wavelet, &scheme)) {
+    std::cout << "Failed to factor wavelet." << std::endl << "FAIL"
+              << std::endl;
+    exit(-1);
+  }
+  const size_t filter_size = wavelet->lowpassDecompositionFilter_.size();
+  if (scheme.GetMultiplyCount() > filter_size + 2) {
+    std::cout << "Lifting scheme too expensive. Expected: " << filter_size + 2
+              << " Actual: " << scheme.GetMultiplyCount() << std::endl
+              << "FAIL" << std::endl;
+    exit(-1);
+  }
+
+  constexpr size_t max_signal_size = 40;
+  const DyadicMode dyadic_modes[] = {DyadicMode::Even, DyadicMode::Odd};
+  const PaddingMode padding_modes[] = {
+      PaddingMode::Zeroes, PaddingMode::Symmetric, PaddingMode::Periodic};
+
+  for (size_t size = 1; size <= max_signal_size; size++) {
+    std::vector<double> signal(size);
+    for (size_t i = 0; i < size; i++) {
+      signal[i] = static_cast<double>((i * 7) % 11) - 5.0;
+    }
+    for (const auto dyadic_mode : dyadic_modes) {
+      for (const auto padding_mode : padding_modes) {
+        std::vector<double> approx;
+        std::vector<double> details;
+        std::vector<double> lifting_approx;
+        std::vector<double> lifting_details;
+        WaveletMath::Decompose(signal, wavelet->lowpassDecompositionFilter_,
+                               wavelet->highpassDecompositionFilter_, &approx,
+                               &details, dyadic_mode, padding_mode);
+        WaveletMath::Decompose(signal, scheme, &lifting_approx,
+                               &lifting_details, dyadic_mode, padding_mode);
+        Check(&approx, &lifting_approx);
+        Check(&details, &lifting_details);
+
+        // A range of the outputs is computed just like the whole, and an
+        // edit of one sample changes no output outside of its range.
+        const size_t output_begin = approx.size() / 3;
+        const size_t output_count = approx.size() - 2 * output_begin;
+        std::vector<double> range_approx(output_count);
+        std::vector<double> range_details(output_count);
+        WaveletMath::DecomposeRange<double>(signal, scheme, range_approx,
+                                            range_details, output_begin,
+                                            dyadic_mode, padding_mode);
+        if (!std::equal(range_approx.cbegin(), range_approx.cend(),
+                        lifting_approx.cbegin() +
+                            static_cast<ptrdiff_t>(output_begin)) ||
+            !std::equal(range_details.cbegin(), range_details.cend(),
+                        lifting_details.cbegin() +
+                            static_cast<ptrdiff_t>(output_begin))) {
+          std::cout << "Lifting range differs from the whole." << std::endl
+                    << "FAIL" << std::endl;
+          exit(-1);
+        }
+
+        std::vector<double> edited = signal;
+        edited[size / 2] += 100.0;
+        size_t changed_begin = 0;
+        size_t changed_end = 0;
+        WaveletMath::GetDecomposedRange(size, size / 2, size / 2 + 1, scheme,
+                                        dyadic_mode, padding_mode,
+                                        &changed_begin, &changed_end);
+        if (size > 4 * filter_size &&
+            changed_end - changed_begin >= approx.size()) {
+          std::cout << "Lifting range covers every output." << std::endl
+                    << "FAIL" << std::endl;
+          exit(-1);
+        }
+        std::vector<double> edited_approx;
+        std::vector<double> edited_details;
+        WaveletMath::Decompose(edited, scheme, &edited_approx,
+                               &edited_details, dyadic_mode, padding_mode);
+        for (size_t m = 0; m < edited_approx.size(); m++) {
+          if ((m < changed_begin || m >= changed_end) &&
+              (edited_approx[m] != lifting_approx[m] ||
+               edited_details[m] != lifting_details[m])) {
+            std::cout << "Lifting output " << m
+                      << " changed outside of the decomposed range."
+                      << std::endl
+                      << "FAIL" << std::endl;
+            exit(-1);
+          }
+        }
+
+        std::vector<double> expected;
+        std::vector<double> actual;
+        WaveletMath::Reconstruct(approx, wavelet->lowpassReconstructionFilter_,
+                                 &expected, size, dyadic_mode, padding_mode);
+        WaveletMath::Reconstruct(approx, scheme,
+                                 CoefficientType::Approximation, &actual,
+                                 size, dyadic_mode, padding_mode);
+        Check(&expected, &actual);
+        WaveletMath::Reconstruct(details,
+                                 wavelet->highpassReconstructionFilter_,
+                                 &expected, size, dyadic_mode, padding_mode);
+        WaveletMath::Reconstruct(details, scheme, CoefficientType::Details,
+                                 &actual, size, dyadic_mode, padding_mode);
+        Check(&expected, &actual);
+
+        // Reconstructing from both at once adds up the two signals.
+        WaveletMath::Reconstruct(approx, scheme,
+                                 CoefficientType::Approximation, &expected,
+                                 size, dyadic_mode, padding_mode);
+        std::transform(expected.cbegin(), expected.cend(), actual.cbegin(),
+                       expected.begin(), std::plus<>());
+        WaveletMath::Reconstruct<double>(approx, details, scheme, actual,
+                                         dyadic_mode, padding_mode);
+        Check(&expected, &actual);
+      }
+    }
+  }
+}
+
+void TestLiftingTrees(const std::vector<double>& signal) {
+  std::cout << "Testing lifting scheme" << std::endl;
+  constexpr size_t max_height = 6;
+  constexpr size_t max_height_swpt = 4;
+  const Wavelet::WaveletType types[] = {Wavelet::WaveletType::Daubechies,
+                                        Wavelet::WaveletType::Symlet};
+  Wavelet wavelet;
+
+  for (const auto type : types) {
+    for (size_t p = Wavelet::GetWaveletMinimumP(type);
+         p <= Wavelet::GetWaveletMaximumP(type); p++) {
+      Wavelet::GetWaveletCoefficients(&wavelet, type, p);
+      TestLifting(&wavelet);
+
+      for (size_t height = 1; height <= max_height; height++) {
+        WaveletPacketTree tree(height, &wavelet, DyadicMode::Odd,
+                               PaddingMode::Symmetric,
+                               TransformEngine::Lifting);
+        TestWPT(&tree, signal, true);
+      }
+      for (size_t height = 1; height <= max_height_swpt; height++) {
+        StationaryWaveletPacketTree tree(height, &wavelet, PaddingMode::Zeroes,
+                                         TransformEngine::Lifting);
+        TestWPT(&tree, signal, true);
+      }
+    }
+  }
+
+  // A wavelet which cannot be factored falls back to convolution.
+  Wavelet::GetWaveletCoefficients(&wavelet, Wavelet::WaveletType::Coiflet, 4);
+  LiftingScheme scheme;
+  WaveletPacketTree tree(4, &wavelet, DyadicMode::Odd, PaddingMode::Symmetric,
+                         TransformEngine::Lifting);
+  WaveletPacketTree convolution_tree(4, &wavelet, DyadicMode::Odd,
+                                     PaddingMode::Symmetric);
+  if (LiftingScheme::Factor(wavelet, &scheme) ||
+      tree.GetTransformEngine() != TransformEngine::Convolution) {
+    std::cout << "Lifting tree does not fall back to convolution."
+              << std::endl
+              << "FAIL" << std::endl;
+    exit(-1);
+  }
+  tree.SetRootSignal(signal);
+  tree.Decompose();
+  convolution_tree.SetRootSignal(signal);
+  convolution_tree.Decompose();
+  std::vector<double> expected(signal.size());
+  std::vector<double> actual(signal.size());
+  for (size_t level = 0; level < tree.GetWaveletLevelCount(); level++) {
+    convolution_tree.Reconstruct(level, expected);
+    tree.Reconstruct(level, actual);
+    Check(&expected, &actual);
+  }
+}
+
+// Decompose signal and reconstruct every level of tree.
+void RunTransforms(WaveletPacketTreeBase* tree,
+                   const std::vector<double>& signal) {
+  tree->SetRootSignal(signal);
+  tree->Decompose();
+  for (size_t i = 0; i < tree->GetWaveletLevelCount(); i++) {
+    tree->Reconstruct(i);
+  }
+}
+
+void TestNoAllocations(WaveletPacketTreeBase* tree,
+                       const std::vector<double>& signal) {
+  // The first pass sizes the node signals and the workspace.
+  RunTransforms(tree, signal);
+
+  const size_t count = allocationCount;
+  RunTransforms(tree, signal);
+  if (allocationCount != count) {
+    std::cout << "Allocated after warm-up. Allocations: "
+              << allocationCount - count << std::endl
+              << "FAIL" << std::endl;
+    exit(-1);
+  }
+}
+
+void TestWorkspace(const std::vector<double>& signal) {
+  std::cout << "Testing allocations after warm-up" << std::endl;
+
+  // The node signals are aligned, so the aligned operator new has to be
+  // counted too.
+  const size_t count = allocationCount;
+  {
+    const AlignedVector<double> aligned(16);
+  }
+  if (allocationCount != count + 1) {
+    std::cout << "Aligned allocation was not counted." << std::endl
+              << "FAIL" << std::endl;
+    exit(-1);
+  }
+
+  const TransformEngine engines[] = {TransformEngine::Convolution,
+                                     TransformEngine::Lifting};
+  Wavelet wavelet;
+  Wavelet::GetWaveletCoefficients(&wavelet, Wavelet::WaveletType::Daubechies,
+                                  4);
+
+  for (const auto engine : engines) {
+    WaveletPacketTree tree(5, &wavelet, DyadicMode::Odd,
+                           PaddingMode::Symmetric, engine);
+    TestNoAllocations(&tree, signal);
+    StationaryWaveletPacketTree swpt(3, &wavelet, PaddingMode::Zeroes,
+                                     engine);
+    TestNoAllocations(&swpt, signal);
+  }
+
+  // Each thread outside of a scheduler reserves its own scratch memory the
+  // first time it drives a tree, and allocates nothing after that.
+  TaskScheduler scheduler(2);
+  WaveletPacketTree tree(5, &wavelet, DyadicMode::Odd, PaddingMode::Symmetric,
+                         TransformEngine::Lifting);
+  tree.SetTaskScheduler(&scheduler, 1);
+  RunTransforms(&tree, signal);
+  std::thread caller([&tree, &signal] {
+    tree.Decompose();
+    const size_t count = allocationCount;
+    for (size_t i = 0; i < tree.GetWaveletLevelCount(); i++) {
+      tree.Reconstruct(i);
+    }
+    tree.Decompose();
+    if (allocationCount != count) {
+      std::cout << "Outside thread allocated after warm-up." << std::endl
+                << "FAIL" << std::endl;
+      exit(-1);
+    }
+  });
+  caller.join();
+  std::cout << "Pass" << std::endl;
+}
+
+void TestReconstructAll(WaveletPacketTreeBase* tree,
+                        const std::vector<double>& signal) {
+  tree->SetRootSignal(signal);
+  tree->Decompose();
+
+  const size_t level_count = tree->GetWaveletLevelCount();
+  std::vector<double> levels(level_count * signal.size());
+  tree->ReconstructAll(levels);
+
+  // ReconstructAll leaves the tree as it was.
+  Check(&signal, &tree->GetRootSignal());
+
+  for (size_t i = 0; i < level_count; i++) {
+    tree->Reconstruct(i);
+    const std::vector<double> row(
+        levels.cbegin() + static_cast<ptrdiff_t>(i * signal.size()),
+        levels.cbegin() + static_cast<ptrdiff_t>((i + 1) * signal.size()));
+    Check(&tree->GetRootSignal(), &row);
+  }
+}
+
+void TestReconstructAlls(const std::vector<double>& signal) {
+  std::cout << "Testing ReconstructAll" << std::endl;
+  Wavelet wavelet;
+  Wavelet::GetWaveletCoefficients(&wavelet, Wavelet::WaveletType::Daubechies,
+                                  3);
+
+  for (size_t height = 1; height <= 6; height++) {
+    WaveletPacketTree tree(height, &wavelet, DyadicMode::Odd,
+                           PaddingMode::Symmetric);
+    TestReconstructAll(&tree, signal);
+  }
+  for (size_t height = 1; height <= 4; height++) {
+    StationaryWaveletPacketTree tree(height, &wavelet);
+    TestReconstructAll(&tree, signal);
+  }
+  std::cout << "Pass" << std::endl;
+}
+
+void TestNodeLayout(const std::vector<double>& signal) {
+  std::cout << "Testing node layout" << std::endl;
+  const size_t sizes[] = {signal.size(), 37, 1, signal.size() / 2,
+                          signal.size()};
+  Wavelet wavelet;
+  Wavelet::GetWaveletCoefficients(&wavelet, Wavelet::WaveletType::Symlet, 5);
+  WaveletPacketTree tree(6, &wavelet, DyadicMode::Even);
+  StationaryWaveletPacketTree swpt(3, &wavelet);
+
+  // Setting a root signal of a different length lays the nodes out again.
+  for (const size_t size : sizes) {
+    const std::vector<double> resized(signal.cbegin(),
+                                      signal.cbegin() + size);
+    TestWPT(&tree, resized, true);
+    TestWPT(&swpt, resized, true);
+  }
+}
+
+// Decompose signal with a serial and a parallel tree and check both
+// reconstruct every wavelet level identically.
+void TestParallelDecompose(WaveletPacketTreeBase* serial,
+                           WaveletPacketTreeBase* parallel,
+                           TaskScheduler* scheduler, size_t grain_size,
+                           const std::vector<double>& signal) {
+  const size_t levels_size = serial->GetWaveletLevelCount() * signal.size();
+  std::vector<double> expected(levels_size);
+  std::vector<double> actual(levels_size);
+
+  serial->SetRootSignal(signal);
+  serial->Decompose();
+  serial->ReconstructAll(expected);
+  parallel->SetTaskScheduler(scheduler, grain_size);
+  parallel->SetRootSignal(signal);
+  parallel->Decompose();
+  parallel->ReconstructAll(actual);
+
+  if (expected != actual) {
+    std::cout << "Parallel decomposition differs from serial." << std::endl
+              << "FAIL" << std::endl;
+    exit(-1);
+  }
+}
+
+void TestParallelDecompositions(const std::vector<double>& signal) {
+  std::cout << "Testing parallel decomposition" << std::endl;
+  const TransformEngine engines[] = {TransformEngine::Convolution,
+                                     TransformEngine::Lifting};
+  // A grain size of zero spawns every subtree as a task.
+  const size_t grain_sizes[] = {0, 1000,
+                                WaveletPacketTreeBase::DefaultGrainSize};
+  Wavelet wavelet;
+  Wavelet::GetWaveletCoefficients(&wavelet, Wavelet::WaveletType::Daubechies,
+                                  6);
+  TaskScheduler scheduler(3);
+
+  for (const auto engine : engines) {
+    for (const size_t grain_size : grain_sizes) {
+      WaveletPacketTree serial(8, &wavelet, DyadicMode::Odd,
+                               PaddingMode::Symmetric, engine);
+      WaveletPacketTree parallel(8, &wavelet, DyadicMode::Odd,
+                                 PaddingMode::Symmetric, engine);
+      TestParallelDecompose(&serial, &parallel, &scheduler, grain_size,
+                            signal);
+
+      StationaryWaveletPacketTree serial_swpt(5, &wavelet,
+                                              PaddingMode::Zeroes, engine);
+      StationaryWaveletPacketTree parallel_swpt(5, &wavelet,
+                                                PaddingMode::Zeroes, engine);
+      TestParallelDecompose(&serial_swpt, &parallel_swpt, &scheduler,
+                            grain_size, signal);
+    }
+  }
+
+  // Threads outside of the scheduler are all worker 0 and run each other's
+  // tasks, so they must not share scratch memory. With a single worker
+  // most tasks are left to them.
+  TaskScheduler shared(1);
+  std::vector<double> long_signal;
+  for (size_t i = 0; i < 16; i++) {
+    long_signal.insert(long_signal.end(), signal.cbegin(), signal.cend());
+  }
+  std::thread callers[2];
+  for (auto& caller : callers) {
+    caller = std::thread([&wavelet, &shared, &long_signal] {
+      for (size_t i = 0; i < 4; i++) {
+        WaveletPacketTree serial(8, &wavelet, DyadicMode::Odd,
+                                 PaddingMode::Symmetric,
+                                 TransformEngine::Lifting);
+        WaveletPacketTree parallel(8, &wavelet, DyadicMode::Odd,
+                                   PaddingMode::Symmetric,
+                                   TransformEngine::Lifting);
+        TestParallelDecompose(&serial, &parallel, &shared, 0, long_signal);
+      }
+    });
+  }
+  for (auto& caller : callers) {
+    caller.join();
+  }
+  std::cout << "Pass" << std::endl;
+}
+
+// Check a tree of Sample values reconstructs every wavelet level like a tree
+// of doubles does, up to the precision of Sample.
+template <class Sample, class Tree, class DoubleTree, class... Args>
+void TestSampleType(const std::vector<double>& signal, Args... args) {
+  DoubleTree expected_tree(args...);
+  Tree tree(args...);
+  const size_t levels_size = tree.GetWaveletLevelCount() * signal.size();
+  std::vector<double> expected(levels_size);
+  std::vector<Sample> actual(levels_size);
+
+  expected_tree.SetRootSignal(signal);
+  expected_tree.Decompose();
+  expected_tree.ReconstructAll(expected);
+  tree.SetRootSignal(std::vector<Sample>(signal.cbegin(), signal.cend()));
+  tree.Decompose();
+  tree.ReconstructAll(actual);
+
+  // Every node on the way from the leaves rounds to Sample, scale the
+  // tolerance by the largest value in the signal.
+  double magnitude = 0.0;
+  for (const double value : signal) {
+    magnitude = std::max(magnitude, fabs(value));
+  }
+  const double tolerance =
+      16.0 * std::numeric_limits<Sample>::epsilon() * magnitude;
+  for (size_t i = 0; i < levels_size; i++) {
+    if (fabs(expected[i] - actual[i]) > tolerance) {
+      std::cout << "Level value " << i << " out of tolerance. Expected: "
+                << expected[i] << " Actual: " << actual[i] << std::endl;
+      std::cout << "FAIL" << std::endl;
+      exit(-1);
+    }
+  }
+}
+
+template <class Sample, class Accumulator>
+void TestSampleTypes(const char* type_name,
+                     const std::vector<double>& signal) {
+  std::cout << "Testing " << type_name << " trees" << std::endl;
+  using Wpt = panwave::BasicWaveletPacketTree<Sample, Accumulator>;
+  using Swpt = panwave::BasicStationaryWaveletPacketTree<Sample, Accumulator>;
+  const TransformEngine engines[] = {TransformEngine::Convolution,
+                                     TransformEngine::Lifting};
+  Wavelet wavelet;
+  Wavelet::GetWaveletCoefficients(&wavelet, Wavelet::WaveletType::Daubechies,
+                                  4);
+
+  for (const auto engine : engines) {
+    TestSampleType<Sample, Wpt, WaveletPacketTree>(
+        signal, size_t{7}, &wavelet, DyadicMode::Odd, PaddingMode::Symmetric,
+        engine);
+    TestSampleType<Sample, Swpt, StationaryWaveletPacketTree>(
+        signal, size_t{4}, &wavelet, PaddingMode::Zeroes, engine);
+  }
+  std::cout << "Pass" << std::endl;
+}
+
+// Decompose signal the way a WaveletPacketTree does and return its leaves.
+std::vector<std::vector<double>> DecomposeLeaves(
+    const std::vector<double>& signal, size_t height, const Wavelet* wavelet,
+    DyadicMode dyadic_mode, PaddingMode padding_mode) {
+  std::vector<std::vector<double>> nodes = {signal};
+
+  for (size_t depth = 1; depth < height; depth++) {
+    std::vector<std::vector<double>> children;
+    for (const auto& node : nodes) {
+      std::vector<double> approx;
+      std::vector<double> details;
+      WaveletMath::Decompose(node, wavelet->lowpassDecompositionFilter_,
+                             wavelet->highpassDecompositionFilter_, &approx,
+                             &details, dyadic_mode, padding_mode);
+      children.push_back(approx);
+      children.push_back(details);
+    }
+    nodes = children;
+  }
+  return nodes;
+}
+
+// Push signal into tree in chunks of chunk_size and check the leaves emit
+// exactly the coefficients of a batch decomposition.
+void TestStream(StreamingWaveletPacketTree* tree,
+                const std::vector<double>& signal, size_t chunk_size,
+                size_t height, const Wavelet* wavelet, DyadicMode dyadic_mode,
+                PaddingMode padding_mode) {
+  const std::vector<std::vector<double>> expected =
+      DecomposeLeaves(signal, height, wavelet, dyadic_mode, padding_mode);
+  std::vector<std::vector<double>> actual(tree->GetWaveletLevelCount());
+  const auto collect = [&]() {
+    if (tree->GetLeafCoefficientIndex() != actual[0].size()) {
+      std::cout << "Leaf coefficient index is wrong." << std::endl
+                << "FAIL" << std::endl;
+      exit(-1);
+    }
+    for (size_t level = 0; level < actual.size(); level++) {
+      const Span<const double> coeffs = tree->GetLeafCoefficients(level);
+      actual[level].insert(actual[level].end(), coeffs.begin(), coeffs.end());
+    }
+  };
+
+  // Leaf coefficient m reads the signal up to element
+  // 2^D * m + (2^D - 1) * first.
+  const size_t stride = size_t{1} << (height - 1);
+  const size_t last = dyadic_mode == DyadicMode::Even ? 0U : stride - 1;
+
+  tree->Reset();
+  for (size_t begin = 0; begin < signal.size(); begin += chunk_size) {
+    const size_t end = std::min(signal.size(), begin + chunk_size);
+    tree->Push(Span<const double>(signal.data() + begin, end - begin));
+    collect();
+
+    const size_t ready = end > last ? (end - 1 - last) / stride + 1 : 0U;
+    if (padding_mode == PaddingMode::Zeroes && actual[0].size() != ready) {
+      std::cout << "Streaming latency is wrong. Expected: " << ready
+                << " Actual: " << actual[0].size() << std::endl
+                << "FAIL" << std::endl;
+      exit(-1);
+    }
+  }
+  tree->Finish();
+  collect();
+
+  if (expected != actual) {
+    std::cout << "Streaming decomposition differs from batch." << std::endl
+              << "FAIL" << std::endl;
+    exit(-1);
+  }
+}
+
+void TestStreaming(const std::vector<double>& signal) {
+  std::cout << "Testing streaming decomposition" << std::endl;
+  const size_t chunk_sizes[] = {1, 2, 7, 64, signal.size()};
+  const DyadicMode dyadic_modes[] = {DyadicMode::Even, DyadicMode::Odd};
+  const PaddingMode padding_modes[] = {PaddingMode::Zeroes,
+                                       PaddingMode::Symmetric};
+  Wavelet wavelet;
+  Wavelet::GetWaveletCoefficients(&wavelet, Wavelet::WaveletType::Daubechies,
+                                  4);
+
+  for (size_t height = 1; height <= 5; height += 2) {
+    for (const auto dyadic_mode : dyadic_modes) {
+      for (const auto padding_mode : padding_modes) {
+        StreamingWaveletPacketTree tree(height, &wavelet, dyadic_mode,
+                                        padding_mode);
+        for (const size_t chunk_size : chunk_sizes) {
+          TestStream(&tree, signal, chunk_size, height, &wavelet, dyadic_mode,
+                     padding_mode);
+        }
+        // A stream shorter than the filter is only decomposed by Finish.
+        const std::vector<double> short_signal(signal.cbegin(),
+                                               signal.cbegin() + 3);
+        TestStream(&tree, short_signal, 1, height, &wavelet, dyadic_mode,
+                   padding_mode);
+      }
+    }
+  }
+
+  // A stream cannot be padded periodically and is padded with zeroes
+  // instead.
+  StreamingWaveletPacketTree periodic(3, &wavelet, DyadicMode::Odd,
+                                      PaddingMode::Periodic);
+  if (periodic.GetPaddingMode() != PaddingMode::Zeroes) {
+    std::cout << "Periodic streams are not padded with zeroes." << std::endl
+              << "FAIL" << std::endl;
+    exit(-1);
+  }
+  TestStream(&periodic, signal, 7, 3, &wavelet, DyadicMode::Odd,
+             PaddingMode::Zeroes);
+  std::cout << "Pass" << std::endl;
+}
+
+// Check a lazy tree reconstructs exactly like an eager one, recomputes its
+// nodes once the root signal changes, and never decomposes or allocates a
+// node which is not read.
+template <class Tree, class... Args>
+void TestLazyTree(const std::vector<double>& signal, size_t children,
+                  Args... args) {
+  Tree eager(args...);
+  Tree lazy(args...);
+  lazy.SetLazyDecomposition(true);
+
+  std::vector<double> reversed(signal.crbegin(), signal.crend());
+  for (double& value : reversed) {
+    value *= 0.5;
+  }
+
+  const std::vector<double>* roots[] = {&signal, &reversed};
+  for (const auto* root : roots) {
+    eager.SetRootSignal(*root);
+    eager.Decompose();
+    lazy.SetRootSignal(*root);
+    const size_t count = allocationCount;
+    const TreeProfile& profile = lazy.GetProfile();
+    const uint64_t profile_allocations = profile.GetBufferAllocationCount();
+    const uint64_t footprint = profile.GetBufferFootprint();
+    lazy.Decompose();
+
+    // Read a single node before anything else has been computed.
+    const size_t depth = 2;
+    const Span<const double> actual = lazy.GetNodeSignal(depth, 1);
+    const Span<const double> expected = eager.GetNodeSignal(depth, 1);
+    if (!std::equal(expected.begin(), expected.end(), actual.begin(),
+                    actual.end())) {
+      std::cout << "Lazy node differs from the eager one." << std::endl
+                << "FAIL" << std::endl;
+      exit(-1);
+    }
+
+    // Only the root and the parent of the node were decomposed. The first
+    // time round that allocated their children and nothing else.
+    const size_t allocations = root == &signal ? 2 * children : 0;
+    bool pass = true;
+    if (InstrumentationEnabled) {
+      const uint64_t bytes = root == &signal
+                                 ? (actual.size() +
+                                    lazy.GetNodeSignal(1, 0).size()) *
+                                       children * sizeof(double)
+                                 : 0;
+      pass = profile.GetBufferAllocationCount() - profile_allocations ==
+                 allocations &&
+             profile.GetBufferFootprint() - footprint == bytes;
+      if (root == &signal) {
+        pass = pass && profile.GetDepthCounters(0).decompositions == 1 &&
+               profile.GetDepthCounters(1).decompositions == 1 &&
+               profile.GetDepthCounters(2).decompositions == 0;
+      }
+    } else {
+      // The profile allocates as it records, so only without it is every
+      // allocation one of the tree.
+      pass = allocationCount - count == allocations;
+    }
+    if (!pass) {
+      std::cout << "Lazy tree computed nodes which were not read."
+                << std::endl
+                << "FAIL" << std::endl;
+      exit(-1);
+    }
+
+    for (size_t level = 0; level < eager.GetWaveletLevelCount(); level++) {
+      eager.Reconstruct(level);
+      lazy.Reconstruct(level);
+      if (eager.GetRootSignal() != lazy.GetRootSignal()) {
+        std::cout << "Lazy reconstruction of level " << level
+                  << " differs from the eager one." << std::endl
+                  << "FAIL" << std::endl;
+        exit(-1);
+      }
+    }
+  }
+}
+
+void TestLazyTrees(const std::vector<double>& signal) {
+  std::cout << "Testing lazy decomposition" << std::endl;
+  Wavelet wavelet;
+  Wavelet::GetWaveletCoefficients(&wavelet, Wavelet::WaveletType::Daubechies,
+                                  4);
+
+  TestLazyTree<WaveletPacketTree>(signal, 2, size_t{7}, &wavelet,
+                                  DyadicMode::Odd, PaddingMode::Symmetric);
+  TestLazyTree<StationaryWaveletPacketTree>(signal, 4, size_t{4}, &wavelet,
+                                            PaddingMode::Zeroes);
+  std::cout << "Pass" << std::endl;
+}
+
+// Edit a few ranges of the root signal of an updated tree and check every
+// node matches a tree decomposed from the edited signal from scratch.
+template <class Tree, class... Args>
+void TestUpdateTree(const std::vector<double>& signal, size_t height,
+                    size_t children, Args... args) {
+  Tree updated(height, args...);
+  Tree expected(height, args...);
+  std::vector<double> edited = signal;
+  const size_t size = signal.size();
+  const size_t edits[][2] = {{0, 3}, {size / 2, 5}, {size - 4, 4}, {17, 1}};
+
+  updated.SetRootSignal(signal);
+  updated.Decompose();
+
+  for (const auto& edit : edits) {
+    std::vector<double> values(edit[1]);
+    for (size_t i = 0; i < values.size(); i++) {
+      values[i] = edited[edit[0] + i] * -2.0 + 1.0;
+      edited[edit[0] + i] = values[i];
+    }
+    updated.UpdateRootSignal(edit[0], values);
+    expected.SetRootSignal(edited);
+    expected.Decompose();
+
+    size_t depth_size = 1;
+    for (size_t depth = 0; depth < height; depth++) {
+      for (size_t position = 0; position < depth_size; position++) {
+        const Span<const double> left =
+            expected.GetNodeSignal(depth, position);
+        const Span<const double> right =
+            updated.GetNodeSignal(depth, position);
+        if (!std::equal(left.begin(), left.end(), right.begin(),
+                        right.end())) {
+          std::cout << "Updated node at depth " << depth << " position "
+                    << position << " differs from a full decomposition."
+                    << std::endl
+                    << "FAIL" << std::endl;
+          exit(-1);
+        }
+      }
+      depth_size *= children;
+    }
+  }
+}
+
+void TestUpdates(const std::vector<double>& signal) {
+  std::cout << "Testing root signal updates" << std::endl;
+  const PaddingMode padding_modes[] = {
+      PaddingMode::Zeroes, PaddingMode::Symmetric, PaddingMode::Periodic};
+  Wavelet wavelet;
+  Wavelet::GetWaveletCoefficients(&wavelet, Wavelet::WaveletType::Daubechies,
+                                  6);
+  // Three channels need a root signal the size of a multiple of three.
+  const std::vector<double> interleaved(
+      signal.cbegin(),
+      signal.cend() - static_cast<ptrdiff_t>(signal.size() % 3));
+
+  for (const auto padding_mode : padding_modes) {
+    TestUpdateTree<WaveletPacketTree>(signal, 5, 2, &wavelet, DyadicMode::Odd,
+                                      padding_mode);
+    TestUpdateTree<WaveletPacketTree>(signal, 5, 2, &wavelet,
+                                      DyadicMode::Even, padding_mode);
+    TestUpdateTree<WaveletPacketTree>(signal, 5, 2, &wavelet, DyadicMode::Odd,
+                                      padding_mode, TransformEngine::Lifting);
+    TestUpdateTree<StationaryWaveletPacketTree>(signal, 3, 4, &wavelet,
+                                                padding_mode);
+    TestUpdateTree<StationaryWaveletPacketTree>(
+        signal, 3, 4, &wavelet, padding_mode, TransformEngine::Lifting);
+    TestUpdateTree<MultichannelWaveletPacketTree>(
+        interleaved, 4, 2, &wavelet, size_t{3}, DyadicMode::Odd,
+        padding_mode);
+  }
+
+  // A signal shorter than the filter with symmetric padding.
+  const std::vector<double> short_signal(signal.cbegin(),
+                                         signal.cbegin() + 23);
+  TestUpdateTree<WaveletPacketTree>(short_signal, 4, 2, &wavelet,
+                                    DyadicMode::Odd, PaddingMode::Symmetric);
+  // Lifting reads further into the padding, and a periodic signal of odd
+  // length repeats its last element.
+  for (const auto padding_mode : padding_modes) {
+    TestUpdateTree<WaveletPacketTree>(short_signal, 4, 2, &wavelet,
+                                      DyadicMode::Odd, padding_mode,
+                                      TransformEngine::Lifting);
+  }
+  std::cout << "Pass" << std::endl;
+}
+
+// Search the greedy basis of a fully decomposed tree the way
+// DecomposeBestBasis does, reading every node through GetNodeSignal.
+void SearchBestBasis(WaveletPacketTree* tree, size_t height,
+                     const BasisCost& cost, size_t depth, size_t position,
+                     double node_cost, std::vector<BasisNode>* basis) {
+  if (depth + 1 < height) {
+    const double left_cost =
+        cost.Evaluate(tree->GetNodeSignal(depth + 1, 2 * position));
+    const double right_cost =
+        cost.Evaluate(tree->GetNodeSignal(depth + 1, 2 * position + 1));
+    if (left_cost + right_cost < node_cost) {
+      SearchBestBasis(tree, height, cost, depth + 1, 2 * position, left_cost,
+                      basis);
+      SearchBestBasis(tree, height, cost, depth + 1, 2 * position + 1,
+                      right_cost, basis);
+      return;
+    }
+  }
+  basis->push_back(
+      {depth, position, node_cost, tree->GetNodeSignal(depth, position)});
+}
+
+double SumOfMagnitudes(void* /*context*/, Span<const double> coefficients) {
+  double sum = 0.0;
+  for (const double value : coefficients) {
+    sum += std::abs(value);
+  }
+  return sum;
+}
+
+void TestBestBasis(const std::vector<double>& signal) {
+  std::cout << "Testing best basis search" << std::endl;
+  constexpr size_t height = 7;
+  Wavelet wavelet;
+  Wavelet::GetWaveletCoefficients(&wavelet, Wavelet::WaveletType::Daubechies,
+                                  8);
+
+  // A chirp spreads its energy over several frequency bands.
+  std::vector<double> chirp(signal.size());
+  for (size_t i = 0; i < chirp.size(); i++) {
+    const double t = static_cast<double>(i) / chirp.size();
+    chirp[i] = std::sin(200.0 * t * t) + 0.01 * signal[i];
+  }
+
+  BasisCost costs[4];
+  costs[1].function = CostFunction::LogEnergy;
+  costs[2].function = CostFunction::Threshold;
+  costs[2].threshold = 0.5;
+  costs[3].function = CostFunction::Custom;
+  costs[3].custom = SumOfMagnitudes;
+
+  WaveletPacketTree full(height, &wavelet);
+  full.SetRootSignal(chirp);
+  full.Decompose();
+
+  for (const BasisCost& cost : costs) {
+    std::vector<BasisNode> expected;
+    SearchBestBasis(&full, height, cost, 0, 0, cost.Evaluate(chirp),
+                    &expected);
+
+    for (const bool lazy : {false, true}) {
+      WaveletPacketTree tree(height, &wavelet);
+      tree.SetLazyDecomposition(lazy);
+      tree.SetRootSignal(chirp);
+      std::vector<BasisNode> basis;
+      const double total = tree.DecomposeBestBasis(cost, &basis);
+
+      // The basis tiles the root exactly once and its cost adds up.
+      double coverage = 0.0;
+      double sum = 0.0;
+      for (const BasisNode& node : basis) {
+        coverage += std::ldexp(1.0, -static_cast<int>(node.depth));
+        sum += node.cost;
+      }
+      bool pass = basis.size() == expected.size() && coverage == 1.0 &&
+                  std::abs(sum - total) <= 1e-12 * std::abs(total);
+      for (size_t i = 0; pass && i < basis.size(); i++) {
+        pass = basis[i].depth == expected[i].depth &&
+               basis[i].position == expected[i].position &&
+               basis[i].cost == expected[i].cost &&
+               std::equal(basis[i].coefficients.begin(),
+                          basis[i].coefficients.end(),
+                          expected[i].coefficients.begin(),
+                          expected[i].coefficients.end());
+      }
+      if (!pass) {
+        std::cout << "Best basis of cost " << static_cast<int>(cost.function)
+                  << " differs from a search of the full tree." << std::endl
+                  << "FAIL" << std::endl;
+        exit(-1);
+      }
+    }
+  }
+  std::cout << "Pass" << std::endl;
+}
+
+// Check a tree mapped from a file holds every node of the tree which saved
+// it, in place in the mapping, and reconstructs the same levels.
+template <class Tree, class Sample>
+void TestMappedTree(Tree* saved, Tree* mapped, TreeFile* file, size_t height,
+                    size_t children) {
+  size_t depth_size = 1;
+  size_t node = 0;
+  for (size_t depth = 0; depth < height; depth++) {
+    for (size_t position = 0; position < depth_size; position++, node++) {
+      const Span<const Sample> expected = saved->GetNodeSignal(depth, position);
+      const Span<const Sample> actual = mapped->GetNodeSignal(depth, position);
+      if (!std::equal(expected.begin(), expected.end(), actual.begin(),
+                      actual.end()) ||
+          (node != 0 &&
+           actual.data() != file->GetNodeSignal<Sample>(node).data())) {
+        std::cout << "Mapped node at depth " << depth << " position "
+                  << position << " differs from the saved tree." << std::endl
+                  << "FAIL" << std::endl;
+        exit(-1);
+      }
+    }
+    depth_size *= children;
+  }
+
+  const size_t signal_size = saved->GetRootSignal().size();
+  std::vector<Sample> expected(saved->GetWaveletLevelCount() * signal_size);
+  std::vector<Sample> actual(expected.size());
+  saved->ReconstructAll(expected);
+  mapped->ReconstructAll(actual);
+  if (expected != actual) {
+    std::cout << "Mapped tree reconstructs differently." << std::endl
+              << "FAIL" << std::endl;
+    exit(-1);
+  }
+}
+
+void TestTreeFiles(const std::vector<double>& signal) {
+  std::cout << "Testing tree files" << std::endl;
+  const char* path = "panwave_test_tree.bin";
+  const char* truncated_path = "panwave_test_truncated.bin";
+  Wavelet wavelet;
+  Wavelet::GetWaveletCoefficients(&wavelet, Wavelet::WaveletType::Daubechies,
+                                  4);
+  TreeFile file;
+  bool pass = true;
+
+  WaveletPacketTree saved(5, &wavelet, DyadicMode::Even,
+                          PaddingMode::Symmetric);
+  saved.SetRootSignal(signal);
+  saved.Decompose();
+  pass = pass && saved.Save(path) && file.Open(path);
+
+  // A tree built from the description of the file maps it.
+  const TreeFile::Description& description = file.GetDescription();
+  WaveletPacketTree mapped(description.height, &file.GetWavelet(),
+                           description.dyadic_mode, description.padding_mode,
+                           description.engine);
+  pass = pass && mapped.MapFile(&file);
+  TestMappedTree<WaveletPacketTree, double>(&saved, &mapped, &file, 5, 2);
+
+  // Trees of another kind are refused.
+  WaveletPacketTree zeroes(5, &wavelet, DyadicMode::Even, PaddingMode::Zeroes);
+  WaveletPacketTree taller(6, &wavelet, DyadicMode::Even,
+                           PaddingMode::Symmetric);
+  panwave::BasicWaveletPacketTree<float> single(5, &wavelet, DyadicMode::Even,
+                                                PaddingMode::Symmetric);
+  WaveletPacketTree lifting(5, &wavelet, DyadicMode::Even,
+                            PaddingMode::Symmetric, TransformEngine::Lifting);
+  pass = pass && !zeroes.MapFile(&file) && !taller.MapFile(&file) &&
+         !single.MapFile(&file) && !lifting.MapFile(&file);
+
+  // Setting a root signal moves the nodes out of the file.
+  mapped.SetRootSignal(signal);
+  mapped.Decompose();
+  file.Close();
+  TestMappedTree<WaveletPacketTree, double>(&saved, &mapped, &file, 1, 2);
+
+  // A truncated file fails to open.
+  std::ifstream input(path, std::ios::binary);
+  const std::vector<char> bytes((std::istreambuf_iterator<char>(input)),
+                                std::istreambuf_iterator<char>());
+  input.close();
+  std::ofstream(truncated_path, std::ios::binary)
+      .write(bytes.data(), static_cast<std::streamsize>(bytes.size() - 8));
+  pass = pass && !file.Open(truncated_path) && !file.IsOpen();
+
+  StationaryWaveletPacketTree stationary(3, &wavelet, PaddingMode::Zeroes);
+  StationaryWaveletPacketTree mapped_stationary(3, &wavelet,
+                                                PaddingMode::Zeroes);
+  stationary.SetRootSignal(signal);
+  stationary.Decompose();
+  pass = pass && stationary.Save(path) && file.Open(path) &&
+         mapped_stationary.MapFile(&file);
+  TestMappedTree<StationaryWaveletPacketTree, double>(
+      &stationary, &mapped_stationary, &file, 3, 4);
+
+  // Lazy trees decompose whatever they have not yet before saving.
+  const std::vector<float> float_signal(signal.cbegin(), signal.cend());
+  panwave::BasicWaveletPacketTree<float> lazy(4, &wavelet);
+  panwave::BasicWaveletPacketTree<float> mapped_lazy(4, &wavelet);
+  lazy.SetLazyDecomposition(true);
+  lazy.SetRootSignal(float_signal);
+  pass = pass && lazy.Save(path) && file.Open(path) &&
+         mapped_lazy.MapFile(&file);
+  TestMappedTree<panwave::BasicWaveletPacketTree<float>, float>(
+      &lazy, &mapped_lazy, &file, 4, 2);
+  file.Close();
+
+  std::remove(path);
+  std::remove(truncated_path);
+  if (!pass) {
+    std::cout << "Tree file was not saved, opened or mapped as expected."
+              << std::endl
+              << "FAIL" << std::endl;
+    exit(-1);
+  }
+  std::cout << "Pass" << std::endl;
+}
+
+// Check a tree whose root signal is a view of a buffer decomposes and
+// reconstructs like a tree holding a copy, and never writes to the buffer.
+template <class Tree, class... Args>
+void TestRootView(const std::vector<double>& signal, size_t height,
+                  size_t children, Args... args) {
+  Tree viewed(height, args...);
+  Tree copied(height, args...);
+  const std::vector<double> buffer = signal;
+  viewed.SetRootSignalView(buffer);
+  copied.SetRootSignal(signal);
+  viewed.Decompose();
+  copied.Decompose();
+
+  bool pass = viewed.GetNodeSignal(0, 0).data() == buffer.data();
+  size_t depth_size = 1;
+  for (size_t depth = 0; depth < height; depth++) {
+    for (size_t position = 0; position < depth_size; position++) {
+      const Span<const double> left = copied.GetNodeSignal(depth, position);
+      const Span<const double> right = viewed.GetNodeSignal(depth, position);
+      pass = pass && std::equal(left.begin(), left.end(), right.begin(),
+                                right.end());
+    }
+    depth_size *= children;
+  }
+
+  // Every level reconstructs into the buffer of the caller, and the last
+  // one into a root signal which replaces the view.
+  std::vector<double> level_signal(signal.size());
+  for (size_t level = 0; level < copied.GetWaveletLevelCount(); level++) {
+    copied.Reconstruct(level);
+    viewed.Reconstruct(level, level_signal);
+    pass = pass && level_signal == copied.GetRootSignal();
+  }
+  viewed.Reconstruct(copied.GetWaveletLevelCount() - 1);
+  pass = pass && viewed.GetRootSignal() == copied.GetRootSignal();
+
+  // Updates copy the view into the tree first.
+  viewed.SetRootSignalView(buffer);
+  copied.SetRootSignal(signal);
+  viewed.Decompose();
+  copied.Decompose();
+  const std::vector<double> values = {-1.0, 2.0, -3.0};
+  viewed.UpdateRootSignal(10, values);
+  copied.UpdateRootSignal(10, values);
+  const Span<const double> left = copied.GetNodeSignal(1, 1);
+  const Span<const double> right = viewed.GetNodeSignal(1, 1);
+  pass = pass && viewed.GetRootSignal() == copied.GetRootSignal() &&
+         std::equal(left.begin(), left.end(), right.begin(), right.end());
+
+  if (!pass || buffer != signal) {
+    std::cout << "Tree with a root signal view differs from a tree holding "
+                 "a copy."
+              << std::endl
+              << "FAIL" << std::endl;
+    exit(-1);
+  }
+}
+
+void TestRootViews(const std::vector<double>& signal) {
+  std::cout << "Testing root signal views" << std::endl;
+  Wavelet wavelet;
+  Wavelet::GetWaveletCoefficients(&wavelet, Wavelet::WaveletType::Daubechies,
+                                  4);
+
+  TestRootView<WaveletPacketTree>(signal, 5, 2, &wavelet, DyadicMode::Odd,
+                                  PaddingMode::Symmetric);
+  TestRootView<StationaryWaveletPacketTree>(signal, 3, 4, &wavelet,
+                                            PaddingMode::Zeroes);
+  std::cout << "Pass" << std::endl;
+}
+
+// Check every channel of a multichannel tree reconstructs each wavelet level
+// exactly as a tree over that channel alone does.
+void TestMultichannel(size_t channel_count, const std::vector<double>& signal,
+                      DyadicMode dyadic_mode, PaddingMode padding_mode) {
+  constexpr size_t height = 4;
+  const size_t signal_size = signal.size();
+  Wavelet wavelet;
+  Wavelet::GetWaveletCoefficients(&wavelet, Wavelet::WaveletType::Daubechies,
+                                  8);
+
+  std::vector<double> signals(signal_size * channel_count);
+  for (size_t i = 0; i < signal_size; i++) {
+    for (size_t c = 0; c < channel_count; c++) {
+      signals[i * channel_count + c] =
+          signal[i] * static_cast<double>(c + 1) + static_cast<double>(c);
+    }
+  }
+
+  MultichannelWaveletPacketTree tree(height, &wavelet, channel_count,
+                                     dyadic_mode, padding_mode);
+  const size_t level_count = tree.GetWaveletLevelCount();
+  std::vector<double> levels(level_count * signals.size());
+  tree.SetRootSignal(signals);
+  tree.Decompose();
+  tree.ReconstructAll(levels);
+
+  WaveletPacketTree channel_tree(height, &wavelet, dyadic_mode, padding_mode);
+  std::vector<double> channel_signal(signal_size);
+  std::vector<double> channel_levels(level_count * signal_size);
+  for (size_t c = 0; c < channel_count; c++) {
+    for (size_t i = 0; i < signal_size; i++) {
+      channel_signal[i] = signals[i * channel_count + c];
+    }
+    channel_tree.SetRootSignal(channel_signal);
+    channel_tree.Decompose();
+    channel_tree.ReconstructAll(channel_levels);
+
+    for (size_t i = 0; i < channel_levels.size(); i++) {
+      if (levels[i * channel_count + c] != channel_levels[i]) {
+        std::cout << "Channel " << c << " of " << channel_count
+                  << " differs from a single channel tree." << std::endl
+                  << "FAIL" << std::endl;
+        exit(-1);
+      }
+    }
+  }
+}
+
+void TestMultichannels(const std::vector<double>& signal) {
+  std::cout << "Testing multichannel trees" << std::endl;
+  const size_t channel_counts[] = {2, 5, 37};
+  const DyadicMode dyadic_modes[] = {DyadicMode::Even, DyadicMode::Odd};
+  const PaddingMode padding_modes[] = {PaddingMode::Zeroes,
+                                       PaddingMode::Symmetric};
+
+  for (const size_t channel_count : channel_counts) {
+    for (const auto dyadic_mode : dyadic_modes) {
+      for (const auto padding_mode : padding_modes) {
+        TestMultichannel(channel_count, signal, dyadic_mode, padding_mode);
+      }
+    }
+  }
+  std::cout << "Pass" << std::endl;
+}
+
+template <Wavelet::WaveletType Type, size_t P>
+void TestStaticWavelet(const std::vector<double>& signal) {
+  Wavelet wavelet;
+  Wavelet::GetWaveletCoefficients(&wavelet, Type, P);
+  const Wavelet& static_wavelet = StaticWavelet<Type, P>::GetWavelet();
+  Check(&wavelet.lowpassDecompositionFilter_,
+        &static_wavelet.lowpassDecompositionFilter_);
+  Check(&wavelet.highpassDecompositionFilter_,
+        &static_wavelet.highpassDecompositionFilter_);
+  Check(&wavelet.lowpassReconstructionFilter_,
+        &static_wavelet.lowpassReconstructionFilter_);
+  Check(&wavelet.highpassReconstructionFilter_,
+        &static_wavelet.highpassReconstructionFilter_);
+  static_assert(StaticWavelet<Type, P>::FilterSize == 2 * P ||
+                    Type == Wavelet::WaveletType::Coiflet,
+                "Unexpected filter size.");
+
+  WaveletPacketTree tree(4, StaticWavelet<Type, P>());
+  TestWPT(&tree, signal, true);
+  StationaryWaveletPacketTree swpt(3, StaticWavelet<Type, P>());
+  TestWPT(&swpt, signal, true);
+}
+
+void TestStaticWavelets(const std::vector<double>& signal) {
+  std::cout << "Testing static wavelets" << std::endl;
+  TestStaticWavelet<Wavelet::WaveletType::Daubechies, 2>(signal);
+  TestStaticWavelet<Wavelet::WaveletType::Daubechies, 10>(signal);
+  TestStaticWavelet<Wavelet::WaveletType::Symlet, 4>(signal);
+  TestStaticWavelet<Wavelet::WaveletType::Coiflet, 1>(signal);
+  TestStaticWavelet<Wavelet::WaveletType::Coiflet, 2>(signal);
+  std::cout << "Pass" << std::endl;
+}
+
+// Check actual is within the documented kernel tolerance of expected.
+// |magnitude| holds the sums of the absolute values of the products which
+// contributed to each element of expected.
+template <class Sample, class Accumulator>
+void CheckKernelResult(const std::vector<Sample>& expected,
+                       const std::vector<Sample>& actual,
+                       const std::vector<Sample>& magnitude,
+                       size_t filter_size) {
+  for (size_t i = 0; i < expected.size(); i++) {
+    const double tolerance =
+        (static_cast<double>(filter_size) *
+             std::numeric_limits<Accumulator>::epsilon() +
+         std::numeric_limits<Sample>::epsilon()) *
+        magnitude[i];
+    if (fabs(expected[i] - actual[i]) > tolerance) {
+      std::cout << "Kernel result " << i << " out of tolerance. Expected: "
+                << expected[i] << " Actual: " << actual[i] << std::endl;
+      std::cout << "FAIL" << std::endl;
+      exit(-1);
+    }
+  }
+}
+
+// Check the channel kernels compute every channel exactly as the single
+// channel kernels of the same instruction set compute it on its own.
+template <class Sample, class Accumulator>
+void TestChannelKernels(
+    const BasicWaveletKernels<Sample, Accumulator>& kernels,
+    const std::vector<Accumulator>& lowpass,
+    const std::vector<Accumulator>& highpass) {
+  constexpr size_t output_size = 9;
+  constexpr size_t data_size = 2 * output_size;
+  const size_t channel_counts[] = {1, 3, 21, 70};
+  const size_t filter_size = lowpass.size();
+  const size_t input_size = data_size + filter_size;
+
+  for (const size_t channel_count : channel_counts) {
+    std::vector<Sample> data(input_size * channel_count);
+    for (size_t i = 0; i < input_size; i++) {
+      for (size_t c = 0; c < channel_count; c++) {
+        data[i * channel_count + c] = static_cast<Sample>(
+            std::sin(static_cast<double>(i) * 0.7 +
+                     static_cast<double>(c) * 0.3) *
+            10.0);
+      }
+    }
+
+    std::vector<Sample> approx(output_size * channel_count);
+    std::vector<Sample> details(output_size * channel_count);
+    std::vector<Sample> reconstructed(data_size * channel_count);
+    kernels.decimate_channels(data.data(), lowpass.data(), highpass.data(),
+                              filter_size, approx.data(), details.data(),
+                              output_size, channel_count);
+    kernels.reconstruct_channels(data.data(), lowpass.data(), filter_size,
+                                 reconstructed.data(), data_size,
+                                 channel_count);
+
+    std::vector<Sample> channel(input_size);
+    std::vector<Sample> expected(output_size);
+    std::vector<Sample> expected_details(output_size);
+    std::vector<Sample> expected_reconstructed(data_size);
+    for (size_t c = 0; c < channel_count; c++) {
+      for (size_t i = 0; i < input_size; i++) {
+        channel[i] = data[i * channel_count + c];
+      }
+      kernels.decimate(channel.data(), lowpass.data(), highpass.data(),
+                       filter_size, expected.data(), expected_details.data(),
+                       output_size);
+      kernels.reconstruct(channel.data(), lowpass.data(), filter_size,
+                          expected_reconstructed.data(), data_size);
+
+      bool same = true;
+      for (size_t m = 0; m < output_size; m++) {
+        same = same && approx[m * channel_count + c] == expected[m] &&
+               details[m * channel_count + c] == expected_details[m];
+      }
+      for (size_t n = 0; n < data_size; n++) {
+        same = same && reconstructed[n * channel_count + c] ==
+                           expected_reconstructed[n];
+      }
+      if (!same) {
+        std::cout << "Channel kernel result differs for channel " << c
+                  << " of " << channel_count << "." << std::endl
+                  << "FAIL" << std::endl;
+        exit(-1);
+      }
+    }
+  }
+}
+
+template <class Sample, class Accumulator>
+void TestThresholdKernels(
+    const BasicWaveletKernels<Sample, Accumulator>& kernels) {
+  constexpr size_t max_size = 40;
+  const Accumulator threshold = static_cast<Accumulator>(4.5);
+
+  // Include values exactly at the threshold, which hard thresholding zeroes.
+  std::vector<Sample> data(max_size);
+  for (size_t i = 0; i < max_size; i++) {
+    data[i] =
+        static_cast<Sample>(std::sin(static_cast<double>(i) * 0.7) * 10.0);
+  }
+  data[3] = static_cast<Sample>(threshold);
+  data[7] = static_cast<Sample>(-threshold);
+
+  for (size_t size = 0; size <= max_size; size++) {
+    std::vector<Sample> soft(size);
+    std::vector<Sample> hard(data.cbegin(),
+                             data.cbegin() + static_cast<ptrdiff_t>(size));
+    kernels.soft_threshold(data.data(), threshold, soft.data(), size);
+    kernels.hard_threshold(hard.data(), threshold, hard.data(), size);
+
+    for (size_t i = 0; i < size; i++) {
+      const Accumulator value = data[i];
+      const Accumulator shrunk =
+          std::max(std::abs(value) - threshold, Accumulator{0});
+      const auto expected_soft =
+          static_cast<Sample>(value < 0 ? -shrunk : shrunk);
+      const Sample expected_hard =
+          std::abs(value) > threshold ? data[i] : Sample{0};
+      if (soft[i] != expected_soft || hard[i] != expected_hard) {
+        std::cout << "Threshold kernel result differs at " << i << " of "
+                  << size << "." << std::endl
+                  << "FAIL" << std::endl;
+        exit(-1);
+      }
+    }
+  }
+}
+
+template <class Sample, class Accumulator>
+void TestKernels(const BasicWaveletKernels<Sample, Accumulator>& kernels) {
+  const auto& scalar =
+      *panwave::GetWaveletKernels<Sample, Accumulator>(KernelIsa::Scalar);
+  const auto check = CheckKernelResult<Sample, Accumulator>;
+  constexpr size_t max_filter_size = 31;
+  constexpr size_t max_output_size = 40;
+  constexpr size_t input_size = 2 * max_output_size + max_filter_size;
+
+  std::vector<Sample> data(input_size);
+  std::vector<Sample> abs_data(input_size);
+  for (size_t i = 0; i < input_size; i++) {
+    data[i] =
+        static_cast<Sample>(std::sin(static_cast<double>(i) * 0.7) * 10.0);
+    abs_data[i] = std::abs(data[i]);
+  }
+
+  TestThresholdKernels(kernels);
+
+  for (size_t filter_size = 1; filter_size <= max_filter_size; filter_size++) {
+    std::vector<Accumulator> lowpass(filter_size);
+    std::vector<Accumulator> highpass(filter_size);
+    std::vector<Accumulator> abs_lowpass(filter_size);
+    std::vector<Accumulator> abs_highpass(filter_size);
+    for (size_t j = 0; j < filter_size; j++) {
+      lowpass[j] = static_cast<Accumulator>(
+          std::cos(static_cast<double>(j) * 1.3) / 3.0);
+      highpass[j] = static_cast<Accumulator>(
+          std::sin(static_cast<double>(j) * 0.9 + 0.1) / 7.0);
+      abs_lowpass[j] = std::abs(lowpass[j]);
+      abs_highpass[j] = std::abs(highpass[j]);
+    }
+
+    TestChannelKernels(kernels, lowpass, highpass);
+
+    for (size_t size = 0; size <= max_output_size; size++) {
+      std::vector<Sample> expected(size);
+      std::vector<Sample> expected_details(size);
+      std::vector<Sample> magnitude(size);
+      std::vector<Sample> magnitude_details(size);
+      std::vector<Sample> actual(size);
+      std::vector<Sample> actual_details(size);
+
+      scalar.convolve(data.data(), lowpass.data(), filter_size,
+                      expected.data(), size);
+      scalar.convolve(abs_data.data(), abs_lowpass.data(), filter_size,
+                      magnitude.data(), size);
+      kernels.convolve(data.data(), lowpass.data(), filter_size, actual.data(),
+                       size);
+      check(expected, actual, magnitude, filter_size);
+
+      scalar.decimate(data.data(), lowpass.data(), highpass.data(),
+                      filter_size, expected.data(), expected_details.data(),
+                      size);
+      scalar.decimate(abs_data.data(), abs_lowpass.data(),
+                      abs_highpass.data(), filter_size, magnitude.data(),
+                      magnitude_details.data(), size);
+      kernels.decimate(data.data(), lowpass.data(), highpass.data(),
+                       filter_size, actual.data(), actual_details.data(), size);
+      check(expected, actual, magnitude, filter_size);
+      check(expected_details, actual_details, magnitude_details,
+                        filter_size);
+
+      // The odd phase of the dual phase kernel is the decimation of the data
+      // one element later.
+      std::vector<Sample> odd_expected(size);
+      std::vector<Sample> odd_expected_details(size);
+      std::vector<Sample> odd_magnitude(size);
+      std::vector<Sample> odd_magnitude_details(size);
+      std::vector<Sample> odd_actual(size);
+      std::vector<Sample> odd_actual_details(size);
+      scalar.decimate(data.data() + 1, lowpass.data(), highpass.data(),
+                      filter_size, odd_expected.data(),
+                      odd_expected_details.data(), size);
+      scalar.decimate(abs_data.data() + 1, abs_lowpass.data(),
+                      abs_highpass.data(), filter_size, odd_magnitude.data(),
+                      odd_magnitude_details.data(), size);
+      kernels.decimate_dual_phase(
+          data.data(), lowpass.data(), highpass.data(), filter_size,
+          actual.data(), actual_details.data(), odd_actual.data(),
+          odd_actual_details.data(), size);
+      check(expected, actual, magnitude, filter_size);
+      check(expected_details, actual_details, magnitude_details,
+                        filter_size);
+      check(odd_expected, odd_actual, odd_magnitude, filter_size);
+      check(odd_expected_details, odd_actual_details,
+                        odd_magnitude_details, filter_size);
+
+      scalar.reconstruct(data.data(), lowpass.data(), filter_size,
+                         expected.data(), size);
+      scalar.reconstruct(abs_data.data(), abs_lowpass.data(), filter_size,
+                         magnitude.data(), size);
+      kernels.reconstruct(data.data(), lowpass.data(), filter_size,
+                          actual.data(), size);
+      check(expected, actual, magnitude, filter_size);
+
+      // The lift kernel accumulates into its target, seed it with the same
+      // values for the scalar and instruction set specific runs.
+      for (size_t m = 0; m < size; m++) {
+        expected[m] = data[m + 1];
+        actual[m] = data[m + 1];
+        magnitude[m] = abs_data[m + 1];
+      }
+      scalar.lift(data.data(), highpass.data(), filter_size, expected.data(),
+                  size);
+      scalar.lift(abs_data.data(), abs_highpass.data(), filter_size,
+                  magnitude.data(), size);
+      kernels.lift(data.data(), highpass.data(), filter_size, actual.data(),
+                   size);
+      check(expected, actual, magnitude, filter_size + 1);
+    }
+  }
+}
+
+template <class Sample, class Accumulator>
+void TestKernelsOfType(const char* type_name) {
+  // The scalar kernels are the reference for the others. They are tested as
+  // well since the dual phase kernel is checked against scalar decimate.
+  const KernelIsa isas[] = {KernelIsa::Scalar, KernelIsa::Sse2,
+                            KernelIsa::Avx2, KernelIsa::Avx512};
+  const char* names[] = {"scalar", "SSE2", "AVX2", "AVX-512"};
+
+  for (size_t i = 0; i < std::size(isas); i++) {
+    const auto* kernels =
+        panwave::GetWaveletKernels<Sample, Accumulator>(isas[i]);
+    if (kernels == nullptr) {
+      std::cout << "Skipping unsupported " << names[i] << " " << type_name
+                << " kernels" << std::endl;
+      continue;
+    }
+    std::cout << "Testing " << names[i] << " " << type_name << " kernels"
+              << std::endl;
+    TestKernels(*kernels);
+    std::cout << "Pass" << std::endl;
+  }
+}
+
+void TestAllKernels() {
+  TestKernelsOfType<double, double>("double");
+  TestKernelsOfType<float, float>("float");
+  TestKernelsOfType<float, double>("float/double");
+}
+
 struct DyadicTest {
   std::initializer_list<double> signal;
   std::initializer_list<double> expected;
@@ -215,8 +1912,603 @@ const PadTest padTests[] = {
      6,
      6,
      PaddingMode::Zeroes},
+    {{1, 2, 3, 4, 5},
+     {1, 2, 3, 4, 5, 5, 1, 2, 3, 4, 5, 5, 1, 2, 3, 4, 5},
+     6,
+     6,
+     PaddingMode::Periodic},
+    {{1, 2, 3, 4},
+     {2, 3, 4, 1, 2, 3, 4, 1, 2, 3, 4, 1},
+     3,
+     5,
+     PaddingMode::Periodic},
 };
 
+// Check the profile of a tree counts every node decomposed and
+// reconstructed, and every primitive call made for it, once. Without
+// instrumentation the profile must stay empty.
+void TestInstrumentation(const std::vector<double>& signal) {
+  std::cout << "Testing instrumentation" << std::endl;
+  constexpr size_t height = 6;
+  constexpr size_t internal_count = 31;
+  Wavelet wavelet;
+  Wavelet::GetWaveletCoefficients(&wavelet, Wavelet::WaveletType::Daubechies,
+                                  4);
+
+  TaskScheduler scheduler(3);
+  WaveletPacketTree tree(height, &wavelet);
+  tree.SetTaskScheduler(&scheduler, 1);
+  tree.SetRootSignal(signal);
+  tree.Decompose();
+  tree.Reconstruct(0);
+
+  const TreeProfile& profile = tree.GetProfile();
+  const std::vector<NodeCounters> nodes = profile.GetNodeCounters();
+  const std::vector<PrimitiveCounters> primitives =
+      profile.GetPrimitiveCounters();
+  std::ostringstream report;
+  profile.WriteReport(report);
+  bool pass = !report.str().empty();
+
+  if (InstrumentationEnabled) {
+    // Every node below the root holds a span of the node buffer.
+    uint64_t node_bytes = 0;
+    for (size_t node = 0; node < nodes.size(); node++) {
+      const bool internal = node < internal_count;
+      pass = pass && nodes[node].decompositions == (internal ? 1U : 0U);
+    }
+    for (size_t depth = 1; depth < height; depth++) {
+      for (size_t position = 0; position < (1U << depth); position++) {
+        node_bytes +=
+            tree.GetNodeSignal(depth, position).size() * sizeof(double);
+      }
+    }
+
+    // Level 0 is reconstructed from the leftmost node at each depth.
+    for (size_t depth = 0; depth < height; depth++) {
+      const NodeCounters counters = profile.GetDepthCounters(depth);
+      pass = pass && counters.decompositions ==
+                         (depth + 1 < height ? 1U << depth : 0U) &&
+             counters.reconstructions == (depth > 0 ? 1U : 0U);
+    }
+    pass = pass && profile.GetDepthCount() == height &&
+           nodes[(1U << (height - 1)) - 1].reconstructions == 1;
+
+    uint64_t decompose_calls = 0;
+    uint64_t reconstruct_calls = 0;
+    for (const PrimitiveCounters& counters : primitives) {
+      pass = pass &&
+             counters.filter_size == wavelet.lowpassDecompositionFilter_.size();
+      if (counters.primitive == Primitive::Decompose) {
+        decompose_calls += counters.calls;
+        pass = pass && counters.bytes_written == node_bytes;
+      } else if (counters.primitive == Primitive::Reconstruct) {
+        reconstruct_calls += counters.calls;
+      }
+    }
+    pass = pass && decompose_calls == internal_count &&
+           reconstruct_calls == height - 1 &&
+           profile.GetBufferAllocationCount() > 0 &&
+           profile.GetPeakBufferFootprint() >= node_bytes &&
+           report.str().find("Decompose") != std::string::npos;
+
+    tree.ResetProfile();
+    pass = pass && tree.GetProfile().GetPrimitiveCounters().empty() &&
+           tree.GetProfile().GetDepthCounters(1).decompositions == 0 &&
+           tree.GetProfile().GetPeakBufferFootprint() ==
+               tree.GetProfile().GetBufferFootprint();
+
+    // Reconfiguring the tree and laying out its nodes again frees as much
+    // as it allocates.
+    const uint64_t footprint = tree.GetProfile().GetBufferFootprint();
+    tree.SetTaskScheduler(nullptr, 1);
+    tree.Decompose();
+    tree.SetLazyDecomposition(true);
+    tree.GetNodeSignal(height - 1, 0);
+    tree.SetLazyDecomposition(false);
+    tree.SetTaskScheduler(&scheduler, 1);
+    tree.Decompose();
+    pass = pass && tree.GetProfile().GetBufferFootprint() == footprint;
+
+    // A buffer is freed from the profile it was allocated in, wherever it
+    // is freed.
+    TreeProfile allocating;
+    TreeProfile freeing;
+    {
+      AlignedVector<double> buffer;
+      {
+        const TreeProfile::Scope scope(&allocating);
+        buffer.resize(16);
+      }
+      pass = pass && allocating.GetBufferFootprint() == 16 * sizeof(double);
+      const TreeProfile::Scope scope(&freeing);
+      AlignedVector<double>().swap(buffer);
+    }
+    pass = pass && allocating.GetBufferFootprint() == 0 &&
+           freeing.GetBufferAllocationCount() == 0;
+  } else {
+    pass = pass && nodes.empty() && primitives.empty() &&
+           profile.GetDepthCount() == 0 &&
+           profile.GetBufferAllocationCount() == 0 &&
+           profile.GetPeakBufferFootprint() == 0;
+  }
+
+  if (!pass) {
+    std::cout << "Tree profile does not match the work done." << std::endl
+              << "FAIL" << std::endl;
+    exit(-1);
+  }
+  std::cout << "Pass" << std::endl;
+}
+
+// Check an undecimated tree against a direct evaluation of the dilated
+// filters, its wavelet levels add up to the signal, and circularly shifting
+// the signal shifts every node.
+void TestUndecimated(const std::vector<double>& signal, size_t height,
+                     Wavelet::WaveletType type, size_t vanishing_moment) {
+  const size_t size = signal.size();
+  Wavelet wavelet;
+  Wavelet::GetWaveletCoefficients(&wavelet, type, vanishing_moment);
+  const std::vector<double>& lowpass = wavelet.lowpassDecompositionFilter_;
+  const std::vector<double>& highpass = wavelet.highpassDecompositionFilter_;
+
+  UndecimatedWaveletPacketTree tree(height, &wavelet);
+  tree.SetRootSignal(signal);
+  tree.Decompose();
+
+  // Every node is as long as the root, so subtrees reach the default grain
+  // size well before a decimated tree's would.
+  TaskScheduler scheduler(3);
+  const size_t grain_sizes[] = {0, WaveletPacketTreeBase::DefaultGrainSize};
+  for (const size_t grain_size : grain_sizes) {
+    UndecimatedWaveletPacketTree serial(height, &wavelet);
+    UndecimatedWaveletPacketTree parallel(height, &wavelet);
+    TestParallelDecompose(&serial, &parallel, &scheduler, grain_size, signal);
+  }
+
+  bool pass = true;
+  size_t dilation = 1;
+  for (size_t depth = 0; depth + 1 < height; depth++) {
+    for (size_t position = 0; position < (1U << depth); position++) {
+      const Span<const double> parent = tree.GetNodeSignal(depth, position);
+      const Span<const double> approx =
+          tree.GetNodeSignal(depth + 1, 2 * position);
+      const Span<const double> details =
+          tree.GetNodeSignal(depth + 1, 2 * position + 1);
+      pass = pass && approx.size() == size && details.size() == size;
+      for (size_t n = 0; pass && n < size; n++) {
+        double expected_approx = 0.0;
+        double expected_details = 0.0;
+        for (size_t j = 0; j < lowpass.size(); j++) {
+          const size_t index = (n + size - j * dilation % size) % size;
+          expected_approx += lowpass[j] * parent[index];
+          expected_details += highpass[j] * parent[index];
+        }
+        pass = std::fabs(expected_approx - approx[n]) < 1e-9 &&
+               std::fabs(expected_details - details[n]) < 1e-9;
+      }
+    }
+    dilation *= 2;
+  }
+
+  std::vector<double> sum(size);
+  std::vector<double> levels(tree.GetWaveletLevelCount() * size);
+  tree.ReconstructAll(levels);
+  for (size_t level = 0; level < tree.GetWaveletLevelCount(); level++) {
+    tree.Reconstruct(level);
+    const std::vector<double>& root = tree.GetRootSignal();
+    pass = pass && std::equal(root.begin(), root.end(),
+                              levels.begin() + level * size);
+    for (size_t i = 0; i < size; i++) {
+      sum[i] += root[i];
+    }
+  }
+  // The well-known filters are only orthogonal to the precision they are
+  // tabulated with.
+  for (size_t i = 0; i < size; i++) {
+    pass = pass && std::fabs(sum[i] - signal[i]) < 1e-4;
+  }
+
+  constexpr size_t shift = 5;
+  std::vector<double> shifted(size);
+  for (size_t i = 0; i < size; i++) {
+    shifted[(i + shift) % size] = signal[i];
+  }
+  UndecimatedWaveletPacketTree shifted_tree(height, &wavelet);
+  shifted_tree.SetRootSignal(shifted);
+  shifted_tree.Decompose();
+  tree.SetRootSignal(signal);
+  tree.Decompose();
+  for (size_t position = 0; position < tree.GetWaveletLevelCount();
+       position++) {
+    const Span<const double> leaf = tree.GetNodeSignal(height - 1, position);
+    const Span<const double> shifted_leaf =
+        shifted_tree.GetNodeSignal(height - 1, position);
+    for (size_t i = 0; i < size; i++) {
+      pass = pass &&
+             std::fabs(leaf[i] - shifted_leaf[(i + shift) % size]) < 1e-9;
+    }
+  }
+
+  // Lazy trees and updates compute what decomposing from scratch does.
+  UndecimatedWaveletPacketTree lazy(height, &wavelet);
+  lazy.SetLazyDecomposition(true);
+  lazy.SetRootSignal(signal);
+  const size_t last = tree.GetWaveletLevelCount() - 1;
+  const Span<const double> lazy_leaf = lazy.GetNodeSignal(height - 1, last);
+  const Span<const double> last_leaf = tree.GetNodeSignal(height - 1, last);
+  pass = pass && std::equal(last_leaf.begin(), last_leaf.end(),
+                            lazy_leaf.begin(), lazy_leaf.end());
+
+  const std::vector<double> values = {-4.0, 7.5, 0.25};
+  tree.UpdateRootSignal(size - 2, Span<const double>(values).subspan(0, 2));
+  tree.UpdateRootSignal(size / 2, values);
+  shifted = signal;
+  std::copy(values.begin(), values.begin() + 2, shifted.end() - 2);
+  std::copy(values.begin(), values.end(),
+            shifted.begin() + static_cast<ptrdiff_t>(size / 2));
+  shifted_tree.SetRootSignal(shifted);
+  shifted_tree.Decompose();
+  for (size_t depth = 0; depth < height; depth++) {
+    for (size_t position = 0; position < (1U << depth); position++) {
+      const Span<const double> expected =
+          shifted_tree.GetNodeSignal(depth, position);
+      const Span<const double> updated = tree.GetNodeSignal(depth, position);
+      pass = pass && std::equal(expected.begin(), expected.end(),
+                                updated.begin(), updated.end());
+    }
+  }
+
+  if (!pass) {
+    std::cout << "Undecimated tree of height " << height
+              << " does not match the a trous transform." << std::endl
+              << "FAIL" << std::endl;
+    exit(-1);
+  }
+}
+
+void TestUndecimatedTrees(const std::vector<double>& signal) {
+  std::cout << "Testing undecimated wavelet packet trees" << std::endl;
+  TestUndecimated(signal, 1, Wavelet::WaveletType::Daubechies, 2);
+  TestUndecimated(signal, 4, Wavelet::WaveletType::Daubechies, 4);
+  TestUndecimated(signal, 6, Wavelet::WaveletType::Symlet, 5);
+  TestUndecimated(signal, 8, Wavelet::WaveletType::Coiflet, 3);
+
+  // Short signals wrap the dilated filters around many times.
+  const std::vector<double> short_signal(signal.begin(), signal.begin() + 9);
+  TestUndecimated(short_signal, 5, Wavelet::WaveletType::Daubechies, 4);
+  std::cout << "Pass" << std::endl;
+}
+
+// Check an in-place tree keeps the nodes of each depth back to back in one
+// buffer, computes the nodes of a periodic WaveletPacketTree and
+// reconstructs signal.
+void TestInPlaceTree(const std::vector<double>& signal, size_t height,
+                     const Wavelet* wavelet, DyadicMode dyadic_mode,
+                     TransformEngine engine) {
+  InPlaceWaveletPacketTree tree(height, wavelet, dyadic_mode, engine);
+  WaveletPacketTree expected_tree(height, wavelet, dyadic_mode,
+                                  PaddingMode::Periodic, engine);
+  InPlaceWaveletPacketTree lazy(height, wavelet, dyadic_mode, engine);
+  tree.SetRootSignal(signal);
+  tree.Decompose();
+  expected_tree.SetRootSignal(signal);
+  expected_tree.Decompose();
+  lazy.SetLazyDecomposition(true);
+  lazy.SetRootSignal(signal);
+
+  const bool exact = signal.size() % (size_t{1} << (height - 1)) == 0;
+  bool pass = true;
+  for (size_t depth = 0; depth < height; depth++) {
+    const Span<const double> depth_signal = tree.GetDepthSignal(depth);
+    const Span<const double> lazy_signal = lazy.GetDepthSignal(depth);
+    pass = pass && std::equal(depth_signal.begin(), depth_signal.end(),
+                              lazy_signal.begin(), lazy_signal.end());
+    pass = pass && (!exact || depth_signal.size() == signal.size());
+
+    size_t offset = 0;
+    for (size_t position = 0; position < (size_t{1} << depth); position++) {
+      const Span<const double> node = tree.GetNodeSignal(depth, position);
+      const Span<const double> expected =
+          expected_tree.GetNodeSignal(depth, position);
+      pass = pass && node.data() == depth_signal.data() + offset &&
+             std::equal(node.begin(), node.end(), expected.begin(),
+                        expected.end());
+      offset += node.size();
+    }
+    pass = pass && offset == depth_signal.size();
+  }
+
+  if (!pass) {
+    std::cout << "In-place tree of height " << height
+              << " does not match a periodic WaveletPacketTree." << std::endl
+              << "FAIL" << std::endl;
+    exit(-1);
+  }
+  TestWPT(&tree, signal, true);
+}
+
+void TestInPlaceTrees(const std::vector<double>& signal) {
+  std::cout << "Testing periodic padding and in-place trees" << std::endl;
+  const DyadicMode dyadic_modes[] = {DyadicMode::Even, DyadicMode::Odd};
+  const TransformEngine engines[] = {TransformEngine::Convolution,
+                                     TransformEngine::Lifting};
+  // 37 elements round the nodes up at every depth and are shorter than the
+  // deepest nodes' filters.
+  const size_t sizes[] = {512, signal.size(), 37};
+  std::vector<double> long_signal(512);
+  for (size_t i = 0; i < long_signal.size(); i++) {
+    long_signal[i] = signal[i % signal.size()];
+  }
+  Wavelet wavelet;
+
+  for (const size_t p : {2, 6, 10}) {
+    Wavelet::GetWaveletCoefficients(&wavelet,
+                                    Wavelet::WaveletType::Daubechies, p);
+    for (const size_t size : sizes) {
+      const std::vector<double> resized(
+          long_signal.cbegin(),
+          long_signal.cbegin() + static_cast<ptrdiff_t>(size));
+      for (size_t height = 1; height <= 7; height += 3) {
+        for (const auto dyadic_mode : dyadic_modes) {
+          for (const auto engine : engines) {
+            TestInPlaceTree(resized, height, &wavelet, dyadic_mode, engine);
+          }
+        }
+
+        // Periodic padding reconstructs the other trees exactly as well.
+        WaveletPacketTree wpt(height, &wavelet, DyadicMode::Odd,
+                              PaddingMode::Periodic);
+        TestWPT(&wpt, resized, true);
+        StationaryWaveletPacketTree swpt(std::min<size_t>(height, 4),
+                                         &wavelet, PaddingMode::Periodic);
+        TestWPT(&swpt, resized, true);
+      }
+    }
+  }
+
+  // Setting the same signal again decomposes into the same depth buffers.
+  InPlaceWaveletPacketTree tree(6, &wavelet);
+  TestNoAllocations(&tree, signal);
+  std::cout << "Pass" << std::endl;
+}
+
+// Add up the reconstructions of every wavelet level of a decomposed tree.
+std::vector<double> ReconstructLevelSum(WaveletPacketTree* tree) {
+  const size_t size = tree->GetRootSignal().size();
+  std::vector<double> sum(size);
+  std::vector<double> level_signal(size);
+  for (size_t level = 0; level < tree->GetWaveletLevelCount(); level++) {
+    tree->Reconstruct(level, level_signal);
+    std::transform(sum.cbegin(), sum.cend(), level_signal.cbegin(),
+                   sum.begin(), std::plus<>());
+  }
+  return sum;
+}
+
+template <class Tree, class... Args>
+void TestDenoise(const std::vector<double>& signal, bool lazy,
+                 Args... args) {
+  Tree tree(args...);
+  Tree thresholded(args...);
+  tree.SetLazyDecomposition(lazy);
+  tree.SetRootSignal(signal);
+  tree.Decompose();
+  const std::vector<double> levels = ReconstructLevelSum(&tree);
+
+  // Hard thresholding at zero keeps every coefficient.
+  Threshold identity;
+  identity.rule = ThresholdRule::Hard;
+  identity.selection = ThresholdSelection::Fixed;
+  std::vector<double> denoised(signal.size());
+  tree.Denoise(identity, denoised);
+  Check(&levels, &denoised);
+
+  Threshold thresholds[4];
+  thresholds[1].selection = ThresholdSelection::Sure;
+  thresholds[2].rule = ThresholdRule::Hard;
+  thresholds[2].selection = ThresholdSelection::Sure;
+  thresholds[2].noise_level = 4.0;
+  thresholds[3].selection = ThresholdSelection::Fixed;
+  thresholds[3].threshold = 20.0;
+  thresholds[3].keep_approximation = false;
+
+  for (const Threshold& threshold : thresholds) {
+    // Denoising equals thresholding the leaves and adding up the levels.
+    thresholded.SetRootSignal(signal);
+    thresholded.Decompose();
+    thresholded.ThresholdLeaves(threshold);
+    const std::vector<double> expected = ReconstructLevelSum(&thresholded);
+    tree.Denoise(threshold, denoised);
+    Check(&expected, &denoised);
+
+    // The decomposition is left as it was.
+    const std::vector<double> after = ReconstructLevelSum(&tree);
+    Check(&levels, &after);
+  }
+
+  // Without a buffer the root signal receives the denoised signal.
+  tree.Denoise(thresholds[3]);
+  Check(&denoised, &tree.GetRootSignal());
+}
+
+void TestThresholdSelection() {
+  const std::vector<double> coefficients = {1, -2, 3, -4, 0.5};
+  std::vector<double> scratch(coefficients.size());
+  bool pass = std::abs(Threshold::EstimateNoiseLevel(coefficients, scratch) -
+                       2.0 / 0.6745) < 1e-12;
+  pass = pass && std::abs(Threshold::EstimateNoiseLevel(
+                              Span<const double>(coefficients.data(), 4),
+                              scratch) -
+                          2.5 / 0.6745) < 1e-12;
+
+  Threshold threshold;
+  threshold.noise_level = 2.0;
+  pass = pass && std::abs(threshold.Select(coefficients, scratch) -
+                          2.0 * std::sqrt(2.0 * std::log(5.0))) < 1e-12;
+  threshold.selection = ThresholdSelection::Fixed;
+  threshold.threshold = 1.5;
+  pass = pass && threshold.Select(coefficients, scratch) == 1.5;
+
+  // Mostly noise with a few large coefficients. SURE keeps the large ones
+  // with a lower threshold than the universal one.
+  std::vector<double> sparse(256);
+  for (size_t i = 0; i < sparse.size(); i++) {
+    sparse[i] = std::sin(static_cast<double>(i) * 2.3) +
+                (i % 4 == 0 ? 8.0 : 0.0);
+  }
+  scratch.resize(sparse.size());
+  threshold.noise_level = 0.0;
+  threshold.selection = ThresholdSelection::Universal;
+  const double universal = threshold.Select(sparse, scratch);
+  threshold.selection = ThresholdSelection::Sure;
+  const double sure = threshold.Select(sparse, scratch);
+  pass = pass && sure > 0.0 && sure < universal;
+
+  // Too little energy above the noise falls back to the universal
+  // threshold.
+  for (size_t i = 0; i < sparse.size(); i++) {
+    sparse[i] = std::sin(static_cast<double>(i) * 2.3);
+  }
+  threshold.selection = ThresholdSelection::Universal;
+  const double quiet_universal = threshold.Select(sparse, scratch);
+  threshold.selection = ThresholdSelection::Sure;
+  pass = pass && threshold.Select(sparse, scratch) == quiet_universal;
+
+  if (!pass) {
+    std::cout << "Threshold selection is wrong." << std::endl
+              << "FAIL" << std::endl;
+    exit(-1);
+  }
+}
+
+// Each channel of a multichannel tree is denoised as a tree of that channel
+// alone denoises it, however loud the other channels are.
+void TestMultichannelDenoise(const std::vector<double>& signal,
+                             const Wavelet* wavelet, size_t height) {
+  constexpr size_t channel_count = 3;
+  const size_t signal_size = signal.size();
+  std::vector<double> signals(signal_size * channel_count);
+  for (size_t i = 0; i < signal_size; i++) {
+    for (size_t c = 0; c < channel_count; c++) {
+      signals[i * channel_count + c] =
+          signal[i] * static_cast<double>(c * c * 10 + 1) +
+          std::sin(static_cast<double>(i * (c + 1)));
+    }
+  }
+
+  Threshold thresholds[3];
+  thresholds[1].selection = ThresholdSelection::Sure;
+  thresholds[2].rule = ThresholdRule::Hard;
+  thresholds[2].keep_approximation = false;
+
+  MultichannelWaveletPacketTree tree(height, wavelet, channel_count);
+  WaveletPacketTree channel_tree(height, wavelet);
+  tree.SetRootSignal(signals);
+  tree.Decompose();
+  std::vector<double> denoised(signals.size());
+  std::vector<double> channel_signal(signal_size);
+  std::vector<double> channel_denoised(signal_size);
+  std::vector<double> expected(signal_size);
+  for (const Threshold& threshold : thresholds) {
+    tree.Denoise(threshold, denoised);
+    for (size_t c = 0; c < channel_count; c++) {
+      for (size_t i = 0; i < signal_size; i++) {
+        channel_signal[i] = signals[i * channel_count + c];
+        channel_denoised[i] = denoised[i * channel_count + c];
+      }
+      channel_tree.SetRootSignal(channel_signal);
+      channel_tree.Decompose();
+      channel_tree.Denoise(threshold, expected);
+      Check(&expected, &channel_denoised);
+    }
+  }
+}
+
+void TestDenoising(const std::vector<double>& signal) {
+  std::cout << "Testing thresholding and denoising" << std::endl;
+  TestThresholdSelection();
+
+  const PaddingMode padding_modes[] = {
+      PaddingMode::Zeroes, PaddingMode::Symmetric, PaddingMode::Periodic};
+  const TransformEngine engines[] = {TransformEngine::Convolution,
+                                     TransformEngine::Lifting};
+  Wavelet wavelet;
+  Wavelet::GetWaveletCoefficients(&wavelet, Wavelet::WaveletType::Daubechies,
+                                  4);
+
+  for (size_t height = 1; height <= 5; height += 2) {
+    for (const auto padding_mode : padding_modes) {
+      for (const auto engine : engines) {
+        TestDenoise<WaveletPacketTree>(signal, false, height, &wavelet,
+                                       DyadicMode::Odd, padding_mode,
+                                       engine);
+      }
+      TestDenoise<WaveletPacketTree>(signal, true, height, &wavelet,
+                                     DyadicMode::Even, padding_mode,
+                                     TransformEngine::Convolution);
+    }
+    TestDenoise<InPlaceWaveletPacketTree>(signal, false, height, &wavelet,
+                                          DyadicMode::Odd,
+                                          TransformEngine::Convolution);
+    TestDenoise<MultichannelWaveletPacketTree>(signal, false, height,
+                                               &wavelet, size_t{5});
+    TestMultichannelDenoise(signal, &wavelet, height);
+  }
+
+  // A noisy sine comes out closer to the clean one. The noise is roughly
+  // Gaussian, the sum of uniform values.
+  constexpr size_t size = 1024;
+  std::vector<double> clean(size);
+  std::vector<double> noisy(size);
+  uint32_t state = 12345;
+  for (size_t i = 0; i < size; i++) {
+    double noise = -6.0;
+    for (size_t j = 0; j < 12; j++) {
+      state = state * 1664525U + 1013904223U;
+      noise += static_cast<double>(state) / 4294967296.0;
+    }
+    clean[i] = 10.0 * std::sin(static_cast<double>(i) * 0.02);
+    noisy[i] = clean[i] + noise;
+  }
+  const auto error = [&clean](const std::vector<double>& signal) {
+    double sum = 0.0;
+    for (size_t i = 0; i < signal.size(); i++) {
+      sum += (signal[i] - clean[i]) * (signal[i] - clean[i]);
+    }
+    return sum;
+  };
+
+  WaveletPacketTree tree(4, &wavelet, DyadicMode::Odd, PaddingMode::Periodic);
+  tree.SetRootSignal(noisy);
+  tree.Decompose();
+  std::vector<double> denoised(size);
+  for (const auto selection :
+       {ThresholdSelection::Universal, ThresholdSelection::Sure}) {
+    Threshold threshold;
+    threshold.selection = selection;
+    tree.Denoise(threshold, denoised);
+    if (error(denoised) * 2.0 > error(noisy)) {
+      std::cout << "Denoising did not halve the error. Before: "
+                << error(noisy) << " After: " << error(denoised) << std::endl
+                << "FAIL" << std::endl;
+      exit(-1);
+    }
+  }
+
+  // Denoising allocates nothing once its buffers are sized.
+  Threshold threshold;
+  const size_t count = allocationCount;
+  tree.Denoise(threshold, denoised);
+  tree.ThresholdLeaves(threshold);
+  if (allocationCount != count) {
+    std::cout << "Denoising allocated after warm-up." << std::endl
+              << "FAIL" << std::endl;
+    exit(-1);
+  }
+  std::cout << "Pass" << std::endl;
+}
+
 void DoTests() {
   constexpr size_t signal_size = 500;
   std::vector<double> signal(signal_size);
@@ -228,6 +2520,29 @@ void DoTests() {
   constexpr size_t max_test_height = 10;
   TestWavelets(max_test_height, signal);
 
+  TestAllKernels();
+  TestDecompositions();
+  TestReconstructions();
+  TestLiftingTrees(signal);
+  TestStaticWavelets(signal);
+  TestWorkspace(signal);
+  TestNodeLayout(signal);
+  TestReconstructAlls(signal);
+  TestParallelDecompositions(signal);
+  TestSampleTypes<float, float>("float", signal);
+  TestSampleTypes<float, double>("float/double", signal);
+  TestStreaming(signal);
+  TestMultichannels(signal);
+  TestLazyTrees(signal);
+  TestUpdates(signal);
+  TestBestBasis(signal);
+  TestTreeFiles(signal);
+  TestRootViews(signal);
+  TestInstrumentation(signal);
+  TestUndecimatedTrees(signal);
+  TestInPlaceTrees(signal);
+  TestDenoising(signal);
+
   for (const DyadicTest& test : dyadicUpTests) {
     TestDyadicUp(test.signal, test.expected, test.mode);
   }